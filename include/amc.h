@@ -12,7 +12,8 @@
 
 /*! \fn unsigned int fw_version_check(const char* caller_name, localArgs *la)
  *  \brief Returns AMC FW version
- *  in case FW version is not 1.X or 3.X sets an error string in response
+ *  in case FW version is not 1.X or 3.X sets an error string in response.
+ *  The release is read at most once per call, see hwFwMajor
  *  \param caller_name Name of methods which called the FW version check
  *  \param la Local arguments structure
  */
@@ -21,6 +22,7 @@ unsigned int fw_version_check(const char* caller_name, localArgs *la);
 /*! \fn uint32_t getOHVFATMaskLocal(uint32_t ohN)
  *  \brief returns the vfatMask for the optohybrid ohN
  *  \details Reads the SYNC_ERR_CNT counter for each VFAT on ohN.  If for a given VFAT the counter returns a non-zero value the given VFAT will be masked.
+ *           The counters of the 24 VFATs are read together by readRegs, holding the memhub lock once; a VFAT whose counter cannot be read is masked.
  *  \param la Local arguments structure
  *  \param ohN Optical link
  */
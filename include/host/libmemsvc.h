@@ -0,0 +1,27 @@
+/*
+ * libmemsvc API, for host builds only: the CTP7 library is not available there and
+ * src/memhub/memsvc_host.cpp provides these functions on top of the simulated registers.
+ */
+
+#ifndef __LIBMEMSVC_H
+#define __LIBMEMSVC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct memsvc_handle *memsvc_handle_t;
+
+int memsvc_open(memsvc_handle_t *handle);
+int memsvc_close(memsvc_handle_t *handle);
+const char *memsvc_get_last_error(memsvc_handle_t handle);
+int memsvc_read(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data);
+int memsvc_write(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
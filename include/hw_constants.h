@@ -11,6 +11,7 @@
 #endif
 
 #include <stdint.h>
+#include <cstddef>
 #include <array>
 
 /*! \brief This namespace hold the constants related to the AMC.
@@ -10,21 +10,138 @@ extern "C" {
 #endif
 
 /*
- * This library is a thin wrapper around libmemsvc, which adds semaphores to synchronize concurrent read/write operations from different processes.
+ * This library is a thin wrapper around libmemsvc, which adds locks to synchronize concurrent read/write operations from different processes.
+ *
+ * The locks are robust process-shared mutexes living in the /dev/shm/memhub shared memory segment, created by the first process
+ * opening memhub under a lock on /dev/shm/memhub.lock. A segment left uninitialized by a process which died while creating
+ * it, or written by a release with another layout, is created again. When a process dies while holding a lock, the next
+ * process taking it recovers it, so no cleanup is needed.
+ *
+ * The address space can be split into lock domains, each one protected by its own lock, so that processes accessing
+ * unrelated regions do not wait for each other. Addresses outside of all the domains share the default lock.
+ * An operation spanning several domains takes their locks in increasing domain order.
+ *
+ * The domains are read from the MEMHUB_DOMAINS file, by default $GEM_PATH/memhub_domains.txt which is written by
+ * utils.update_address_table, one "<first byte address> <last byte address>" hexadecimal pair per line, sorted and
+ * non-overlapping. The first process opening memhub publishes the table in the shared memory segment and all the other
+ * processes use that copy: a new domain file is only taken into account once /dev/shm/memhub has been removed while no
+ * client is running. Without a domain file, a single lock is used.
+ *
+ * The registers are accessed through one of the following backends, selected by the MEMHUB_BACKEND environment variable
+ * when the process first opens memhub:
+ *  - memsvc (default): libmemsvc calls
+ *  - mmap: volatile loads and stores to the AXI window [MEMHUB_MMAP_BASE, MEMHUB_MMAP_BASE + MEMHUB_MMAP_SIZE), mapped
+ *    once from MEMHUB_MMAP_DEVICE (default /dev/mem) at file offset MEMHUB_MMAP_OFFSET (default MEMHUB_MMAP_BASE).
+ *    The device can be a regular file. Accesses outside of the window go through libmemsvc, and the memsvc backend is
+ *    used if the window cannot be mapped.
+ *  - sim: in-memory register file built from the address table, with programmable register behaviours and access
+ *    latency, see memhub/sim.h. This is the default of host builds (MEMHUB_HOST), which have no libmemsvc.
  */
+#define MEMHUB_MAX_DOMAINS 63
+#define MEMHUB_DOMAINS_FILE "memhub_domains.txt"
+
 int memhub_open(memsvc_handle_t *handle);
 int memhub_close(memsvc_handle_t *handle);
 
 /* These functions return -1 on error and 0 on success.
  *
- * On error, the error message will be available via memsvc_get_last_error()
+ * On error, the error message will be available via memsvc_get_last_error(), unless the memhub lock could not be taken.
  */
 int memhub_read(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data);
 int memhub_write(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data);
-void die(int signo);
+
+/* Port accesses: words consecutive accesses to the same address, e.g. a FIFO, under a single lock hold.
+ * The mmap and sim backends do them in one go, the memsvc backend word by word.
+ */
+int memhub_read_port(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data);
+int memhub_write_port(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data);
+
+/* Read-modify-write of the mask bits of one word, the read and the write are done under the same lock hold.
+ * A full mask is a plain write.
+ */
+int memhub_write_masked(memsvc_handle_t handle, uint32_t addr, uint32_t mask, uint32_t value);
+
+/* List accesses: count words at arbitrary addresses, in a single transaction.
+ * memhub_list_read reads the addresses in increasing order, merging runs of contiguous addresses into block reads,
+ * and returns the data in the order of addrs. memhub_list_write keeps the order of addrs, because writes can have
+ * side effects, and only merges the runs of contiguous increasing addresses found in it.
+ */
+int memhub_list_read(memsvc_handle_t handle, const uint32_t *addrs, uint32_t count, uint32_t *data);
+int memhub_list_write(memsvc_handle_t handle, const uint32_t *addrs, uint32_t count, const uint32_t *data);
+
+/* Masked list write: the entries are grouped by address, later entries taking precedence on the bits they share, and
+ * each distinct word gets one memhub_write_masked, in the order of first appearance, in a single transaction.
+ * The words whose merged mask is 0 are not accessed at all.
+ * Returns the number of failed entries, whose indices are stored in failed, which must have room for count indices.
+ */
+uint32_t memhub_list_write_masked(memsvc_handle_t handle, const uint32_t *addrs, const uint32_t *masks, const uint32_t *values,
+                                  uint32_t count, uint32_t *failed);
+
+/* Transactions hold the memhub locks across several read/write operations of the calling process,
+ * instead of taking them for every single operation. The lock of a domain is taken by the first operation
+ * touching it; if this would break the lock order, all the locks are released and taken again in order.
+ * Transactions can be nested, the locks are released by the outermost memhub_transaction_end().
+ *
+ * Once the locks have been held for longer than the maximum hold time, they are released and taken again
+ * before the next operation of the transaction, so that other processes are not starved. The maximum
+ * hold time defaults to 10 ms, can be set from the MEMHUB_MAX_HOLD_US environment variable, and 0
+ * disables it. As a consequence, a transaction groups operations for performance only and does not
+ * guarantee atomicity.
+ *
+ * memhub_transaction_begin() returns -1 if memhub_open() was not called, memhub_transaction_end()
+ * returns -1 if there is no open transaction.
+ */
+int memhub_transaction_begin(void);
+int memhub_transaction_end(void);
+void memhub_set_max_hold_time(uint32_t usec);
+
+/* Name of the backend in use */
+const char *memhub_backend(void);
+
+/* Each process records its lock and traffic statistics in its own slot of the shared memory segment, without
+ * taking any lock. memhub_get_stats() sums the slots of all the processes, including the ones which are gone,
+ * and returns -1 if memhub_open() was not called.
+ *
+ * Bucket i of the histograms counts the lock waits (resp. holds) lasting [2^i, 2^(i+1)) ns, bucket 0 also counts
+ * the ones under 1 ns and the last bucket all the longer ones. A hold lasts from taking the first lock to releasing
+ * the last one, so it covers a whole transaction.
+ */
+#define MEMHUB_STATS_SLOTS 64
+#define MEMHUB_STATS_BUCKETS 32
+
+struct memhub_stats {
+    uint32_t processes;                       /* processes currently alive owning a slot */
+    uint64_t reads;                           /* successful read operations */
+    uint64_t writes;                          /* successful write operations */
+    uint64_t read_words;                      /* words read */
+    uint64_t write_words;                     /* words written */
+    uint64_t errors;                          /* failed operations */
+    uint64_t recoveries;                      /* locks recovered from a process which died holding them */
+    uint64_t wait_ns;                         /* total time spent waiting for the locks */
+    uint64_t hold_ns;                         /* total time the locks were held */
+    uint64_t wait_hist[MEMHUB_STATS_BUCKETS];
+    uint64_t hold_hist[MEMHUB_STATS_BUCKETS];
+};
+
+int memhub_get_stats(struct memhub_stats *stats);
 
 #ifdef __cplusplus
 }
+
+/*! \class memhubTransaction
+ *  \brief Scoped memhub transaction, the locks taken during its lifetime are released on destruction
+ */
+class memhubTransaction {
+public:
+    memhubTransaction() : m_open(memhub_transaction_begin() == 0) {}
+    ~memhubTransaction() { if (m_open) memhub_transaction_end(); }
+
+    memhubTransaction(const memhubTransaction &) = delete;
+    memhubTransaction & operator=(const memhubTransaction &) = delete;
+
+private:
+    bool m_open;
+};
 #endif
 
 #endif
@@ -0,0 +1,49 @@
+/*!
+ * \file memhub/sim.h
+ * \brief Simulated register space backend of memhub
+ */
+
+#ifndef MEMHUB_SIM_H
+#define MEMHUB_SIM_H
+
+#include <stdint.h>
+
+/*! \fn bool memhub_sim_open()
+ *  \brief Builds the simulated register file of the process
+ *  \details Every register of the address table found in MEMHUB_SIM_TABLE (default $GEM_PATH/address_table.mdb) gets
+ *           its words, initialized to 0; accessing any other address fails. The behaviours listed in MEMHUB_SIM_CONFIG
+ *           are then attached to the registers, one per line, a register being given by its name or its hexadecimal
+ *           address:
+ *            - `<register> value <v>`: initial value
+ *            - `<register> strobe`: self-clearing, written bits always read back as 0
+ *            - `<register> counter [step]`: incremented by step (default 1) after each read
+ *            - `<register> busy <trigger> <n>`: read-only flag, set when a non-zero value is written to trigger and
+ *              cleared after being read n times, e.g. `GEM_AMC.TTC.GENERATOR.CYCLIC_RUNNING busy GEM_AMC.TTC.GENERATOR.CYCLIC_START 100`
+ *
+ *           MEMHUB_SIM_LATENCY_NS adds a fixed latency to each access. The register file lives in the memory of each
+ *           process, so values are not shared between client processes.
+ *  \returns false if the address table cannot be read
+ */
+bool memhub_sim_open();
+
+/*! \fn int memhub_sim_read(uint32_t addr, uint32_t words, uint32_t *data)
+ *  \brief Reads words consecutive words of the register file, returns -1 if one of them does not exist
+ */
+int memhub_sim_read(uint32_t addr, uint32_t words, uint32_t *data);
+
+/*! \fn int memhub_sim_write(uint32_t addr, uint32_t words, const uint32_t *data)
+ *  \brief Writes words consecutive words of the register file, returns -1 if one of them does not exist
+ */
+int memhub_sim_write(uint32_t addr, uint32_t words, const uint32_t *data);
+
+/*! \fn const char * memhub_sim_last_error()
+ *  \brief Description of the last failed access of the process
+ */
+const char * memhub_sim_last_error();
+
+/*! \fn void memhub_sim_set_error(const char * error)
+ *  \brief Sets the description returned by memhub_sim_last_error
+ */
+void memhub_sim_set_error(const char * error);
+
+#endif
@@ -12,6 +12,8 @@
 #include "memhub.h"
 #include "lmdb_cpp_wrapper.h"
 #include "xhal/utils/XHALXMLParser.h"
+#include "utils/errors.h"
+#include "utils/hw_context.h"
 
 #include <unistd.h>
 #include <iostream>
@@ -22,6 +24,7 @@
 #include <vector>
 #include <iterator>
 #include <cstdio>
+#include <cstring>
 #include <thread>
 #include <chrono>
 
@@ -34,29 +37,77 @@ typedef struct localArgs {
     lmdb::txn & rtxn; /*!< LMDB transaction handle */
     lmdb::dbi & dbi;  /*!< LMDB individual database handle */
     RPCMsg *response; /*!< RPC response message */
+    regErrorReporter reporter; /*!< Writes the register access errors of the call to response when la goes out of scope */
+    hwContext hw;              /*!< Hardware state of the call, see hwFwMajor and hwNumOfOH */
 } LocalArgs;
 
-/*!
- * \brief returns a set up LocalArgs structure
+static constexpr uint32_t LMDB_SIZE = 1UL * 1024UL * 1024UL * 50UL; ///< Map size used to read the LMDB object, currently 50 MiB; LMDB extends it to the size of larger tables
+static constexpr const char* LMDB_GENERATION_KEY = "__generation__"; ///< Reserved LMDB key holding the 64-bit generation of the address table, bumped on every update
+
+/*! \fn LocalArgs getLocalArgs(RPCMsg *response)
+ *  \brief Returns a set up LocalArgs structure
+ *  \details The LMDB environment, the read-only transaction and the database handle are opened once per process and shared by all RPC calls.
+ *            On each call the read-only transaction is reset and renewed, so that the snapshot is refreshed without reallocating the transaction.
+ *            If the address table has been regenerated since the environment was opened, the environment is reopened.
+ *            The per-process register descriptor cache is dropped whenever the generation stored in the table changes.
+ *            The register access error ring (see regErrors) is cleared, and rendered into response when the returned
+ *            structure goes out of scope. The hardware state of the call (see hwContext) starts empty.
+ *  \param response RPC response message
  */
 LocalArgs getLocalArgs(RPCMsg *response);
 
-static constexpr uint32_t LMDB_SIZE = 1UL * 1024UL * 1024UL * 50UL; ///< Maximum size of the LMDB object, currently 50 MiB
+/*! \fn void closeLocalArgs()
+ *  \brief Releases the process-wide LMDB handles used by getLocalArgs
+ *  \details Must be called before the address table is rebuilt from within the same process
+ */
+void closeLocalArgs();
 
-// FIXME: to be replaced with the above function when the struct is properly implemented
-#define GETLOCALARGS(response)                                  \
-    auto env = lmdb::env::create();                             \
-    env.set_mapsize(LMDB_SIZE);                                 \
-    std::string gem_path       = std::getenv("GEM_PATH");       \
-    std::string lmdb_data_file = gem_path+"/address_table.mdb"; \
-    env.open(lmdb_data_file.c_str(), 0, 0664);                  \
-    auto rtxn = lmdb::txn::begin(env, nullptr, MDB_RDONLY);     \
-    auto dbi  = lmdb::dbi::open(rtxn, nullptr);                 \
-    LocalArgs la = {.rtxn     = rtxn,                           \
-                    .dbi      = dbi,                            \
-                    .response = response};
+/*! \fn uint64_t addressTableGeneration()
+ *  \brief Returns the generation of the address table snapshot taken by the last call to getLocalArgs
+ */
+uint64_t addressTableGeneration();
+
+/*! \enum regPermission
+ *  Register access permission bits, as stored in the register descriptor
+ */
+enum regPermission : uint8_t {
+    REG_PERM_NONE  = 0x0,
+    REG_PERM_READ  = 0x1,
+    REG_PERM_WRITE = 0x2
+};
 
-struct localArgs getLocalArgs(RPCMsg *response);
+/*! \enum regMode
+ *  Register access mode, as stored in the register descriptor
+ */
+enum regMode : uint8_t {
+    REG_MODE_SINGLE      = 0,
+    REG_MODE_BLOCK       = 1,
+    REG_MODE_FIFO        = 2,
+    REG_MODE_INCREMENTAL = 3,
+    REG_MODE_PORT        = 4,
+    REG_MODE_UNKNOWN     = 0xff
+};
+
+static constexpr uint8_t REG_DESC_MAGIC   = 0xd5; ///< First byte of a binary register descriptor, can never start a legacy text value
+static constexpr uint8_t REG_DESC_VERSION = 1;    ///< Current version of the binary register descriptor layout
+
+/*! \struct regDescriptor
+ *  \brief Fixed layout binary register descriptor, stored as the LMDB value of every address table node
+ *  \details LMDB does not align values, hence the packed layout. Descriptors are used in place from the LMDB map, without any copy.
+ */
+struct __attribute__((packed)) regDescriptor {
+    uint8_t  magic;       /*!< Always REG_DESC_MAGIC */
+    uint8_t  version;     /*!< Layout version, REG_DESC_VERSION */
+    uint8_t  perm;        /*!< regPermission bits */
+    uint8_t  mode;        /*!< regMode */
+    uint8_t  shift;       /*!< Position of the lowest set bit of the mask */
+    uint8_t  reserved[3]; /*!< Padding, always 0 */
+    uint32_t address;     /*!< Register address */
+    uint32_t mask;        /*!< Register mask */
+    uint32_t size;        /*!< Register size in 32-bit words */
+};
+
+static_assert(sizeof(regDescriptor) == 20, "regDescriptor layout must not change without bumping REG_DESC_VERSION");
 
 struct slowCtrlErrCntVFAT{
     uint32_t crc;           //GEM_AMC.SLOW_CONTROL.VFAT3.CRC_ERROR_CNT
@@ -105,19 +156,90 @@ struct slowCtrlErrCntVFAT{
 };
 
 
-template<typename Out>
-void split(const std::string &s, char delim, Out result) {
-    std::stringstream ss;
-    ss.str(s);
-    std::string item;
-    while (std::getline(ss, item, delim)) {
-        *(result++) = item;
+/*! \fn uint8_t regPermFromString(const char * perm, size_t len)
+ *  \brief Returns the regPermission bits of an address table permission string
+ */
+inline uint8_t regPermFromString(const char * perm, size_t len)
+{
+    uint8_t bits = REG_PERM_NONE;
+    for (size_t i = 0; i < len; ++i) {
+        if (perm[i] == 'r')
+            bits |= REG_PERM_READ;
+        else if (perm[i] == 'w')
+            bits |= REG_PERM_WRITE;
+    }
+    return bits;
+}
+
+/*! \fn uint8_t regModeFromString(const char * mode, size_t len)
+ *  \brief Returns the regMode of an address table mode string, REG_MODE_UNKNOWN if not recognised
+ */
+inline uint8_t regModeFromString(const char * mode, size_t len)
+{
+    static const char* const names[] = {"single", "block", "fifo", "incremental", "port"};
+    for (uint8_t m = REG_MODE_SINGLE; m <= REG_MODE_PORT; ++m) {
+        if (std::strlen(names[m]) == len && std::strncmp(names[m], mode, len) == 0)
+            return m;
     }
+    return REG_MODE_UNKNOWN;
 }
 
-std::vector<std::string> split(const std::string &s, char delim);
+/*! \fn uint8_t regMaskShift(uint32_t mask)
+ *  \brief Returns the position of the lowest set bit of a register mask
+ */
+inline uint8_t regMaskShift(uint32_t mask)
+{
+    return mask ? __builtin_ctz(mask) : 0;
+}
 
-std::string serialize(xhal::utils::Node n);
+/*! \fn regDescriptor makeRegDescriptor(const xhal::utils::Node & n)
+ *  \brief Compiles an address table node into its binary register descriptor
+ *  \details Inline so that the build tools parsing the address table (see tools/gen_static_regs.cpp) compile the
+ *            nodes as the address table import does.
+ *  \param n Address table node
+ */
+inline regDescriptor makeRegDescriptor(const xhal::utils::Node & n)
+{
+    regDescriptor desc = {};
+    desc.magic   = REG_DESC_MAGIC;
+    desc.version = REG_DESC_VERSION;
+    desc.perm    = regPermFromString(n.permission.data(), n.permission.size());
+    desc.mode    = regModeFromString(n.mode.data(), n.mode.size());
+    desc.shift   = regMaskShift(n.mask);
+    desc.address = n.real_address;
+    desc.mask    = n.mask;
+    desc.size    = n.size;
+    return desc;
+}
+
+/*! \fn const regDescriptor * decodeRegDescriptor(const lmdb::val & db_res)
+ *  \brief Returns the register descriptor held by an LMDB value
+ *  \details Binary descriptors are returned in place. Values in the legacy text format (`addr|perm|mask|mode|size`) are decoded into a per-thread scratch descriptor, which is overwritten by the next legacy decode.
+ *  \param db_res LMDB call result
+ *  \returns Pointer to the descriptor, nullptr if the value cannot be decoded
+ */
+const regDescriptor * decodeRegDescriptor(const lmdb::val & db_res);
+
+/*! \fn const regDescriptor * getRegDescriptor(LocalArgs * la, const std::string & regName)
+ *  \brief Looks up the register descriptor of a given register
+ *  \details Descriptors are looked up in the register index (see utils/reg_index.h) when one matches the address table.
+ *            Otherwise they are served from a per-process cache and only looked up in LMDB on the first access.
+ *            The returned pointer is valid until the next call to getRegDescriptor or getLocalArgs.
+ *  \param la Local arguments structure
+ *  \param regName Register name
+ *  \returns Pointer to the descriptor, nullptr if the register is not found
+ */
+const regDescriptor * getRegDescriptor(LocalArgs * la, const std::string & regName);
+
+/*! \fn const char * regPermString(uint8_t perm)
+ *  \brief Returns the address table permission string ("r", "w", "rw") for the given regPermission bits
+ */
+const char * regPermString(uint8_t perm);
+
+/*! \fn const char * regModeString(uint8_t mode)
+ *  \brief Returns the address table mode string for the given regMode
+ */
+const char * regModeString(uint8_t mode);
 
 /*! \brief This macro is used to terminate a function if an error occurs. It logs the message, write it to the `error` RPC key and returns the `error_code` value.
  *  \param response A pointer to the RPC response object.
@@ -203,30 +325,69 @@ uint32_t applyMask(uint32_t data, uint32_t mask);
 
 /*! \fn uint32_t readReg(LocalArgs * la, const std::string & regName)
  *  \brief Reads a value from register. Register mask is applied. Will return 0xdeaddead if register is no accessible
+ *  \details 0xdeaddead may also be the value of the register, use the version returning a regError to tell them apart
  *  \param la Local arguments structure
  *  \param regName Register name
  */
 uint32_t readReg(LocalArgs * la, const std::string & regName);
 
+/*! \fn regError readReg(LocalArgs * la, const std::string & regName, uint32_t & value)
+ *  \brief Reads a value from register. Register mask is applied
+ *  \details Failures are recorded in the error ring of the request, they do not set "error" in the response.
+ *  \param la Local arguments structure
+ *  \param regName Register name
+ *  \param value Receives the value, left untouched on failure
+ *  \returns REG_OK on success, the reason of the failure otherwise
+ */
+regError readReg(LocalArgs * la, const std::string & regName, uint32_t & value);
+
+/*! \fn uint32_t readRegs(LocalArgs * la, const std::vector<std::string> & regNames, uint32_t * result, uint32_t maxGap=0)
+ *  \brief Reads a set of registers, coalescing the registers at adjacent addresses into block reads
+ *  \details All the descriptors are resolved first, the addresses are sorted and every run of adjacent addresses is read with a single memhub transaction.
+ *            The register masks are then applied as in readReg. Registers sharing the same address are read once.
+ *            Registers which cannot be read are set to 0xdeaddead, as in readReg, and recorded in the error ring of the request.
+ *  \param la Local arguments structure
+ *  \param regNames Register names
+ *  \param result Pointer to an array of at least regNames.size() words, receiving the values in the order of regNames
+ *  \param maxGap Number of unrequested words allowed between two registers read in the same block; must only be non-zero if reading those words has no side effect
+ *  \returns the number of memhub transactions issued
+ */
+uint32_t readRegs(LocalArgs * la, const std::vector<std::string> & regNames, uint32_t * result, uint32_t maxGap=0);
+
+/*! \fn uint32_t readRegs(LocalArgs * la, const std::vector<regDescriptor> & descs, uint32_t * result, uint32_t maxGap=0)
+ *  \brief Reads a set of registers given by descriptor, e.g. members of register families, as the register name version does
+ *  \param la Local arguments structure
+ *  \param descs Register descriptors, those without read permission, e.g. unresolved family members, are set to 0xdeaddead
+ *  \param result Pointer to an array of at least descs.size() words, receiving the values in the order of descs
+ *  \param maxGap As in the register name version
+ *  \returns the number of memhub transactions issued
+ */
+uint32_t readRegs(LocalArgs * la, const std::vector<regDescriptor> & descs, uint32_t * result, uint32_t maxGap=0);
+
+// Block sizes and offsets are counted in 32-bit words: word i of a register is at the byte address address + 4*i
+
 /*!
  *  \brief Reads a block of values from a contiguous address space.
  *  \param la Local arguments structure
  *  \param regName Register name of the block to be read
  *  \param size number of words to read (should this just come from the register properties?
  *  \param result Pointer to an array to hold the result
- *  \param offset Start reading from an offset from the base address returned by regName
+ *  \param offset Start reading from an offset, in words, from the base address returned by regName
  *  \returns the number of uint32_t words in the result (or better to return a std::vector?
  */
 uint32_t readBlock(localArgs* la, const std::string& regName, uint32_t* result, const uint32_t& size, const uint32_t& offset=0);
 
 /*!
  *  \brief Reads a block of values from a contiguous address space.
- *
+ *  \details The register covering regAddr is found in the register index (see regIndex::findAddress), and the read is
+ *           validated as in the register name version: the register must be readable and cover the whole word, and the
+ *           read must not go past its size. FIFO and port registers are read at their address.
+ *           regAddr may point inside a block register.
  *  \param regAddr Register address of the block to be read
  *  \param size number of words to read
  *  \param result Pointer to an array to hold the result
- *  \param offset Start reading from an offset from the base address regAddr
- *  \returns the number of uint32_t words in the result (or better to return a std::vector?
+ *  \param offset Start reading from an offset, in words, from the address regAddr
+ *  \returns the number of uint32_t words in the result, 0 if the read was denied or failed
  */
 uint32_t readBlock(const uint32_t& regAddr,  uint32_t* result, const uint32_t& size, const uint32_t& offset=0);
 
@@ -247,6 +408,59 @@ slowCtrlErrCntVFAT repeatedRegReadLocal(localArgs * la, const std::string & regN
  */
 void writeReg(LocalArgs * la, const std::string & regName, uint32_t value);
 
+/*! \class writeBatch
+ *  \brief Collects register writes and coalesces the masked writes targeting the same 32-bit word
+ *  \details On commit every word is read at most once, updated with all the fields written to it and written once,
+ *            under the same memhub lock hold (see memhub_write_masked). The read is skipped when the collected fields
+ *            cover the whole word.
+ *            Words are flushed in the order in which they were first written to.
+ *            Pending writes are committed when the batch goes out of scope.
+ */
+class writeBatch {
+public:
+    /*! \brief Creates an empty batch
+     *  \param la Local arguments structure
+     */
+    explicit writeBatch(LocalArgs * la) : m_la(la) {}
+
+    /*! \brief Commits the pending writes */
+    ~writeBatch() { commit(); }
+
+    writeBatch(const writeBatch &) = delete;
+    writeBatch & operator=(const writeBatch &) = delete;
+
+    /*! \brief Queues a write to a register. Register mask is applied, as in writeReg
+     *  \param regName Register name
+     *  \param value Value to write
+     */
+    void writeReg(const std::string & regName, uint32_t value);
+
+    /*! \brief Queues a write of the bits selected by mask at a raw address
+     *  \param address Register address
+     *  \param mask Bits of the word to write
+     *  \param value Word value, only the bits selected by mask are used
+     */
+    void writeMasked(uint32_t address, uint32_t mask, uint32_t value);
+
+    /*! \brief Performs the pending writes
+     *  \returns true if all the words were written successfully
+     */
+    bool commit();
+
+    /*! \brief Number of distinct words pending */
+    size_t size() const { return m_words.size(); }
+
+private:
+    struct pendingWord {
+        uint32_t address;
+        uint32_t mask;
+        uint32_t value;
+    };
+
+    LocalArgs *              m_la;
+    std::vector<pendingWord> m_words;
+};
+
 /*!
  *  \brief Writes a block of values to a contiguous address space.
  *  \detail Block writes are allowed on 'single' registers, provided:
@@ -258,7 +472,7 @@ void writeReg(LocalArgs * la, const std::string & regName, uint32_t value);
  *  \param la Local arguments structure
  *  \param regName Register name of the block to be written
  *  \param values Values to write to the block
- *  \param offset Start writing at an offset from the base address returned by regName
+ *  \param offset Start writing at an offset, in words, from the base address returned by regName
  */
 void writeBlock(localArgs* la, const std::string& regName, const uint32_t* values, const uint32_t& size, const uint32_t& offset=0);
 
@@ -270,10 +484,12 @@ void writeBlock(localArgs* la, const std::string& regName, const uint32_t* value
  *          Block writes are allowed on 'block' and 'fifo/incremental/port' type addresses provided:
  *           * The size does not overrun the block as defined in the address table
  *           * Including cases where an offset is provided, baseaddr+offset+size > blocksize
+ *          The register covering regAddr is found in the register index (see regIndex::findAddress), regAddr may point
+ *          inside a block register. Denied or failed writes are logged.
  *  \param regAddr Register address of the block to be written
  *  \param values Values to write to the block
  *  \param size number of words to write
- *  \param offset Start writing at an offset from the base address regAddr
+ *  \param offset Start writing at an offset, in words, from the address regAddr
  */
 void writeBlock(const uint32_t& regAddr, const uint32_t* values, const uint32_t& size, const uint32_t& offset=0);
 
@@ -0,0 +1,69 @@
+/*!
+ * \file utils/address_table.h
+ * \brief Versioned LMDB address table builds and atomic switches between versions
+ */
+
+#ifndef UTILS_ADDRESS_TABLE_H
+#define UTILS_ADDRESS_TABLE_H
+
+#include "utils.h"
+
+#include <unordered_map>
+
+static constexpr const char* ADDRESS_TABLE_LINK    = "address_table.mdb";  ///< Symbolic link to the current version of the address table, opened by the readers
+static constexpr const char* ADDRESS_TABLE_VERSION = "address_table.v";    ///< Prefix of the version directories, followed by the decimal generation
+static constexpr const char* ADDRESS_TABLE_LOCK    = "address_table.lock"; ///< Lock file serialising the address table updates
+
+/*! \struct addressTableUpdate
+ *  \brief Outcome of an address table update
+ */
+struct addressTableUpdate {
+    uint64_t generation; /*!< Generation of the new address table */
+    size_t   nNodes;     /*!< Number of nodes in the new address table */
+    size_t   nWritten;   /*!< Number of LMDB records written, including the reserved ones */
+    size_t   nRemoved;   /*!< Number of LMDB records removed, incremental updates only */
+    size_t   nFamilies;  /*!< Number of register families indexed */
+    size_t   nRegs;      /*!< Number of registers in the register index, 0 if it could not be written */
+    uint64_t dbSize;     /*!< Size of the LMDB data file, in bytes */
+};
+
+/*! \fn uint64_t readGeneration(lmdb::txn & txn, lmdb::dbi & dbi)
+ *  \brief Returns the generation stored in the address table, 0 if there is none
+ */
+uint64_t readGeneration(lmdb::txn & txn, lmdb::dbi & dbi);
+
+/*! \fn bool buildAddressTable(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & gem_path, addressTableUpdate & update, std::string & error)
+ *  \brief Builds a new version of the address table and makes it the current one
+ *  \details The LMDB environment and the register index are written to a new `address_table.v<generation>` directory,
+ *           with the records inserted in key order (MDB_APPEND) and the map sized from the number and size of the
+ *           records. ADDRESS_TABLE_LINK is then atomically replaced by a link to the new directory. Processes reading
+ *           the table keep their snapshot of the previous version, and switch to the new one on their next call to
+ *           getLocalArgs. The previous version is kept for the readers which resolved the link just before the switch,
+ *           older ones are removed.
+ *           A table left by earlier releases as a plain directory is moved to a version directory first.
+ *           The process-wide handles of getLocalArgs must have been released.
+ *  \param nodes Parsed address table
+ *  \param gem_path Directory holding the address table
+ *  \param update Outcome of the update
+ *  \param error Reason of the failure
+ *  \returns true on success
+ */
+bool buildAddressTable(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & gem_path,
+                       addressTableUpdate & update, std::string & error);
+
+/*! \fn bool patchAddressTable(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & gem_path, addressTableUpdate & update, std::string & error)
+ *  \brief Updates the current version of the address table in place, only rewriting the records which changed
+ *  \details The records are compared with the current ones in key order, the changed and new ones are written and the
+ *           stale ones removed, all in a single LMDB write transaction: the readers see either the old or the new
+ *           table. Falls back to buildAddressTable if there is no current table.
+ *           The process-wide handles of getLocalArgs must have been released.
+ *  \param nodes Parsed address table
+ *  \param gem_path Directory holding the address table
+ *  \param update Outcome of the update
+ *  \param error Reason of the failure
+ *  \returns true on success
+ */
+bool patchAddressTable(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & gem_path,
+                       addressTableUpdate & update, std::string & error);
+
+#endif
@@ -0,0 +1,63 @@
+/*!
+ * \file utils/batch.h
+ * \brief Server-side execution of register operation programs
+ */
+
+#ifndef UTILS_BATCH_H
+#define UTILS_BATCH_H
+
+#include "utils.h"
+
+/*! \enum batchOp
+ *  \brief Operation codes of an execBatch program
+ *  \details A program is an array of 32-bit words. Every operation starts with a header word holding the operation code
+ *           in bits [31:24] and an argument in bits [23:0], which is the index of the register in the name table for all
+ *           the operations but BATCH_SLEEP, followed by its operands:
+ *            - BATCH_READ_REG: no operand, pushes the register value, mask applied, to the results
+ *            - BATCH_WRITE_REG: value, mask applied
+ *            - BATCH_READ_BLOCK: size, offset; pushes size words to the results
+ *            - BATCH_WRITE_BLOCK: size, offset, then the size words to write
+ *            - BATCH_SLEEP: the header argument is the number of microseconds to sleep
+ *            - BATCH_POLL: mask, value, timeout in microseconds; waits until (register & mask) == value, see
+ *              waitForRegLocal, then pushes the last value read, mask applied. The program is aborted on timeout.
+ */
+enum batchOp : uint8_t {
+    BATCH_READ_REG    = 1,
+    BATCH_WRITE_REG   = 2,
+    BATCH_READ_BLOCK  = 3,
+    BATCH_WRITE_BLOCK = 4,
+    BATCH_SLEEP       = 5,
+    BATCH_POLL        = 6,
+};
+
+/*! \fn uint32_t batchHeader(batchOp op, uint32_t arg)
+ *  \brief Builds the header word of an operation
+ */
+inline uint32_t batchHeader(batchOp op, uint32_t arg)
+{
+    return (static_cast<uint32_t>(op) << 24) | (arg & 0xFFFFFF);
+}
+
+/*! \fn bool execBatchLocal(localArgs * la, const std::vector<std::string> & regNames, const std::vector<uint32_t> & program, std::vector<uint32_t> & results, uint32_t & nExecuted)
+ *  \brief Executes a register operation program, see batchOp
+ *  \details All the register names are resolved before the first operation is executed. Consecutive register
+ *           accesses share a memhub transaction, which is closed while sleeping or polling.
+ *  \param la Local arguments structure
+ *  \param regNames Name table of the program
+ *  \param program Program words
+ *  \param results Values read by the program, in execution order
+ *  \param nExecuted Number of operations completed
+ *  \returns false if the program could not be executed entirely, the error being recorded in the error ring
+ */
+bool execBatchLocal(localArgs * la, const std::vector<std::string> & regNames, const std::vector<uint32_t> & program,
+                    std::vector<uint32_t> & results, uint32_t & nExecuted);
+
+/*! \fn void execBatch(const RPCMsg *request, RPCMsg *response)
+ *  \brief Executes a register operation program, see batchOp
+ *  \param request RPC request message, with the "names" string array and the "program" word array
+ *  \param response RPC response message, with the "data" word array of the values read and the number of operations
+ *         "executed"
+ */
+void execBatch(const RPCMsg *request, RPCMsg *response);
+
+#endif
@@ -0,0 +1,146 @@
+/*!
+ * \file utils/errors.h
+ * \brief Register access error codes and the per-request error ring
+ */
+
+#ifndef UTILS_ERRORS_H
+#define UTILS_ERRORS_H
+
+#include "moduleapi.h"
+
+#include <cstdint>
+#include <string>
+
+/*! \enum regError
+ *  Register access error codes
+ */
+enum regError : uint16_t {
+    REG_OK                 = 0,
+    REG_ERR_NOT_FOUND      = 1,  ///< No such register in the address table
+    REG_ERR_NO_READ_PERM   = 2,  ///< Register is not readable
+    REG_ERR_NO_WRITE_PERM  = 3,  ///< Register is not writable
+    REG_ERR_READ           = 4,  ///< memhub read failed
+    REG_ERR_WRITE          = 5,  ///< memhub write failed
+    REG_ERR_MALFORMED      = 6,  ///< Register descriptor cannot be decoded
+    REG_ERR_MASKED_BLOCK   = 7,  ///< Block access attempted on a masked register
+    REG_ERR_SINGLE_BLOCK   = 8,  ///< Block access of more than one word attempted on a single register
+    REG_ERR_BLOCK_RANGE    = 9,  ///< Block access going past the register size
+    REG_ERR_MASKED_WRITE   = 10, ///< Masked write not done, the register could not be read
+    REG_ERR_NO_INDEX       = 11, ///< No register index matching the address table
+    REG_ERR_NO_REG_AT_ADDR = 12, ///< No register covers the address
+    REG_ERR_READ_RETRIED   = 13, ///< memhub read succeeded after failed attempts, not an error but worth knowing
+    REG_ERR_STATIC_REGS    = 14, ///< Static registers (GEM_STATIC_REGS) do not match the address table
+    REG_ERR_INDEX_RANGE    = 15, ///< Register family index out of range
+    REG_ERR_INDEX_COUNT    = 16, ///< Register family accessed with the wrong number of indices
+    REG_ERR_BATCH_PROGRAM  = 17, ///< Malformed execBatch program
+    REG_ERR_TIMEOUT        = 18, ///< Register did not reach the expected value in time
+    REG_ERR_WAIT_CONDITION = 19, ///< Unknown waitForReg condition
+    REG_ERR_STALE_IDS      = 20, ///< Register IDs of another address table generation
+    REG_ERR_ID_RANGE       = 21, ///< Register ID not in the register index
+    REG_ERR_BAD_REQUEST    = 22, ///< Missing or inconsistent request key, given as the name of the record
+    REG_ERR_EMPTY_SUBTREE  = 23, ///< No readable register below the node
+};
+
+/*! \enum regErrorFlag
+ *  Flags of an error record
+ */
+enum regErrorFlag : uint8_t {
+    REG_ERR_FLAG_REPORT    = 0x1, ///< Reported in the "error" key of the response, otherwise only listed in "errors"
+    REG_ERR_FLAG_TRUNCATED = 0x2  ///< Only the end of the register name was kept
+};
+
+/*! \fn const char * regErrorString(regError code)
+ *  \brief Returns the description of an error code
+ */
+const char * regErrorString(regError code);
+
+/*! \struct regErrorRecord
+ *  \brief Error record, consecutive identical errors are counted in the same record
+ */
+struct regErrorRecord {
+    uint16_t code;     /*!< regError */
+    uint8_t  flags;    /*!< regErrorFlag bits */
+    uint8_t  nameLen;  /*!< Length of name */
+    uint32_t count;    /*!< Number of consecutive occurrences */
+    uint32_t address;  /*!< Register address, if known */
+    uint32_t args[3];  /*!< Code dependent arguments, e.g. offset, size and register size of a block access */
+    char     name[40]; /*!< Register name, not NUL terminated */
+};
+
+/*! \class regErrorRing
+ *  \brief Fixed size ring of the register access errors of the request being served
+ *  \details Recording an error copies a few words and at most sizeof(regErrorRecord::name) characters, it never
+ *           allocates or formats: the text is only rendered once the request is served, see regErrorReporter.
+ *           When more errors occur than the ring holds, the oldest ones are dropped and only counted.
+ */
+class regErrorRing {
+public:
+    static constexpr uint32_t SIZE = 16; ///< Number of records kept
+
+    /*! \brief Records an error
+     *  \param code Error code
+     *  \param name Register name, may be nullptr, only its end is kept if it is too long
+     *  \param len Length of name
+     *  \param address Register address
+     *  \param report Whether the error is reported in the "error" key of the response, or only listed in "errors"
+     *  \param arg0,arg1,arg2 Code dependent arguments
+     */
+    void push(regError code, const char * name, size_t len, uint32_t address, bool report,
+              uint32_t arg0=0, uint32_t arg1=0, uint32_t arg2=0) noexcept;
+
+    void push(regError code, const std::string & name, uint32_t address, bool report,
+              uint32_t arg0=0, uint32_t arg1=0, uint32_t arg2=0) noexcept
+    {
+        push(code, name.data(), name.size(), address, report, arg0, arg1, arg2);
+    }
+
+    /*! \brief Number of errors recorded since the ring was cleared, including the dropped ones */
+    uint32_t total() const { return m_total; }
+
+    /*! \brief Code of the last error recorded, REG_OK if none */
+    regError last() const { return m_used ? static_cast<regError>(m_records[(m_next + SIZE - 1) % SIZE].code) : REG_OK; }
+
+    /*! \brief Logs the errors and writes them to the response, if any: "error_codes" and "errors" hold one entry per
+     *         record, oldest first, preceded by a REG_OK entry counting the dropped errors if any, and "error" is set to
+     *         the last reported error unless the method already set it
+     */
+    void render(RPCMsg * response) const;
+
+    /*! \brief Forgets all the errors */
+    void clear() { m_next = m_used = m_total = 0; }
+
+private:
+    regErrorRecord m_records[SIZE];
+    uint32_t       m_next{0};  ///< slot of the next record
+    uint32_t       m_used{0};  ///< number of valid records
+    uint32_t       m_total{0};
+};
+
+/*! \fn regErrorRing & regErrors()
+ *  \brief Returns the error ring of the request being served by this process
+ */
+regErrorRing & regErrors();
+
+/*! \class regErrorReporter
+ *  \brief Renders the error ring into the response when the outermost reporter of a request goes out of scope
+ *  \details Held by LocalArgs: the ring is cleared when getLocalArgs is called at the start of a method, and
+ *           rendered when the method returns.
+ */
+class regErrorReporter {
+public:
+    explicit regErrorReporter(RPCMsg * response);
+    regErrorReporter(regErrorReporter && other) noexcept : m_response(other.m_response), m_counted(other.m_counted)
+    {
+        other.m_response = nullptr;
+        other.m_counted  = false;
+    }
+    ~regErrorReporter();
+    regErrorReporter(const regErrorReporter &) = delete;
+    regErrorReporter & operator=(const regErrorReporter &) = delete;
+
+private:
+    RPCMsg * m_response;
+    bool     m_counted = true; ///< Whether this reporter holds one of the live reporter counts, false once moved from
+};
+
+#endif
@@ -0,0 +1,130 @@
+/*!
+ * \file utils/families.h
+ * \brief Indexed register families: stride based address resolution for arrayed address table nodes
+ */
+
+#ifndef UTILS_FAMILIES_H
+#define UTILS_FAMILIES_H
+
+#include "utils.h"
+
+#include <unordered_map>
+
+static constexpr size_t REG_FAMILY_MAX_DIMS = 4;                  ///< Maximum number of indexed levels in a family pattern
+static constexpr const char* LMDB_FAMILY_PREFIX = "__family__."; ///< Reserved LMDB key prefix under which the family index is stored
+
+/*! \struct regFamilyDescriptor
+ *  \brief Fixed layout binary description of a register family, stored in LMDB next to the register descriptors
+ *  \details A family groups all the nodes whose names only differ by the numerical suffix of some of their levels,
+ *           e.g. `GEM_AMC.OH.OH*.GEB.VFAT*.VFAT_CHANNELS.CHANNEL*`. The address of a member is
+ *           \f$base + \sum_j (i_j - first_j) \cdot stride_j\f$.
+ */
+struct __attribute__((packed)) regFamilyDescriptor {
+    regDescriptor desc;                   /*!< Descriptor of the first member, its address is the family base address */
+    uint8_t  nDims;                       /*!< Number of indexed levels */
+    uint8_t  reserved[3];                 /*!< Padding, always 0 */
+    uint32_t first[REG_FAMILY_MAX_DIMS];  /*!< Lowest index of each level */
+    uint32_t count[REG_FAMILY_MAX_DIMS];  /*!< Number of indices of each level */
+    int32_t  stride[REG_FAMILY_MAX_DIMS]; /*!< Address increment per index of each level */
+};
+
+/*! \class regFamily
+ *  \brief Handle on a register family, resolving member addresses without building their names
+ *  \details If the family is not indexed in the address table (e.g. the table predates the index, or the family is not
+ *           an affine, dense array), the member names are built from the pattern and looked up one by one instead.
+ */
+class regFamily {
+public:
+    /*! \brief Looks up the family matching pattern, where each indexed level carries a trailing '*' */
+    regFamily(localArgs * la, const std::string & pattern);
+
+    /*! \brief true if member addresses are computed from the family strides */
+    bool indexed() const { return m_indexed; }
+
+    /*! \brief Register descriptor shared by all the members, only meaningful if indexed() */
+    const regDescriptor & descriptor() const { return m_fam.desc; }
+
+    /*! \brief Returns the address of a member, 0xdeaddead if the indices are out of range */
+    template<typename... Idx>
+    uint32_t address(Idx... idx) const
+    {
+        static_assert(sizeof...(Idx) <= REG_FAMILY_MAX_DIMS, "too many family indices");
+        const uint32_t i[sizeof...(Idx)+1] = {static_cast<uint32_t>(idx)..., 0};
+        return addressOf(i, sizeof...(Idx));
+    }
+
+    /*! \brief Returns the descriptor of a member, without read or write permission if it does not exist */
+    template<typename... Idx>
+    regDescriptor member(Idx... idx) const
+    {
+        static_assert(sizeof...(Idx) <= REG_FAMILY_MAX_DIMS, "too many family indices");
+        const uint32_t i[sizeof...(Idx)+1] = {static_cast<uint32_t>(idx)..., 0};
+        return memberOf(i, sizeof...(Idx));
+    }
+
+    /*! \brief Layout of the family, only meaningful if indexed() */
+    const regFamilyDescriptor & layout() const { return m_fam; }
+
+    /*! \brief Reads a member, with the register mask applied as in readReg */
+    template<typename... Idx>
+    uint32_t read(Idx... idx) const
+    {
+        static_assert(sizeof...(Idx) <= REG_FAMILY_MAX_DIMS, "too many family indices");
+        const uint32_t i[sizeof...(Idx)+1] = {static_cast<uint32_t>(idx)..., 0};
+        uint32_t value = 0xdeaddead;
+        readOf(i, sizeof...(Idx), value);
+        return value;
+    }
+
+    /*! \brief Reads a member into value, with the register mask applied as in readReg(la, name, value)
+     *  \returns REG_OK, or the code of the error recorded in the error ring
+     */
+    template<typename... Idx>
+    regError tryRead(uint32_t & value, Idx... idx) const
+    {
+        static_assert(sizeof...(Idx) <= REG_FAMILY_MAX_DIMS, "too many family indices");
+        const uint32_t i[sizeof...(Idx)+1] = {static_cast<uint32_t>(idx)..., 0};
+        return readOf(i, sizeof...(Idx), value);
+    }
+
+    /*! \brief Writes a member, with the register mask applied as in writeReg */
+    template<typename... Idx>
+    void write(uint32_t value, Idx... idx) const
+    {
+        static_assert(sizeof...(Idx) <= REG_FAMILY_MAX_DIMS, "too many family indices");
+        const uint32_t i[sizeof...(Idx)+1] = {static_cast<uint32_t>(idx)..., 0};
+        writeOf(value, i, sizeof...(Idx));
+    }
+
+private:
+    uint32_t addressOf(const uint32_t * idx, size_t n, bool report=false) const;
+    regDescriptor memberOf(const uint32_t * idx, size_t n) const;
+    regError readOf(const uint32_t * idx, size_t n, uint32_t & value) const;
+    void writeOf(uint32_t value, const uint32_t * idx, size_t n) const;
+    std::string memberName(const uint32_t * idx, size_t n) const;
+
+    localArgs *         m_la;
+    std::string         m_pattern;
+    bool                m_indexed;
+    regFamilyDescriptor m_fam;
+};
+
+/*! \fn regFamily family(localArgs * la, const std::string & pattern)
+ *  \brief Returns the register family matching pattern, e.g. `family(la, "GEM_AMC.OH.OH*.GEB.VFAT*.VFAT_CHANNELS.CHANNEL*").address(ohN, vfatN, chan)`
+ *  \param la Local arguments structure
+ *  \param pattern Register name with a '*' in place of the numerical suffix of each indexed level
+ */
+regFamily family(localArgs * la, const std::string & pattern);
+
+/*! \fn size_t buildRegFamilies(const std::unordered_map<std::string, xhal::utils::Node> & nodes, std::vector<std::pair<std::string, regFamilyDescriptor> > & indexed)
+ *  \brief Detects the arrayed nodes of the address table and builds the index of the register families
+ *  \details Only families with at least two members, covering a dense range of indices, sharing the same mask, permissions,
+ *           mode and size, and whose addresses are an affine function of the indices are indexed.
+ *  \param nodes Parsed address table
+ *  \param indexed Receives the LMDB records of the index, keyed by LMDB_FAMILY_PREFIX followed by the family pattern
+ *  \returns the number of families indexed
+ */
+size_t buildRegFamilies(const std::unordered_map<std::string, xhal::utils::Node> & nodes,
+                        std::vector<std::pair<std::string, regFamilyDescriptor> > & indexed);
+
+#endif
@@ -0,0 +1,135 @@
+/*!
+ * \file utils/family_rules.h
+ * \brief Rules grouping the address table nodes into register families, shared by buildRegFamilies and
+ *        tools/gen_static_regs.cpp so that the run-time and compile-time families always agree
+ */
+
+#ifndef UTILS_FAMILY_RULES_H
+#define UTILS_FAMILY_RULES_H
+
+#include "utils/families.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/*! \struct regFamilyMember
+ *  \brief Member of a register family, with the indices of its indexed levels
+ */
+struct regFamilyMember {
+    uint32_t      idx[REG_FAMILY_MAX_DIMS]; /*!< Numerical suffix of each indexed level */
+    regDescriptor desc;                     /*!< Descriptor of the member */
+};
+
+/*! \brief Splits a register name into its family pattern and level indices
+ *  \details Each level ending with a numerical suffix is an indexed level, the suffix being replaced by a '*' in the
+ *           pattern, e.g. `GEM_AMC.OH.OH1.GEB.VFAT3` belongs to `GEM_AMC.OH.OH*.GEB.VFAT*` with the indices {1, 3}.
+ *  \returns The number of indexed levels, 0 if there is none or more than REG_FAMILY_MAX_DIMS
+ */
+inline size_t regFamilyPattern(const std::string & name, std::string & pattern, uint32_t * idx)
+{
+    size_t nDims = 0;
+    size_t pos   = 0;
+    pattern.clear();
+    while (true) {
+        size_t end = name.find('.', pos);
+        if (end == std::string::npos)
+            end = name.size();
+        size_t digits = end;
+        while (digits > pos && std::isdigit(static_cast<unsigned char>(name[digits-1])))
+            --digits;
+        if (digits > pos && digits < end) {
+            if (nDims == REG_FAMILY_MAX_DIMS)
+                return 0;
+            pattern.append(name, pos, digits-pos);
+            pattern += '*';
+            idx[nDims++] = std::strtoul(name.c_str()+digits, nullptr, 10);
+        } else {
+            pattern.append(name, pos, end-pos);
+        }
+        if (end == name.size())
+            break;
+        pattern += '.';
+        pos = end+1;
+    }
+    return nDims;
+}
+
+/*! \brief Computes the layout of a family
+ *  \details The members must cover every combination of indices exactly once, share the mask, permission, mode and
+ *           size of the first member, and their addresses must be an affine function of the indices.
+ *  \returns false, with the reason in error, if the members cannot be indexed
+ */
+inline bool indexRegFamily(const std::vector<regFamilyMember> & members, size_t nDims, regFamilyDescriptor & fam,
+                           std::string & error)
+{
+    fam = regFamilyDescriptor();
+    fam.nDims = nDims;
+    uint32_t last[REG_FAMILY_MAX_DIMS] = {0};
+    for (size_t d = 0; d < nDims; ++d) {
+        fam.first[d] = members.front().idx[d];
+        last[d]      = members.front().idx[d];
+    }
+    for (auto const& m : members) {
+        for (size_t d = 0; d < nDims; ++d) {
+            fam.first[d] = std::min(fam.first[d], m.idx[d]);
+            last[d]      = std::max(last[d], m.idx[d]);
+        }
+    }
+
+    uint64_t total = 1;
+    uint64_t mult[REG_FAMILY_MAX_DIMS];
+    for (size_t d = nDims; d-- > 0; ) {
+        fam.count[d] = last[d] - fam.first[d] + 1;
+        mult[d]      = total;
+        total       *= fam.count[d];
+        if (total > members.size())
+            break;
+    }
+    if (total != members.size()) {
+        error = "the members do not cover a dense range of indices";
+        return false;
+    }
+
+    std::vector<const regFamilyMember*> grid(total, nullptr);
+    for (auto const& m : members) {
+        uint64_t lin = 0;
+        for (size_t d = 0; d < nDims; ++d)
+            lin += (m.idx[d] - fam.first[d]) * mult[d];
+        if (grid[lin]) {
+            error = "several members have the same indices";
+            return false;
+        }
+        grid[lin] = &m;
+    }
+
+    fam.desc = grid[0]->desc;
+    for (size_t d = 0; d < nDims; ++d) {
+        if (fam.count[d] < 2)
+            continue;
+        const int64_t stride = static_cast<int64_t>(grid[mult[d]]->desc.address) - fam.desc.address;
+        if (stride < INT32_MIN || stride > INT32_MAX) {
+            error = "the address stride does not fit in 32 bits";
+            return false;
+        }
+        fam.stride[d] = stride;
+    }
+
+    for (size_t lin = 0; lin < total; ++lin) {
+        const regFamilyMember & m = *grid[lin];
+        int64_t address = fam.desc.address;
+        for (size_t d = 0; d < nDims; ++d)
+            address += static_cast<int64_t>(m.idx[d] - fam.first[d]) * fam.stride[d];
+        if (address != m.desc.address || m.desc.mask != fam.desc.mask || m.desc.perm != fam.desc.perm ||
+            m.desc.mode != fam.desc.mode || m.desc.size != fam.desc.size) {
+            error = "the member addresses are not an affine function of the indices, or the members differ";
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
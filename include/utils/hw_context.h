@@ -0,0 +1,59 @@
+/*!
+ * \file utils/hw_context.h
+ * \brief Slow-changing hardware state resolved once per call: firmware release and number of OptoHybrids
+ */
+
+#ifndef UTILS_HW_CONTEXT_H
+#define UTILS_HW_CONTEXT_H
+
+#include <cstdint>
+
+struct localArgs;
+
+static constexpr uint32_t HW_CONTEXT_TTL_MS = 1000; ///< How long the firmware release and number of OptoHybrids are shared between calls
+
+/*! \enum hwContextField
+ *  Fields of hwContext resolved so far
+ */
+enum hwContextField : uint32_t {
+    HW_CTX_FW_MAJOR  = 0x1,
+    HW_CTX_NUM_OF_OH = 0x2
+};
+
+/*! \struct hwContext
+ *  \brief Hardware state of the call, held by LocalArgs and filled lazily
+ *  \details Each field is read from the hardware the first time it is asked for during the call. The firmware release
+ *           and the number of OptoHybrids are also shared between calls for HW_CONTEXT_TTL_MS, as long as the address
+ *           table generation does not change. Everything is dropped when hwContextInvalidate bumps the epoch,
+ *           e.g. on a link reset.
+ */
+struct hwContext {
+    uint64_t epoch;                          /*!< hwContextEpoch when the fields were read */
+    uint32_t valid;                          /*!< hwContextField bits */
+    uint32_t fwMajor;                        /*!< GEM_AMC.GEM_SYSTEM.RELEASE.MAJOR */
+    uint32_t numOfOh;                        /*!< GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH */
+};
+
+/*! \fn uint64_t hwContextEpoch()
+ *  \brief Returns the epoch of the hardware state, the hwContext of older epochs are stale
+ */
+uint64_t hwContextEpoch();
+
+/*! \fn void hwContextInvalidate()
+ *  \brief Drops the hardware state of all the calls, to be called when an action changes it, e.g. a link reset
+ */
+void hwContextInvalidate();
+
+/*! \fn uint32_t hwFwMajor(localArgs * la)
+ *  \brief Returns the firmware release major, read at most once per call, 0xdeaddead if it cannot be read
+ *  \param la Local arguments structure
+ */
+uint32_t hwFwMajor(localArgs * la);
+
+/*! \fn uint32_t hwNumOfOH(localArgs * la)
+ *  \brief Returns the number of OptoHybrids supported by the firmware, read at most once per call, 0xdeaddead if it cannot be read
+ *  \param la Local arguments structure
+ */
+uint32_t hwNumOfOH(localArgs * la);
+
+#endif
@@ -0,0 +1,24 @@
+/*!
+ * \file utils/lock_domains.h
+ * \brief Memhub lock domains derived from the address table
+ */
+
+#ifndef UTILS_LOCK_DOMAINS_H
+#define UTILS_LOCK_DOMAINS_H
+
+#include "utils.h"
+
+#include <unordered_map>
+
+/*! \fn size_t buildLockDomains(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & path)
+ *  \brief Splits the address space into memhub lock domains and writes them to the memhub domain file
+ *  \details One domain is made of the registers of each second level module, e.g. `GEM_AMC.DAQ`, and arrayed third level
+ *           modules get a domain each, e.g. `GEM_AMC.OH.OH3`. Overlapping domains are merged, and the closest domains
+ *           are merged until at most MEMHUB_MAX_DOMAINS remain.
+ *  \param nodes Parsed address table
+ *  \param path Domain file to write, see memhub.h for the format
+ *  \returns the number of domains written, 0 if the file could not be written
+ */
+size_t buildLockDomains(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & path);
+
+#endif
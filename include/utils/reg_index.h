@@ -0,0 +1,176 @@
+/*!
+ * \file utils/reg_index.h
+ * \brief Stable register IDs and the memory mapped register index
+ */
+
+#ifndef UTILS_REG_INDEX_H
+#define UTILS_REG_INDEX_H
+
+#include "utils.h"
+
+#include <unordered_map>
+
+static constexpr const char* REG_INDEX_FILE    = "address_table.idx"; ///< Name of the register index file, in the directory of the LMDB address table
+static constexpr uint32_t    REG_INDEX_MAGIC   = 0x58444952;          ///< "RIDX"
+static constexpr uint32_t    REG_INDEX_VERSION = 1;                   ///< Current layout of the register index file
+static constexpr uint32_t    REG_ID_INVALID    = 0xFFFFFFFF;          ///< ID returned for unknown registers
+
+/*! \enum regIndexSection
+ *  Sections of the register index file. A section missing from the file has a zero size.
+ */
+enum regIndexSection : uint32_t {
+    REG_INDEX_DESCRIPTORS  = 0, ///< regDescriptor array, indexed by ID
+    REG_INDEX_NAME_OFFSETS = 1, ///< uint32_t array, indexed by ID, offsets of the names in REG_INDEX_NAMES
+    REG_INDEX_NAMES        = 2, ///< NUL terminated names, in ID order
+    REG_INDEX_HASH_PILOTS  = 3, ///< uint32_t array, displacement of each bucket of the minimal perfect hash
+    REG_INDEX_HASH_SLOTS   = 4, ///< uint32_t array, ID of the register hashed to each slot of the minimal perfect hash
+    REG_INDEX_BY_ADDRESS   = 5, ///< uint32_t array, IDs of the registers (nodes with permissions) sorted by address
+    REG_INDEX_ADDRESS_ENDS = 6, ///< uint32_t array, in the order of REG_INDEX_BY_ADDRESS, highest byte address covered by the registers up to each one
+    REG_INDEX_N_SECTIONS   = 8
+};
+
+/*! \struct regIndexHeader
+ *  \brief Header of the register index file, followed by the sections, each aligned on 8 bytes
+ */
+struct regIndexHeader {
+    uint32_t magic;      /*!< Always REG_INDEX_MAGIC */
+    uint32_t version;    /*!< REG_INDEX_VERSION */
+    uint64_t generation; /*!< Generation of the LMDB address table the index was built with */
+    uint32_t nRegs;      /*!< Number of registers, IDs run from 0 to nRegs-1 */
+    uint32_t hashSeed;   /*!< Seed of the name hash used by the minimal perfect hash */
+    struct {
+        uint64_t offset; /*!< Offset from the start of the file */
+        uint64_t size;   /*!< Size in bytes */
+    } sections[REG_INDEX_N_SECTIONS];
+};
+
+/*! \class regIndex
+ *  \brief Read-only view of the register index file
+ *  \details Register IDs are the ranks of the node names in byte-wise sorted order: they are dense, the same address
+ *           table always yields the same IDs, and they are only valid for the generation of the address table the
+ *           index was built with. The file is mapped once per process and shared by all the RPC calls.
+ *
+ *           Names are looked up with a CHD minimal perfect hash built with the index: the name hash selects a bucket,
+ *           the bucket displacement selects the slot holding the ID, and a single string compare tells whether the
+ *           name is in the table, whatever the size of the table. Index files without the hash sections are
+ *           searched by bisection.
+ */
+class regIndex {
+public:
+    /*! \brief Number of registers */
+    uint32_t size() const { return m_nRegs; }
+
+    /*! \brief Generation of the address table the index was built with */
+    uint64_t generation() const { return m_generation; }
+
+    /*! \brief Descriptor of a register, id must be lower than size() */
+    const regDescriptor & descriptor(uint32_t id) const { return m_descs[id]; }
+
+    /*! \brief Name of a register, id must be lower than size() */
+    const char * name(uint32_t id) const { return m_names + m_nameOffsets[id]; }
+
+    /*! \brief Returns the ID of a register, REG_ID_INVALID if not found */
+    uint32_t find(const std::string & regName) const;
+
+    /*! \brief true if find uses the minimal perfect hash */
+    bool hashed() const { return m_slots != nullptr; }
+
+    /*! \brief Collects the IDs of the registers covering the word at address, in ID order
+     *  \details Single, FIFO and port registers cover the word at their address, block and incremental registers
+     *           cover size words from their address. The registers starting at or below the given address are found
+     *           by bisection of the address ordered IDs, then scanned back while the highest address covered by the
+     *           registers up to them reaches the given one, so a block is found past the start of the registers
+     *           it overlaps. Index files without that running maximum only give the registers starting at the
+     *           highest address not above the given one.
+     *  \param address Byte address of a word
+     *  \param ids Receives the IDs, empty if no register covers the word or if the index has no address section
+     */
+    void findAddress(uint32_t address, std::vector<uint32_t> & ids) const;
+
+    /*! \brief Returns the index built for the given address table generation, mapping it on first use
+     *  \returns nullptr if the index file is missing, invalid, or was built for another generation
+     */
+    static const regIndex * open(uint64_t generation);
+
+private:
+    regIndex() = default;
+    bool map(const std::string & path);
+    void unmap();
+
+    void *                m_map{nullptr};
+    size_t                m_mapSize{0};
+    uint64_t              m_generation{0};
+    uint32_t              m_nRegs{0};
+    const regDescriptor * m_descs{nullptr};
+    const uint32_t *      m_nameOffsets{nullptr};
+    const char *          m_names{nullptr};
+    uint32_t              m_hashSeed{0};
+    uint32_t              m_nBuckets{0};
+    const uint32_t *      m_pilots{nullptr};
+    const uint32_t *      m_slots{nullptr};
+    uint32_t              m_nByAddress{0};
+    const uint32_t *      m_byAddress{nullptr};
+    const uint32_t *      m_addressEnds{nullptr};
+};
+
+/*! \fn const regIndex * getRegIndex(LocalArgs * la)
+ *  \brief Returns the register index matching the address table snapshot of la, nullptr if there is none
+ *  \param la Local arguments structure
+ */
+const regIndex * getRegIndex(LocalArgs * la);
+
+/*! \fn size_t buildRegIndex(const std::unordered_map<std::string, xhal::utils::Node> & nodes, uint64_t generation, const std::string & path)
+ *  \brief Assigns the register IDs, builds the minimal perfect hash of the names and writes the register index file
+ *  \details The file is written next to its final location and renamed, so that readers never see a partial index.
+ *  \param nodes Parsed address table
+ *  \param generation Generation of the LMDB address table built from the same nodes
+ *  \param path Index file to write
+ *  \returns the number of registers indexed, 0 if the file could not be written
+ */
+size_t buildRegIndex(const std::unordered_map<std::string, xhal::utils::Node> & nodes, uint64_t generation, const std::string & path);
+
+/*! \fn uint32_t regWords(const regDescriptor & desc)
+ *  \brief Number of consecutive words covered by a register, see regIndex::findAddress
+ */
+inline uint32_t regWords(const regDescriptor & desc)
+{
+    return ((desc.mode == REG_MODE_BLOCK || desc.mode == REG_MODE_INCREMENTAL) && desc.size > 1) ? desc.size : 1;
+}
+
+/*! \fn void resolveRegs(const RPCMsg *request, RPCMsg *response)
+ *  \brief Resolves register names into register IDs and descriptors
+ *  \param request RPC request message, with the "names" string array
+ *  \param response RPC response message, with the "ids", "addresses", "masks", "sizes" and "flags" (regPermission bits
+ *         in [7:0], regMode in [15:8]) arrays in the order of names, and the low word of the address table
+ *         "generation" the IDs are valid for. Unknown registers get REG_ID_INVALID and "error" is set.
+ */
+void resolveRegs(const RPCMsg *request, RPCMsg *response);
+
+/*! \fn void readRegsById(const RPCMsg *request, RPCMsg *response)
+ *  \brief Reads a set of registers given by ID, register masks applied as in readReg
+ *  \details Contiguous addresses are merged into block reads, all within a single memhub transaction.
+ *           Registers which cannot be read are set to 0xdeaddead.
+ *  \param request RPC request message, with the "ids" array and optionally the "generation" returned by resolveRegs
+ *  \param response RPC response message, with the "data" array in the order of ids
+ */
+void readRegsById(const RPCMsg *request, RPCMsg *response);
+
+/*! \fn void writeRegsById(const RPCMsg *request, RPCMsg *response)
+ *  \brief Writes a set of registers given by ID, register masks applied as in writeReg
+ *  \details Writes to fields of the same word are merged into a single read-modify-write, see memhub_list_write_masked.
+ *  \param request RPC request message, with the "ids" and "data" arrays and optionally the "generation" returned by resolveRegs
+ *  \param response RPC response message, with the indices of the entries which could not be written in "failed"
+ */
+void writeRegsById(const RPCMsg *request, RPCMsg *response);
+
+/*! \fn void addressToName(const RPCMsg *request, RPCMsg *response)
+ *  \brief Maps register addresses back to the registers covering them
+ *  \details Several registers can cover the same word, e.g. the fields of a word: they are all returned, "counts" tells
+ *            how many belong to each address.
+ *  \param request RPC request message, with the "addresses" array
+ *  \param response RPC response message, with the "counts" array in the order of addresses, and the "names", "ids",
+ *         "masks" and "flags" (as in resolveRegs) arrays of the registers found, grouped by address
+ */
+void addressToName(const RPCMsg *request, RPCMsg *response);
+
+#endif
@@ -0,0 +1,177 @@
+/*!
+ * \file utils/static_regs.h
+ * \brief Compile-time register descriptors generated from the address table, enabled by GEM_STATIC_REGS
+ */
+
+#ifndef UTILS_STATIC_REGS_H
+#define UTILS_STATIC_REGS_H
+
+#include "utils.h"
+#include "utils/families.h"
+
+/*! \struct staticReg
+ *  \brief Register, or register family, resolved when the modules are built
+ *  \details Generated by tools/gen_static_regs.cpp from the address table XML, for the registers listed in
+ *           conf/static_regs.txt. A single register is a family without indexed levels. The accessors mirror those of
+ *           regFamily and namedReg, so that the hot loops are written once for both, see REG_FAMILY and REG_SINGLE.
+ *           The address of a member is \f$base + \sum_j (i_j - first_j) \cdot stride_j\f$, as in regFamilyDescriptor.
+ */
+struct staticReg {
+    const char * name;                        /*!< Register name, or family pattern with a '*' for each indexed level */
+    uint32_t     base;                        /*!< Address of the first member */
+    uint32_t     mask;                        /*!< Register mask */
+    uint8_t      shift;                       /*!< Position of the lowest set bit of the mask */
+    uint8_t      perm;                        /*!< regPermission bits */
+    uint8_t      mode;                        /*!< regMode */
+    uint8_t      nDims;                       /*!< Number of indexed levels */
+    uint32_t     size;                        /*!< Register size in 32-bit words */
+    uint32_t     first[REG_FAMILY_MAX_DIMS];  /*!< Lowest index of each level */
+    uint32_t     count[REG_FAMILY_MAX_DIMS];  /*!< Number of indices of each level */
+    int32_t      stride[REG_FAMILY_MAX_DIMS]; /*!< Address increment per index of each level */
+
+    /*! \brief Always true, the addresses of the members are computed */
+    constexpr bool indexed() const { return true; }
+
+    /*! \brief Returns the address of a member, 0xdeaddead if the indices are out of range */
+    template<typename... Idx>
+    constexpr uint32_t address(Idx... idx) const
+    {
+        static_assert(sizeof...(Idx) <= REG_FAMILY_MAX_DIMS, "too many register indices");
+        const uint32_t i[sizeof...(Idx)+1] = {static_cast<uint32_t>(idx)..., 0};
+        if (sizeof...(Idx) != nDims)
+            return 0xdeaddead;
+        int64_t address = base;
+        for (size_t d = 0; d < sizeof...(Idx); ++d) {
+            if (i[d] - first[d] >= count[d])
+                return 0xdeaddead;
+            address += static_cast<int64_t>(i[d] - first[d]) * stride[d];
+        }
+        return static_cast<uint32_t>(address);
+    }
+
+    /*! \brief Returns the descriptor of a member, without read or write permission if the indices are out of range */
+    template<typename... Idx>
+    constexpr regDescriptor member(Idx... idx) const
+    {
+        const uint32_t a = address(idx...);
+        return {REG_DESC_MAGIC, REG_DESC_VERSION, static_cast<uint8_t>(a == 0xdeaddead ? REG_PERM_NONE : perm),
+                mode, shift, {0, 0, 0}, a, mask, size};
+    }
+
+    /*! \brief Reads a member, with the register mask applied as in readReg */
+    template<typename... Idx>
+    uint32_t read(Idx... idx) const
+    {
+        uint32_t value = 0xdeaddead;
+        readStaticReg(*this, address(idx...), value);
+        return value;
+    }
+
+    /*! \brief Reads a member into value, with the register mask applied as in readReg(la, name, value)
+     *  \returns REG_OK, or the code of the error recorded in the error ring
+     */
+    template<typename... Idx>
+    regError tryRead(uint32_t & value, Idx... idx) const { return readStaticReg(*this, address(idx...), value); }
+
+    /*! \brief Writes a member, with the register mask applied as in writeReg */
+    template<typename... Idx>
+    void write(uint32_t value, Idx... idx) const { writeStaticReg(*this, address(idx...), value); }
+
+private:
+    static regError readStaticReg(const staticReg & reg, uint32_t address, uint32_t & value);
+    static void writeStaticReg(const staticReg & reg, uint32_t address, uint32_t value);
+};
+
+/*! \struct namedReg
+ *  \brief Single register accessed by name through readReg and writeReg, the counterpart of a static single register
+ *          when the modules are built without GEM_STATIC_REGS, see REG_SINGLE
+ */
+struct namedReg {
+    localArgs *  la;   /*!< Local arguments structure */
+    const char * name; /*!< Register name */
+
+    /*! \brief Reads the register as readReg(la, name) */
+    uint32_t read() const { return readReg(la, name); }
+
+    /*! \brief Reads the register as readReg(la, name, value) */
+    regError tryRead(uint32_t & value) const { return readReg(la, name, value); }
+
+    /*! \brief Writes the register as writeReg */
+    void write(uint32_t value) const { writeReg(la, name, value); }
+};
+
+/*! \fn uint64_t staticRegsChecksum(const staticReg * const * regs, size_t n)
+ *  \brief FNV-1a hash of the names and layouts of a set of static registers
+ *  \details Computed by the generator over the registers it emits, and by staticRegsMatch over the same registers
+ *           resolved in the runtime address table.
+ */
+inline uint64_t staticRegsChecksum(const staticReg * const * regs, size_t n)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t value, size_t bytes) {
+        for (size_t b = 0; b < bytes; ++b) {
+            hash ^= (value >> (8*b)) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    for (size_t r = 0; r < n; ++r) {
+        const staticReg & reg = *regs[r];
+        for (const char * c = reg.name; *c; ++c)
+            mix(static_cast<unsigned char>(*c), 1);
+        mix(0, 1);
+        mix(reg.base, 4);
+        mix(reg.mask, 4);
+        mix(reg.perm, 1);
+        mix(reg.mode, 1);
+        mix(reg.size, 4);
+        mix(reg.nDims, 1);
+        for (size_t d = 0; d < reg.nDims; ++d) {
+            mix(reg.first[d], 4);
+            mix(reg.count[d], 4);
+            mix(static_cast<uint32_t>(reg.stride[d]), 4);
+        }
+    }
+    return hash;
+}
+
+/*! \fn constexpr bool staticRegNameIs(const char * name, const char * expected)
+ *  \brief Compile-time string comparison, checks that a generated register is the one the code expects
+ */
+constexpr bool staticRegNameIs(const char * name, const char * expected)
+{
+    return (*name == *expected) && (*name == '\0' || staticRegNameIs(name + 1, expected + 1));
+}
+
+/*! \fn bool staticRegsMatch(LocalArgs * la)
+ *  \brief Tells whether the static registers the modules were built with match the current address table
+ *  \details The static registers are resolved in the address table and their checksum compared with the one computed
+ *           by the generator, once per address table generation. A mismatch is recorded in the error ring of the
+ *           request. Always true if the modules are built without GEM_STATIC_REGS.
+ *  \param la Local arguments structure
+ */
+bool staticRegsMatch(LocalArgs * la);
+
+#ifdef GEM_STATIC_REGS
+#include "static_regs_gen.h"
+
+/*! \brief Declares var as the static register id, checking that it is generated from pattern */
+#define REG_FAMILY(var, la, id, pattern)                                                            \
+    static_assert(staticRegNameIs(static_regs::id.name, pattern), "static register " #id " is not " pattern); \
+    const staticReg & var = static_regs::id
+
+/*! \brief Declares var as the static single register id, checking that it is generated from name */
+#define REG_SINGLE(var, la, id, name) REG_FAMILY(var, la, id, name)
+
+/*! \brief Returns error_code from the calling function if the static registers do not match the address table */
+#define STATIC_REGS_CHECK(la, error_code) { if (!staticRegsMatch(la)) return error_code; }
+#else
+/*! \brief Declares var as the register family matching pattern, looked up in the address table */
+#define REG_FAMILY(var, la, id, pattern) const regFamily var(la, pattern)
+
+/*! \brief Declares var as the single register name, accessed by name as readReg and writeReg do */
+#define REG_SINGLE(var, la, id, name) const namedReg var{la, name}
+
+#define STATIC_REGS_CHECK(la, error_code)
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+/*!
+ * \file utils/subtree.h
+ * \brief Bulk reads of all the registers below an address table node
+ */
+
+#ifndef UTILS_SUBTREE_H
+#define UTILS_SUBTREE_H
+
+#include "utils.h"
+
+static constexpr size_t SUBTREE_CACHE_SIZE = 64; ///< Number of subtree expansions cached per process
+
+/*! \struct subtreeReg
+ *  \brief Readable leaf register of a subtree
+ */
+struct subtreeReg {
+    std::string   name; /*!< Register name */
+    regDescriptor desc; /*!< Register descriptor */
+};
+
+/*! \fn const std::vector<subtreeReg> & expandSubtree(LocalArgs * la, const std::string & prefix)
+ *  \brief Returns the readable single word leaf registers at or below the node prefix, in key order
+ *  \details The LMDB keys are walked with a cursor from `MDB_SET_RANGE` on the prefix. A node is a leaf if no other node
+ *           is below it. Leaves in block, FIFO, incremental or port mode are left out, reading them is not side effect
+ *           free or does not fit in a word. The expansion is cached per process, until the address table generation
+ *           changes.
+ *  \param la Local arguments structure
+ *  \param prefix Node name, e.g. `GEM_AMC.OH.OH3.FPGA.TRIG`
+ *  \returns the registers, valid until the next call
+ */
+const std::vector<subtreeReg> & expandSubtree(LocalArgs * la, const std::string & prefix);
+
+/*! \fn int readSubtreeLocal(const std::vector<subtreeReg> & regs, uint32_t * result)
+ *  \brief Reads a set of registers in a single memhub transaction, contiguous addresses merged into block reads
+ *  \param regs Registers to read
+ *  \param result Pointer to an array of at least regs.size() words, receiving the values with the register masks applied
+ *  \returns 0 on success, the memhub error code otherwise, in which case result is filled with 0xdeaddead
+ */
+int readSubtreeLocal(const std::vector<subtreeReg> & regs, uint32_t * result);
+
+/*! \fn void readSubtree(const RPCMsg *request, RPCMsg *response)
+ *  \brief Reads all the registers below an address table node
+ *  \param request RPC request message, with the node name in "prefix"
+ *  \param response RPC response message, with the "names" and "data" arrays, in key order
+ */
+void readSubtree(const RPCMsg *request, RPCMsg *response);
+
+#endif
@@ -0,0 +1,60 @@
+/*!
+ * \file utils/wait.h
+ * \brief Server-side polling of registers until a condition is met
+ */
+
+#ifndef UTILS_WAIT_H
+#define UTILS_WAIT_H
+
+#include "utils.h"
+
+/*! \enum waitCondition
+ *  \brief Comparison between the masked register value and the reference value
+ */
+enum waitCondition : uint8_t {
+    WAIT_EQ = 0,
+    WAIT_NE = 1,
+    WAIT_LT = 2,
+    WAIT_LE = 3,
+    WAIT_GT = 4,
+    WAIT_GE = 5,
+};
+
+static constexpr uint32_t WAIT_MAX_INTERVAL_US = 10000; ///< Default upper bound of the interval between two polls
+
+/*! \struct waitResult
+ *  \brief Outcome of waitForRegLocal
+ */
+struct waitResult {
+    bool     met;     /*!< true if the condition was met before the timeout */
+    uint32_t value;   /*!< Last register value read, register mask applied */
+    uint32_t elapsed; /*!< Time spent waiting, in microseconds */
+    uint32_t polls;   /*!< Number of register reads */
+};
+
+/*! \fn bool waitForRegLocal(const regDescriptor & desc, uint32_t mask, waitCondition cond, uint32_t value, uint32_t timeout, waitResult & result, uint32_t maxInterval=WAIT_MAX_INTERVAL_US)
+ *  \brief Polls a register until `(register & mask) cond value`, or until timeout microseconds have elapsed
+ *  \details The register is read right away, then the interval between polls starts at 1 us and doubles after each
+ *           poll, up to maxInterval: short waits are caught quickly and long ones do not load the bus.
+ *  \param desc Register descriptor
+ *  \param mask Mask applied to the register value, after the register mask
+ *  \param cond Comparison
+ *  \param value Reference value
+ *  \param timeout Timeout in microseconds
+ *  \param result Outcome of the wait
+ *  \param maxInterval Maximum interval between two polls, in microseconds
+ *  \returns false if the register could not be read
+ */
+bool waitForRegLocal(const regDescriptor & desc, uint32_t mask, waitCondition cond, uint32_t value, uint32_t timeout,
+                     waitResult & result, uint32_t maxInterval=WAIT_MAX_INTERVAL_US);
+
+/*! \fn void waitForReg(const RPCMsg *request, RPCMsg *response)
+ *  \brief Waits on the card until a register meets a condition
+ *  \param request RPC request message, with "reg_name", "value", "timeout" in microseconds, and optionally "mask"
+ *         (default 0xFFFFFFFF), "condition" (a waitCondition, default WAIT_EQ) and "max_interval" in microseconds
+ *  \param response RPC response message, with "met", the last "value" read, "elapsed" microseconds and "polls".
+ *         "error" is set on timeout.
+ */
+void waitForReg(const RPCMsg *request, RPCMsg *response);
+
+#endif
@@ -10,6 +10,7 @@
 #include "amc/daq.h"
 #include "amc/blaster_ram.h"
 #include "hw_constants.h"
+#include "utils/static_regs.h"
 
 #include <chrono>
 #include <string>
@@ -19,7 +20,7 @@
 
 unsigned int fw_version_check(const char* caller_name, localArgs *la)
 {
-    int iFWVersion = readReg(la, "GEM_AMC.GEM_SYSTEM.RELEASE.MAJOR");
+    int iFWVersion = hwFwMajor(la);
     char regBuf[200];
     switch (iFWVersion) {
         case 1:
@@ -45,20 +46,25 @@ unsigned int fw_version_check(const char* caller_name, localArgs *la)
 
 uint32_t getOHVFATMaskLocal(localArgs * la, uint32_t ohN)
 {
+    STATIC_REGS_CHECK(la, 0xffffff);
+    REG_FAMILY(syncErrCnts, la, vfatSyncErrCnt, "GEM_AMC.OH_LINKS.OH*.VFAT*.SYNC_ERR_CNT");
+    std::vector<regDescriptor> regs;
+    for (unsigned int vfatN=0; vfatN<oh::VFATS_PER_OH; ++vfatN)
+        regs.push_back(syncErrCnts.member(ohN, vfatN));
+    uint32_t syncErrCnt[oh::VFATS_PER_OH];
+    readRegs(la, regs, syncErrCnt);
+
     uint32_t mask = 0x0;
     for (unsigned int vfatN=0; vfatN<oh::VFATS_PER_OH; ++vfatN) { //Loop over all vfats
-        uint32_t syncErrCnt = readReg(la, stdsprintf("GEM_AMC.OH_LINKS.OH%i.VFAT%i.SYNC_ERR_CNT",ohN,vfatN));
-
-        if (syncErrCnt > 0x0) { //Case: nonzero sync errors, mask this vfat
+        if (syncErrCnt[vfatN] > 0x0) { //Case: nonzero sync errors, or unreadable counter (0xdeaddead), mask this vfat
             mask = mask + (0x1 << vfatN);
         } //End Case: nonzero sync errors, mask this vfat
     } //End loop over all vfats
-
     return mask;
 } //End getOHVFATMaskLocal()
 
 void getOHVFATMask(const RPCMsg *request, RPCMsg *response) {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
 
@@ -66,20 +72,18 @@ void getOHVFATMask(const RPCMsg *request, RPCMsg *response) {
     LOGGER->log_message(LogManager::INFO, stdsprintf("Determined VFAT Mask for OH%i to be 0x%x",ohN,vfatMask));
 
     response->set_word("vfatMask",vfatMask);
-
-    rtxn.abort();
 } //End getOHVFATMask(...)
 
 void getOHVFATMaskMultiLink(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     int ohMask = 0xfff;
     if (request->get_key_exists("ohMask")) {
         ohMask = request->get_word("ohMask");
     }
 
-    unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    unsigned int NOH = hwNumOfOH(&la);
     if (request->get_key_exists("NOH")) {
         unsigned int NOH_requested = request->get_word("NOH");
         if (NOH_requested <= NOH)
@@ -108,13 +112,11 @@ void getOHVFATMaskMultiLink(const RPCMsg *request, RPCMsg *response)
     }
 
     response->set_word_array("ohVfatMaskArray",ohVfatMaskArray,amc::OH_PER_AMC);
-
-    rtxn.abort();
 } //End getOHVFATMaskMultiLink(...)
 
 void repeatedRegRead(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     bool breakOnFailure = request->get_word("breakOnFailure");
     uint32_t nReads     = request->get_word("nReads");
@@ -133,8 +135,6 @@ void repeatedRegRead(const RPCMsg *request, RPCMsg *response)
     response->set_word("AXI_STROBE_ERROR_CNT",   vfatErrs.axi_strobe);
     response->set_word("SUM",                    vfatErrs.sum);
     response->set_word("TRANSACTION_CNT",        vfatErrs.nTransactions);
-
-    rtxn.abort();
 } //End repeatedRegRead
 
 std::vector<uint32_t> sbitReadOutLocal(localArgs *la, uint32_t ohN, uint32_t acquireTime, bool *maxNetworkSizeReached)
@@ -145,8 +145,10 @@ std::vector<uint32_t> sbitReadOutLocal(localArgs *la, uint32_t ohN, uint32_t acq
     uint32_t addrSbitMonReset=getAddress(la, "GEM_AMC.TRIGGER.SBIT_MONITOR.RESET");
     uint32_t addrSbitL1ADelay=getAddress(la, "GEM_AMC.TRIGGER.SBIT_MONITOR.L1A_DELAY");
     uint32_t addrSbitCluster[nclusters];
+    STATIC_REGS_CHECK(la, {});
+    REG_FAMILY(sbitClusters, la, sbitMonitorCluster, "GEM_AMC.TRIGGER.SBIT_MONITOR.CLUSTER*");
     for (int iCluster=0; iCluster < nclusters; ++iCluster) {
-        addrSbitCluster[iCluster] = getAddress(la, stdsprintf("GEM_AMC.TRIGGER.SBIT_MONITOR.CLUSTER%i",iCluster) );
+        addrSbitCluster[iCluster] = sbitClusters.address(iCluster);
     }
 
     //Take the VFATs out of slow control only mode
@@ -215,7 +217,7 @@ std::vector<uint32_t> sbitReadOutLocal(localArgs *la, uint32_t ohN, uint32_t acq
 
 void sbitReadOut(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t acquireTime = request->get_word("acquireTime");
@@ -231,8 +233,6 @@ void sbitReadOut(const RPCMsg *request, RPCMsg *response)
         response->set_word("approxLiveTime",approxLivetime);
     }
     response->set_word_array("storedSbits",storedSbits);
-
-    rtxn.abort();
 } //End sbitReadOut()
 
 extern "C" {
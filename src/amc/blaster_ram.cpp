@@ -404,8 +404,7 @@ void writeVFATConfRAMLocal(localArgs *la, uint32_t* vfatblob, size_t const& blob
 ////////////////// RPC callback methods //////////////////
 void readConfRAM(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   BLASTERTypeT type = static_cast<BLASTERTypeT>(request->get_word("type"));
   LOGGER->log_message(LogManager::DEBUG, stdsprintf("BLASTERTypeT is 0x%x", type));
@@ -427,8 +426,7 @@ void readConfRAM(const RPCMsg *request, RPCMsg *response)
 
 void writeConfRAM(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   BLASTERTypeT type = static_cast<BLASTERTypeT>(request->get_word("type"));
   LOGGER->log_message(LogManager::DEBUG, stdsprintf("BLASTERTypeT is 0x%x", type));
@@ -448,8 +446,7 @@ void writeConfRAM(const RPCMsg *request, RPCMsg *response)
 
 void writeGBTConfRAM(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t* gbtblob = nullptr;
   uint32_t blob_sz = request->get_binarydata_size("gbtblob");
@@ -465,8 +462,7 @@ void writeGBTConfRAM(const RPCMsg *request, RPCMsg *response)
 
 void writeOptoHybridConfRAM(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t* ohblob = nullptr;
   uint32_t blob_sz = request->get_binarydata_size("ohblob");
@@ -482,8 +478,7 @@ void writeOptoHybridConfRAM(const RPCMsg *request, RPCMsg *response)
 
 void writeVFATConfRAM(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t* vfatblob = nullptr;
   uint32_t blob_sz = request->get_binarydata_size("vfatblob");
@@ -223,318 +223,247 @@ void setDAQLinkRunParametersLocal(localArgs* la, uint32_t const& rparams)
 /** RPC callbacks */
 void enableDAQLink(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t enableMask = request->get_word("enableMask");
   enableDAQLinkLocal(&la, enableMask);
-  rtxn.abort();
 }
 
 void disableDAQLink(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   disableDAQLinkLocal(&la);
-  rtxn.abort();
 }
 
 void setZS(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool enable = request->get_word("enable");
   setZSLocal(&la,enable);
-  rtxn.abort();
 }
 
 void disableZS(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   disableZSLocal(&la);
-  rtxn.abort();
 }
 
 void resetDAQLink(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   // what if these are not provided, want to use the function defaults, or should these be defined upstream?
   uint32_t davTO       = request->get_word("davTO");
   uint32_t ttsOverride = request->get_word("ttsOverride");
   resetDAQLinkLocal(&la, davTO, ttsOverride);
-  rtxn.abort();
 }
 
 void getDAQLinkControl(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkControlLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void getDAQLinkStatus(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkStatusLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void daqLinkReady(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool res = daqLinkReadyLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void daqClockLocked(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool res = daqClockLockedLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void daqTTCReady(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool res = daqTTCReadyLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void daqTTSState(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = daqTTSStateLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void daqAlmostFull(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = daqAlmostFullLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void l1aFIFOIsEmpty(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool res = l1aFIFOIsEmptyLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void l1aFIFOIsAlmostFull(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool res = l1aFIFOIsAlmostFullLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void l1aFIFOIsFull(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool res = l1aFIFOIsFullLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void l1aFIFOIsUnderflow(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool res = l1aFIFOIsUnderflowLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void getDAQLinkEventsSent(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkEventsSentLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void getDAQLinkL1AID(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkL1AIDLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void getDAQLinkL1ARate(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkL1ARateLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void getDAQLinkDisperErrors(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkDisperErrorsLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void getDAQLinkNonidentifiableErrors(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkNonidentifiableErrorsLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void getDAQLinkInputMask(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkInputMaskLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 
 void getDAQLinkDAVTimeout(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkDAVTimeoutLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getDAQLinkDAVTimer(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool max = request->get_word("max");
   uint32_t res = getDAQLinkDAVTimerLocal(&la, max);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getLinkDAQStatus(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint8_t gtx = request->get_word("gtx");
   uint32_t res = getLinkDAQStatusLocal(&la, gtx);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getLinkDAQCounters(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint8_t gtx  = request->get_word("gtx");
   uint8_t mode = request->get_word("mode");
   uint32_t res = getLinkDAQCountersLocal(&la, gtx, mode);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getLinkLastDAQBlock(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint8_t gtx  = request->get_word("gtx");
   uint32_t res = getLinkLastDAQBlockLocal(&la, gtx);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getDAQLinkInputTimeout(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkInputTimeoutLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getDAQLinkRunType(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkRunTypeLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getDAQLinkRunParameters(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getDAQLinkRunParametersLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getDAQLinkRunParameter(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint8_t parameter  = request->get_word("parameter");
   uint32_t res = getDAQLinkRunParameterLocal(&la, parameter);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void setDAQLinkInputTimeout(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t inputTO = request->get_word("inputTO");
   setDAQLinkInputTimeoutLocal(&la, inputTO);
-  rtxn.abort();
 }
 void setDAQLinkRunType(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t runType = request->get_word("runType");
   setDAQLinkRunTypeLocal(&la, runType);
-  rtxn.abort();
 }
 void setDAQLinkRunParameter(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint8_t parN   = request->get_word("parameterN");
   uint8_t runPar = request->get_word("runParameter");
   setDAQLinkRunParameterLocal(&la, parN, runPar);
-  rtxn.abort();
 }
 void setDAQLinkRunParameters(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t runPars    = request->get_word("runParameters");
   setDAQLinkRunParametersLocal(&la, runPars);
-  rtxn.abort();
 }
 /** Composite RPC methods */
 void configureDAQModule(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   bool enableZS     = request->get_word("enableZS");
   bool doPhaseShift = request->get_word("doPhaseShift");
@@ -559,14 +488,11 @@ void configureDAQModule(const RPCMsg *request, RPCMsg *response)
   setZSLocal(&la, enableZS);
   setDAQLinkRunTypeLocal(&la, 0x0);
   setDAQLinkRunParametersLocal(&la, 0xfaac);
-
-  rtxn.abort();
 }
 
 void enableDAQModule(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   bool enableZS     = request->get_word("enableZS");
 
@@ -577,6 +503,4 @@ void enableDAQModule(const RPCMsg *request, RPCMsg *response)
   resetDAQLinkLocal(&la);
   setZSLocal(&la, enableZS);
   setL1AEnableLocal(&la, true);
-
-  rtxn.abort();
 }
@@ -192,47 +192,35 @@ void scaHardResetEnableLocal(localArgs* la, bool en)
 /** RPC callbacks */
 void scaModuleReset(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t ohMask = request->get_word("ohMask");
 
   scaModuleResetLocal(&la, ohMask);
-
-  rtxn.abort();
 }
 
 void readSCAChipID(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t ohMask = request->get_word("ohMask");
   bool     scaV1  = request->get_word("scaV1");
   std::vector<uint32_t> scaChipIDs = readSCAChipIDLocal(&la, ohMask, scaV1);
-
-  rtxn.abort();
 }
 
 void readSCASEUCounter(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t ohMask = request->get_word("ohMask");
   bool     reset  = request->get_word("reset");
   std::vector<uint32_t> seuCounts = readSCASEUCounterLocal(&la, ohMask, reset);
-
-  rtxn.abort();
 }
 
 void resetSCASEUCounter(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t ohMask = request->get_word("ohMask");
   resetSCASEUCounterLocal(&la, ohMask);
-
-  rtxn.abort();
 }
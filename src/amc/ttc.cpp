@@ -5,6 +5,7 @@
 
 #include "amc/ttc.h"
 
+#include <array>
 #include <ios>
 #include <chrono>
 #include <thread>
@@ -44,12 +45,43 @@ void ttcMMCMPhaseShiftLocal(localArgs* la,
   vec_ttcCtrlRegs.push_back(std::make_pair("PA_GTH_MANUAL_SEL_OVERRIDE"    , 0x1));
   vec_ttcCtrlRegs.push_back(std::make_pair("PA_GTH_MANUAL_COMBINED"        , 0x1));
   vec_ttcCtrlRegs.push_back(std::make_pair("GTH_TXDLYBYPASS"               , 0x1));
-  vec_ttcCtrlRegs.push_back(std::make_pair("PA_MANUAL_PLL_RESET"           , 0x1));
-  vec_ttcCtrlRegs.push_back(std::make_pair("CNT_RESET"                     , 0x1));
 
-  // write & readback of aforementioned registers
-  uint32_t readback;
+  // strobes, issued one by one once the configuration above is in place
+  std::vector<std::pair<std::string, uint32_t> > vec_ttcCtrlStrobes;
+  vec_ttcCtrlStrobes.push_back(std::make_pair("PA_MANUAL_PLL_RESET"        , 0x1));
+  vec_ttcCtrlStrobes.push_back(std::make_pair("CNT_RESET"                  , 0x1));
+
+  // write & readback of the configuration registers
+  // the fields share a few words of the CTRL module, so the writes are coalesced per word
+  std::vector<std::string> ttcCtrlRegNames;
+  writeBatch ttcCtrlBatch(la);
   for (auto ttcRegIter = vec_ttcCtrlRegs.begin(); ttcRegIter != vec_ttcCtrlRegs.end(); ++ttcRegIter) {
+    ttcCtrlRegNames.push_back(strTTCCtrlBaseNode + (*ttcRegIter).first);
+    ttcCtrlBatch.writeReg(ttcCtrlRegNames.back(), (*ttcRegIter).second);
+  }
+  ttcCtrlBatch.commit();
+  std::this_thread::sleep_for(std::chrono::microseconds(250));
+
+  std::vector<uint32_t> readbacks(ttcCtrlRegNames.size());
+  readRegs(la, ttcCtrlRegNames, readbacks.data());
+  for (size_t i = 0; i < vec_ttcCtrlRegs.size(); ++i) {
+    auto ttcRegIter = vec_ttcCtrlRegs.begin() + i;
+    uint32_t readback = readbacks[i];
+    if (readback != (*ttcRegIter).second) {
+      std::stringstream errmsg;
+      errmsg << "Readback of " << strTTCCtrlBaseNode + (ttcRegIter->first).c_str()
+             << " failed, value is " << readback
+             << ", expected " << ttcRegIter->second;
+
+      LOGGER->log_message(LogManager::ERROR, "ttcMMCMPhaseShiftLocal: " + errmsg.str());
+      la->response->set_string("error", errmsg.str());
+      return;
+    }
+  }
+
+  // write & readback of the strobes, in order, each one given time to settle
+  uint32_t readback;
+  for (auto ttcRegIter = vec_ttcCtrlStrobes.begin(); ttcRegIter != vec_ttcCtrlStrobes.end(); ++ttcRegIter) {
     writeReg(la, strTTCCtrlBaseNode + (*ttcRegIter).first, (*ttcRegIter).second);
     std::this_thread::sleep_for(std::chrono::microseconds(250));
     readback = readReg(la, strTTCCtrlBaseNode + (*ttcRegIter).first);
@@ -735,36 +767,28 @@ uint32_t getTTCSpyBufferLocal(localArgs* la)
 /** RPC callbacks */
 void ttcModuleReset(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   ttcModuleResetLocal(&la);
-  rtxn.abort();
 }
 void ttcMMCMReset(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   // LocalArgs la = getLocalArgs(response);
   ttcMMCMResetLocal(&la);
-  rtxn.abort();
 }
 void ttcMMCMPhaseShift(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   bool relock  = request->get_word("relock");
   bool modeBC0 = request->get_word("modeBC0");
   bool scan    = request->get_word("scan");
 
   ttcMMCMPhaseShiftLocal(&la, relock, modeBC0, scan);
-
-  rtxn.abort();
 }
 void checkPLLLock(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t readAttempts = request->get_word("readAttempts");
   uint32_t lockCnt      = checkPLLLockLocal(&la, readAttempts);
@@ -774,133 +798,101 @@ void checkPLLLock(const RPCMsg *request, RPCMsg *response)
   LOGGER->log_message(LogManager::INFO, msg.str());
 
   response->set_word("lockCnt",lockCnt);
-
-  rtxn.abort();
 }
 void getMMCMPhaseMean(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t reads = request->get_word("reads");
   double res = getMMCMPhaseMeanLocal(&la, reads);
   response->set_word("phase", res);
-  rtxn.abort();
 }
 void getMMCMPhaseMedian(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t reads = request->get_word("reads");
   double res = getMMCMPhaseMedianLocal(&la, reads);
   response->set_word("phase", res);
-  rtxn.abort();
 }
 void getGTHPhaseMean(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t reads = request->get_word("reads");
   double res = getGTHPhaseMeanLocal(&la, reads);
   response->set_word("phase", res);
-  rtxn.abort();
 }
 void getGTHPhaseMedian(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t reads = request->get_word("reads");
   double res = getGTHPhaseMedianLocal(&la, reads);
   response->set_word("phase", res);
-  rtxn.abort();
 }
 void ttcCounterReset(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   ttcCounterResetLocal(&la);
-  rtxn.abort();
 }void getL1AEnable(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getL1AEnableLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void setL1AEnable(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool en = request->get_word("enable");
   setL1AEnableLocal(&la, en);
-  rtxn.abort();
 }
 void getTTCConfig(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint8_t cmd = request->get_word("cmd");
   uint32_t res = getTTCConfigLocal(&la, cmd);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void setTTCConfig(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint8_t cmd = request->get_word("cmd");
   uint8_t val = request->get_word("value");
   setTTCConfigLocal(&la, cmd, val);
-  rtxn.abort();
 }
 void getTTCStatus(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t status = getTTCStatusLocal(&la);
   // uint32_t status = 0xdeadbeef;
   response->set_word("result", status);
-  rtxn.abort();
 }
 void getTTCErrorCount(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   bool single = request->get_word("single");
   uint32_t res = getTTCErrorCountLocal(&la, single);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getTTCCounter(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint8_t cmd = request->get_word("cmd");
   uint32_t res = getTTCCounterLocal(&la, cmd);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getL1AID(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getL1AIDLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getL1ARate(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getL1ARateLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
 void getTTCSpyBuffer(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   uint32_t res = getTTCSpyBufferLocal(&la);
   response->set_word("result", res);
-  rtxn.abort();
 }
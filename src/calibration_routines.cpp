@@ -8,10 +8,12 @@
 #include <thread>
 #include "vfat3.h"
 #include "hw_constants.h"
+#include "utils/static_regs.h"
 
 std::unordered_map<uint32_t, uint32_t> setSingleChanMask(unsigned int ohN, unsigned int vfatN, unsigned int ch, localArgs *la)
 {
-    char regBuf[200];
+    STATIC_REGS_CHECK(la, {});
+    REG_FAMILY(chanMasks, la, vfatChannelMask, "GEM_AMC.OH.OH*.GEB.VFAT*.VFAT_CHANNELS.CHANNEL*.MASK");
     std::unordered_map<uint32_t, uint32_t> map_chanOrigMask; //key -> reg addr; val -> reg value
     uint32_t chanMaskAddr;
     for (unsigned int chan=0; chan<128; ++chan) { //Loop Over All Channels
@@ -20,9 +22,8 @@ std::unordered_map<uint32_t, uint32_t> setSingleChanMask(unsigned int ohN, unsig
             chMask = 0;
         }
         //store the original channel mask
-        sprintf(regBuf, "GEM_AMC.OH.OH%i.GEB.VFAT%i.VFAT_CHANNELS.CHANNEL%i.MASK",ohN,vfatN,chan);
-        chanMaskAddr=getAddress(la, regBuf);
-        map_chanOrigMask[chanMaskAddr]=readReg(la, regBuf);
+        chanMaskAddr=chanMasks.address(ohN, vfatN, chan);
+        map_chanOrigMask[chanMaskAddr]=chanMasks.read(ohN, vfatN, chan);
 
         //write the new channel mask
         writeRawAddress(chanMaskAddr, chMask, la->response);
@@ -42,7 +43,8 @@ bool confCalPulseLocal(localArgs *la, uint32_t ohN, uint32_t mask, uint32_t ch,
     //Determine the inverse of the vfatmask
     uint32_t notmask = ~mask & 0xFFFFFF;
 
-    char regBuf[200];
+    STATIC_REGS_CHECK(la, false);
+    REG_FAMILY(chanCalPulse, la, vfatChannelCalPulse, "GEM_AMC.OH.OH*.GEB.VFAT*.VFAT_CHANNELS.CHANNEL*.CALPULSE_ENABLE");
     if (ch >= 128 && toggleOn == true) { //Case: Bad Config, asked for OR of all channels
         la->response->set_string("error","confCalPulseLocal(): I was told to calpulse all channels which doesn't make sense");
         return false;
@@ -51,8 +53,7 @@ bool confCalPulseLocal(localArgs *la, uint32_t ohN, uint32_t mask, uint32_t ch,
         for (unsigned int vfatN = 0; vfatN < oh::VFATS_PER_OH; vfatN++) { //Loop over all VFATs
             if ((notmask >> vfatN) & 0x1) { //End VFAT is not masked
                 for (unsigned int chan=0; chan < 128; ++chan) { //Loop Over all Channels
-                    sprintf(regBuf,"GEM_AMC.OH.OH%i.GEB.VFAT%i.VFAT_CHANNELS.CHANNEL%i.CALPULSE_ENABLE", ohN, vfatN, chan);
-                    writeReg(la, regBuf, 0x0);
+                    chanCalPulse.write(0x0, ohN, vfatN, chan);
                 } //End Loop Over all Channels
                 writeReg(la, stdsprintf("GEM_AMC.OH.OH%i.GEB.VFAT%i.CFG_CAL_MODE", ohN, vfatN), 0x0);
             } //End VFAT is not masked
@@ -61,9 +62,8 @@ bool confCalPulseLocal(localArgs *la, uint32_t ohN, uint32_t mask, uint32_t ch,
     else{ //Case: Pulse a specific channel
         for (unsigned int vfatN = 0; vfatN < oh::VFATS_PER_OH; vfatN++) { //Loop over all VFATs
             if ((notmask >> vfatN) & 0x1) { //End VFAT is not masked
-                sprintf(regBuf,"GEM_AMC.OH.OH%i.GEB.VFAT%i.VFAT_CHANNELS.CHANNEL%i.CALPULSE_ENABLE", ohN, vfatN, ch);
                 if (toggleOn == true) { //Case: turn calpulse on
-                    writeReg(la, regBuf, 0x1);
+                    chanCalPulse.write(0x1, ohN, vfatN, ch);
                     if (currentPulse) { //Case: cal mode current injection
                         writeReg(la, stdsprintf("GEM_AMC.OH.OH%i.GEB.VFAT%i.CFG_CAL_MODE", ohN, vfatN), 0x2);
 
@@ -76,7 +76,7 @@ bool confCalPulseLocal(localArgs *la, uint32_t ohN, uint32_t mask, uint32_t ch,
                     } //Case: cal mode voltage injection
                 } //End Case: Turn calpulse on
                 else{ //Case: Turn calpulse off
-                    writeReg(la, regBuf, 0x0);
+                    chanCalPulse.write(0x0, ohN, vfatN, ch);
                     writeReg(la, stdsprintf("GEM_AMC.OH.OH%i.GEB.VFAT%i.CFG_CAL_MODE", ohN, vfatN), 0x0);
                 } //End Case: Turn calpulse off
             } //End VFAT is not masked
@@ -162,13 +162,12 @@ void ttcGenToggleLocal(localArgs * la, uint32_t ohN, bool enable)
 
 void ttcGenToggle(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     bool enable = request->get_word("enable");
 
     ttcGenToggleLocal(&la, ohN, enable);
-    rtxn.abort();
 } //End ttcGenToggle(...)
 
 void ttcGenConfLocal(localArgs * la, uint32_t ohN, uint32_t mode, uint32_t type, uint32_t pulseDelay, uint32_t L1Ainterval, uint32_t nPulses, bool enable)
@@ -250,7 +249,7 @@ void ttcGenConfLocal(localArgs * la, uint32_t ohN, uint32_t mode, uint32_t type,
 void ttcGenConf(const RPCMsg *request, RPCMsg *response)
 {
     LOGGER->log_message(LogManager::INFO, "Entering ttcGenConf");
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t mode = request->get_word("mode");
@@ -262,8 +261,6 @@ void ttcGenConf(const RPCMsg *request, RPCMsg *response)
 
     LOGGER->log_message(LogManager::INFO, stdsprintf("Calling ttcGenConfLocal with ohN : %i, mode : %i, type : %i, pulse delay : %i, L1A interval : %i, number of pulses : %i", ohN,mode,type,pulseDelay,L1Ainterval,nPulses));
     ttcGenConfLocal(&la, ohN, mode, type, pulseDelay, L1Ainterval, nPulses, enable);
-
-    rtxn.abort();
 }
 
 void genScanLocal(localArgs *la, uint32_t *outData, uint32_t ohN, uint32_t mask, uint32_t ch, bool useCalPulse, bool currentPulse, uint32_t calScaleFactor, uint32_t nevts, uint32_t dacMin, uint32_t dacMax, uint32_t dacStep, std::string scanReg, bool useUltra, bool useExtTrig)
@@ -479,7 +476,7 @@ void genScanLocal(localArgs *la, uint32_t *outData, uint32_t ohN, uint32_t mask,
 
 void genScan(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t nevts = request->get_word("nevts");
     uint32_t ohN = request->get_word("ohN");
@@ -502,8 +499,6 @@ void genScan(const RPCMsg *request, RPCMsg *response)
     uint32_t outData[oh::VFATS_PER_OH*(dacMax-dacMin+1)/dacStep];
     genScanLocal(&la, outData, ohN, mask, ch, useCalPulse, currentPulse, calScaleFactor, nevts, dacMin, dacMax, dacStep, scanReg, useUltra, useExtTrig);
     response->set_word_array("data",outData,oh::VFATS_PER_OH*(dacMax-dacMin+1)/dacStep);
-
-    rtxn.abort();
 }
 
 void sbitRateScanLocal(localArgs *la, uint32_t *outDataDacVal, uint32_t *outDataTrigRate, uint32_t ohN, uint32_t maskOh, bool invertVFATPos, uint32_t ch, uint32_t dacMin, uint32_t dacMax, uint32_t dacStep, std::string scanReg, uint32_t waitTime)
@@ -743,7 +738,7 @@ return;
 
 void sbitRateScan(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohMask = request->get_word("ohMask");
     uint32_t ch = request->get_word("ch");
@@ -817,9 +812,10 @@ void checkSbitMappingWithCalPulseLocal(localArgs *la, uint32_t *outData, uint32_
     writeReg(la, "GEM_AMC.TRIGGER.SBIT_MONITOR.OH_SELECT", ohN);
     uint32_t addrSbitMonReset=getAddress(la, "GEM_AMC.TRIGGER.SBIT_MONITOR.RESET");
     uint32_t addrSbitCluster[nclusters];
+    STATIC_REGS_CHECK(la, );
+    REG_FAMILY(sbitClusters, la, sbitMonitorCluster, "GEM_AMC.TRIGGER.SBIT_MONITOR.CLUSTER*");
     for (unsigned int iCluster=0; iCluster < nclusters; ++iCluster) {
-        sprintf(regBuf, "GEM_AMC.TRIGGER.SBIT_MONITOR.CLUSTER%i",iCluster);
-        addrSbitCluster[iCluster] = getAddress(la, regBuf);
+        addrSbitCluster[iCluster] = sbitClusters.address(iCluster);
     }
 
     if (!((notmask >> vfatN) & 0x1)) {
@@ -911,7 +907,7 @@ void checkSbitMappingWithCalPulseLocal(localArgs *la, uint32_t *outData, uint32_
 
 void checkSbitMappingWithCalPulse(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t vfatN = request->get_word("vfatN");
@@ -927,8 +923,6 @@ void checkSbitMappingWithCalPulse(const RPCMsg *request, RPCMsg *response)
     checkSbitMappingWithCalPulseLocal(&la, outData, ohN, vfatN, mask, useCalPulse, currentPulse, calScaleFactor, nevts, L1Ainterval, pulseDelay);
 
     response->set_word_array("data",outData,128*8*nevts);
-
-    rtxn.abort();
 } //End checkSbitMappingWithCalPulse()
 
 void checkSbitRateWithCalPulseLocal(localArgs *la, uint32_t *outDataCTP7Rate, uint32_t *outDataFPGAClusterCntRate, uint32_t *outDataVFATSBits, uint32_t ohN, uint32_t vfatN, uint32_t mask, bool useCalPulse, bool currentPulse, uint32_t calScaleFactor, uint32_t waitTime, uint32_t pulseRate, uint32_t pulseDelay)
@@ -1089,7 +1083,7 @@ void checkSbitRateWithCalPulseLocal(localArgs *la, uint32_t *outDataCTP7Rate, ui
 
 void checkSbitRateWithCalPulse(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t vfatN = request->get_word("vfatN");
@@ -1109,8 +1103,6 @@ void checkSbitRateWithCalPulse(const RPCMsg *request, RPCMsg *response)
     response->set_word_array("outDataCTP7Rate",outDataCTP7Rate,128);
     response->set_word_array("outDataFPGAClusterCntRate",outDataFPGAClusterCntRate,128);
     response->set_word_array("outDataVFATSBits",outDataVFATSBits,128);
-
-    rtxn.abort();
 } //End checkSbitRateWithCalPulse()
 
 std::vector<uint32_t> dacScanLocal(localArgs *la, uint32_t ohN, uint32_t dacSelect, uint32_t dacStep, uint32_t mask, bool useExtRefADC)
@@ -1247,7 +1239,7 @@ std::vector<uint32_t> dacScanLocal(localArgs *la, uint32_t ohN, uint32_t dacSele
 
 void dacScan(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t dacSelect = request->get_word("dacSelect");
@@ -1257,20 +1249,18 @@ void dacScan(const RPCMsg *request, RPCMsg *response)
 
     std::vector<uint32_t> dacScanResults = dacScanLocal(&la, ohN, dacSelect, dacStep, mask, useExtRefADC);
     response->set_word_array("dacScanResults",dacScanResults);
-
-    rtxn.abort();
 } //End dacScan(...)
 
 void dacScanMultiLink(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohMask = request->get_word("ohMask");
     uint32_t dacSelect = request->get_word("dacSelect");
     uint32_t dacStep = request->get_word("dacStep");
     bool useExtRefADC = request->get_word("useExtRefADC");
 
-    unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    unsigned int NOH = hwNumOfOH(&la);
     if (request->get_key_exists("NOH")) {
         unsigned int NOH_requested = request->get_word("NOH");
         if (NOH_requested <= NOH)
@@ -1309,13 +1299,11 @@ void dacScanMultiLink(const RPCMsg *request, RPCMsg *response)
 
     response->set_word_array("dacScanResultsAll",dacScanResultsAll);
     LOGGER->log_message(LogManager::INFO, stdsprintf("Finished DAC scans for OH Mask 0x%x", ohMask));
-
-    rtxn.abort();
 } //End dacScanMultiLink(...)
 
 void genChannelScan(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t nevts = request->get_word("nevts");
     uint32_t ohN = request->get_word("ohN");
@@ -1339,8 +1327,6 @@ void genChannelScan(const RPCMsg *request, RPCMsg *response)
         genScanLocal(&la, &(outData[ch*oh::VFATS_PER_OH*(dacMax-dacMin+1)/dacStep]), ohN, mask, ch, useCalPulse, currentPulse, calScaleFactor, nevts, dacMin, dacMax, dacStep, scanReg, useUltra, useExtTrig);
     }
     response->set_word_array("data",outData,oh::VFATS_PER_OH*128*(dacMax-dacMin+1)/dacStep);
-
-    rtxn.abort();
 }
 
 extern "C" {
@@ -9,48 +9,66 @@
 #include <thread>
 #include "daq_monitor.h"
 #include "hw_constants.h"
+#include "utils/static_regs.h"
 #include <string>
 #include "utils.h"
 
+/*! \brief Reads all the registers in one readRegs batch and sets each value in the RPC response under the matching key
+ */
+static void setWordsFromRegs(localArgs * la, const std::vector<std::string> & keys, const std::vector<std::string> & regNames)
+{
+  std::vector<uint32_t> values(regNames.size());
+  uint32_t nTransactions = readRegs(la, regNames, values.data());
+  LOGGER->log_message(LogManager::DEBUG, stdsprintf("Read %d registers in %d memhub transactions", static_cast<int>(regNames.size()), nTransactions));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    la->response->set_word(keys[i], values[i]);
+  }
+}
+
 void getmonTTCmainLocal(localArgs * la)
 {
   LOGGER->log_message(LogManager::INFO, "Called getmonTTCmainLocal");
-  la->response->set_word("MMCM_LOCKED",readReg(la,"GEM_AMC.TTC.STATUS.CLK.MMCM_LOCKED"));
-  la->response->set_word("TTC_SINGLE_ERROR_CNT",readReg(la,"GEM_AMC.TTC.STATUS.TTC_SINGLE_ERROR_CNT"));
-  la->response->set_word("BC0_LOCKED",readReg(la,"GEM_AMC.TTC.STATUS.BC0.LOCKED"));
-  la->response->set_word("L1A_ID",readReg(la,"GEM_AMC.TTC.L1A_ID"));
-  la->response->set_word("L1A_RATE",readReg(la,"GEM_AMC.TTC.L1A_RATE"));
+  setWordsFromRegs(la,
+                   {"MMCM_LOCKED",
+                    "TTC_SINGLE_ERROR_CNT",
+                    "BC0_LOCKED",
+                    "L1A_ID",
+                    "L1A_RATE"},
+                   {"GEM_AMC.TTC.STATUS.CLK.MMCM_LOCKED",
+                    "GEM_AMC.TTC.STATUS.TTC_SINGLE_ERROR_CNT",
+                    "GEM_AMC.TTC.STATUS.BC0.LOCKED",
+                    "GEM_AMC.TTC.L1A_ID",
+                    "GEM_AMC.TTC.L1A_RATE"});
 }
 
 void getmonTTCmain(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   getmonTTCmainLocal(&la);
-  rtxn.abort();
 }
 
 void getmonTRIGGERmainLocal(localArgs * la, int NOH, int ohMask)
 {
-  std::string t1,t2;
-  la->response->set_word("OR_TRIGGER_RATE",readReg(la,"GEM_AMC.TRIGGER.STATUS.OR_TRIGGER_RATE"));
-  int NOH_local = readReg(la,"GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  std::vector<std::string> keys  = {"OR_TRIGGER_RATE"};
+  std::vector<std::string> regs  = {"GEM_AMC.TRIGGER.STATUS.OR_TRIGGER_RATE"};
+  int NOH_local = hwNumOfOH(la);
   if (NOH_local < NOH) NOH = NOH_local;
   for (int ohN = 0; ohN < NOH; ohN++){
     // If this Optohybrid is masked skip it
     if(!((ohMask >> ohN) & 0x1)){
       continue;
     }
-    t1 = stdsprintf("OH%s.TRIGGER_RATE",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.TRIGGER_RATE",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
+    keys.push_back(stdsprintf("OH%s.TRIGGER_RATE",std::to_string(ohN).c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.TRIGGER.OH%s.TRIGGER_RATE",std::to_string(ohN).c_str()));
   }
+  setWordsFromRegs(la, keys, regs);
 }
 
 void getmonTRIGGERmain(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
   int ohMask = 0xfff;
   if (request->get_key_exists("ohMask")) {
     ohMask = request->get_word("ohMask");
@@ -66,13 +84,13 @@ void getmonTRIGGERmain(const RPCMsg *request, RPCMsg *response)
   }
 
   getmonTRIGGERmainLocal(&la, NOH, ohMask);
-  rtxn.abort();
 }
 
 void getmonTRIGGEROHmainLocal(localArgs * la, int NOH, int ohMask)
 {
-  std::string t1,t2;
-  int NOH_local = readReg(la,"GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  std::string t1;
+  std::vector<std::string> keys, regs;
+  int NOH_local = hwNumOfOH(la);
   if (NOH_local < NOH) NOH = NOH_local;
   for (int ohN = 0; ohN < NOH; ohN++){
     // If this Optohybrid is masked skip it
@@ -95,38 +113,22 @@ void getmonTRIGGEROHmainLocal(localArgs * la, int NOH, int ohMask)
       la->response->set_word(t1,0xdeaddead);
       continue;
     }
-    t1 = stdsprintf("OH%s.LINK0_MISSED_COMMA_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.LINK0_MISSED_COMMA_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.LINK1_MISSED_COMMA_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.LINK1_MISSED_COMMA_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.LINK0_OVERFLOW_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.LINK0_OVERFLOW_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.LINK1_OVERFLOW_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.LINK1_OVERFLOW_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.LINK0_UNDERFLOW_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.LINK0_UNDERFLOW_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.LINK1_UNDERFLOW_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.LINK1_UNDERFLOW_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.LINK0_SBIT_OVERFLOW_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.LINK0_SBIT_OVERFLOW_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.LINK1_SBIT_OVERFLOW_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.TRIGGER.OH%s.LINK1_SBIT_OVERFLOW_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
+    for (auto const& cnt : {"LINK0_MISSED_COMMA_CNT", "LINK1_MISSED_COMMA_CNT",
+                            "LINK0_OVERFLOW_CNT",     "LINK1_OVERFLOW_CNT",
+                            "LINK0_UNDERFLOW_CNT",    "LINK1_UNDERFLOW_CNT",
+                            "LINK0_SBIT_OVERFLOW_CNT","LINK1_SBIT_OVERFLOW_CNT"}) {
+      keys.push_back(stdsprintf("OH%s.%s",std::to_string(ohN).c_str(),cnt));
+      regs.push_back(stdsprintf("GEM_AMC.TRIGGER.OH%s.%s",std::to_string(ohN).c_str(),cnt));
+    }
   }
+  setWordsFromRegs(la, keys, regs);
 }
 
 void getmonTRIGGEROHmain(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
   int ohMask = 0xfff;
   if (request->get_key_exists("ohMask")) {
     ohMask = request->get_word("ohMask");
@@ -142,35 +144,46 @@ void getmonTRIGGEROHmain(const RPCMsg *request, RPCMsg *response)
   }
 
   getmonTRIGGEROHmainLocal(&la, NOH, ohMask);
-  rtxn.abort();
 }
 
 void getmonDAQmainLocal(localArgs * la)
 {
-  la->response->set_word("DAQ_ENABLE",readReg(la,"GEM_AMC.DAQ.CONTROL.DAQ_ENABLE"));
-  la->response->set_word("DAQ_LINK_READY",readReg(la,"GEM_AMC.DAQ.STATUS.DAQ_LINK_RDY"));
-  la->response->set_word("DAQ_LINK_AFULL",readReg(la,"GEM_AMC.DAQ.STATUS.DAQ_LINK_AFULL"));
-  la->response->set_word("DAQ_OFIFO_HAD_OFLOW",readReg(la,"GEM_AMC.DAQ.STATUS.DAQ_OUTPUT_FIFO_HAD_OVERFLOW"));
-  la->response->set_word("L1A_FIFO_HAD_OFLOW",readReg(la,"GEM_AMC.DAQ.STATUS.L1A_FIFO_HAD_OVERFLOW"));
-  la->response->set_word("L1A_FIFO_DATA_COUNT",readReg(la,"GEM_AMC.DAQ.EXT_STATUS.L1A_FIFO_DATA_CNT"));
-  la->response->set_word("DAQ_FIFO_DATA_COUNT",readReg(la,"GEM_AMC.DAQ.EXT_STATUS.DAQ_FIFO_DATA_CNT"));
-  la->response->set_word("EVENT_SENT",readReg(la,"GEM_AMC.DAQ.EXT_STATUS.EVT_SENT"));
-  la->response->set_word("TTS_STATE",readReg(la,"GEM_AMC.DAQ.STATUS.TTS_STATE"));
-  la->response->set_word("INPUT_ENABLE_MASK",readReg(la,"GEM_AMC.DAQ.CONTROL.INPUT_ENABLE_MASK"));
-  la->response->set_word("INPUT_AUTOKILL_MASK",readReg(la,"GEM_AMC.DAQ.STATUS.INPUT_AUTOKILL_MASK"));
+  setWordsFromRegs(la,
+                   {"DAQ_ENABLE",
+                    "DAQ_LINK_READY",
+                    "DAQ_LINK_AFULL",
+                    "DAQ_OFIFO_HAD_OFLOW",
+                    "L1A_FIFO_HAD_OFLOW",
+                    "L1A_FIFO_DATA_COUNT",
+                    "DAQ_FIFO_DATA_COUNT",
+                    "EVENT_SENT",
+                    "TTS_STATE",
+                    "INPUT_ENABLE_MASK",
+                    "INPUT_AUTOKILL_MASK"},
+                   {"GEM_AMC.DAQ.CONTROL.DAQ_ENABLE",
+                    "GEM_AMC.DAQ.STATUS.DAQ_LINK_RDY",
+                    "GEM_AMC.DAQ.STATUS.DAQ_LINK_AFULL",
+                    "GEM_AMC.DAQ.STATUS.DAQ_OUTPUT_FIFO_HAD_OVERFLOW",
+                    "GEM_AMC.DAQ.STATUS.L1A_FIFO_HAD_OVERFLOW",
+                    "GEM_AMC.DAQ.EXT_STATUS.L1A_FIFO_DATA_CNT",
+                    "GEM_AMC.DAQ.EXT_STATUS.DAQ_FIFO_DATA_CNT",
+                    "GEM_AMC.DAQ.EXT_STATUS.EVT_SENT",
+                    "GEM_AMC.DAQ.STATUS.TTS_STATE",
+                    "GEM_AMC.DAQ.CONTROL.INPUT_ENABLE_MASK",
+                    "GEM_AMC.DAQ.STATUS.INPUT_AUTOKILL_MASK"});
 }
 
 void getmonDAQmain(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
   getmonDAQmainLocal(&la);
-  rtxn.abort();
 }
 
 void getmonDAQOHmainLocal(localArgs * la, int NOH, int ohMask)
 {
-  std::string t1,t2;
-  int NOH_local = readReg(la,"GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  std::string t1;
+  std::vector<std::string> keys, regs;
+  int NOH_local = hwNumOfOH(la);
   if (NOH_local < NOH) NOH = NOH_local;
   for (int ohN = 0; ohN < NOH; ohN++){
     // If this Optohybrid is masked skip it
@@ -189,32 +202,21 @@ void getmonDAQOHmainLocal(localArgs * la, int NOH, int ohMask)
       la->response->set_word(t1,0xdeaddead);
       continue;
     }
-    t1 = stdsprintf("OH%s.STATUS.EVT_SIZE_ERR",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.%s",t1.c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.STATUS.EVENT_FIFO_HAD_OFLOW",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.%s",t1.c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.STATUS.INPUT_FIFO_HAD_OFLOW",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.%s",t1.c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.STATUS.INPUT_FIFO_HAD_UFLOW",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.%s",t1.c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.STATUS.VFAT_TOO_MANY",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.%s",t1.c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.STATUS.VFAT_NO_MARKER",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.%s",t1.c_str());
-    la->response->set_word(t1,readReg(la,t2));
+    for (auto const& status : {"EVT_SIZE_ERR", "EVENT_FIFO_HAD_OFLOW", "INPUT_FIFO_HAD_OFLOW",
+                               "INPUT_FIFO_HAD_UFLOW", "VFAT_TOO_MANY", "VFAT_NO_MARKER"}) {
+      t1 = stdsprintf("OH%s.STATUS.%s",std::to_string(ohN).c_str(),status);
+      regs.push_back(stdsprintf("GEM_AMC.DAQ.%s",t1.c_str()));
+      keys.push_back(t1);
+    }
   }
+  setWordsFromRegs(la, keys, regs);
 }
 
 void getmonDAQOHmain(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
   int ohMask = 0xfff;
   if (request->get_key_exists("ohMask")) {
     ohMask = request->get_word("ohMask");
@@ -230,7 +232,6 @@ void getmonDAQOHmain(const RPCMsg *request, RPCMsg *response)
   }
 
   getmonDAQOHmainLocal(&la, NOH, ohMask);
-  rtxn.abort();
 }
 
 void getmonGBTLinkLocal(localArgs * la, int NOH, bool doReset)
@@ -238,41 +239,39 @@ void getmonGBTLinkLocal(localArgs * la, int NOH, bool doReset)
     //Reset Requested?
     if (doReset) {
          writeReg(la, "GEM_AMC.GEM_SYSTEM.CTRL.LINK_RESET", 0x1);
+         hwContextInvalidate();
     }
 
-    std::string regName, respName; //regName used for read/write, respName sets word in RPC response
+    std::vector<std::string> regNames, respNames; //regNames used for read/write, respNames set words in RPC response
     for (int ohN=0; ohN < NOH; ++ohN) {
         for (unsigned int gbtN=0; gbtN < gbt::GBTS_PER_OH; ++gbtN) {
             //Ready
-            respName = stdsprintf("OH%i.GBT%i.READY",ohN,gbtN);
-            regName = stdsprintf("GEM_AMC.OH_LINKS.OH%i.GBT%i_READY",ohN,gbtN);
-            la->response->set_word(respName,readReg(la, regName));
+            respNames.push_back(stdsprintf("OH%i.GBT%i.READY",ohN,gbtN));
+            regNames.push_back(stdsprintf("GEM_AMC.OH_LINKS.OH%i.GBT%i_READY",ohN,gbtN));
 
             //Was not ready
-            respName = stdsprintf("OH%i.GBT%i.WAS_NOT_READY",ohN,gbtN);
-            regName = stdsprintf("GEM_AMC.OH_LINKS.OH%i.GBT%i_WAS_NOT_READY",ohN,gbtN);
-            la->response->set_word(respName,readReg(la, regName));
+            respNames.push_back(stdsprintf("OH%i.GBT%i.WAS_NOT_READY",ohN,gbtN));
+            regNames.push_back(stdsprintf("GEM_AMC.OH_LINKS.OH%i.GBT%i_WAS_NOT_READY",ohN,gbtN));
 
             //Rx had overflow
-            respName = stdsprintf("OH%i.GBT%i.RX_HAD_OVERFLOW",ohN,gbtN);
-            regName = stdsprintf("GEM_AMC.OH_LINKS.OH%i.GBT%i_RX_HAD_OVERFLOW",ohN,gbtN);
-            la->response->set_word(respName,readReg(la, regName));
+            respNames.push_back(stdsprintf("OH%i.GBT%i.RX_HAD_OVERFLOW",ohN,gbtN));
+            regNames.push_back(stdsprintf("GEM_AMC.OH_LINKS.OH%i.GBT%i_RX_HAD_OVERFLOW",ohN,gbtN));
 
             //Rx had underflow
-            respName = stdsprintf("OH%i.GBT%i.RX_HAD_UNDERFLOW",ohN,gbtN);
-            regName = stdsprintf("GEM_AMC.OH_LINKS.OH%i.GBT%i_RX_HAD_UNDERFLOW",ohN,gbtN);
-            la->response->set_word(respName,readReg(la, regName));
+            respNames.push_back(stdsprintf("OH%i.GBT%i.RX_HAD_UNDERFLOW",ohN,gbtN));
+            regNames.push_back(stdsprintf("GEM_AMC.OH_LINKS.OH%i.GBT%i_RX_HAD_UNDERFLOW",ohN,gbtN));
         } //End Loop Over GBT's
     } //End Loop Over All OH's
+    setWordsFromRegs(la, respNames, regNames);
 
     return;
 } //End getmonGBTLinkLocal()
 
 void getmonGBTLink(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
 
   if (request->get_key_exists("NOH")) {
     unsigned int NOH_requested = request->get_word("NOH");
@@ -288,14 +287,13 @@ void getmonGBTLink(const RPCMsg *request, RPCMsg *response)
   }
 
   getmonGBTLinkLocal(&la, NOH, doReset);
-  rtxn.abort();
 } //End getmonGBTLink()
 
 void getmonOHLink(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
 
   if (request->get_key_exists("NOH")) {
     unsigned int NOH_requested = request->get_word("NOH");
@@ -312,15 +310,14 @@ void getmonOHLink(const RPCMsg *request, RPCMsg *response)
 
   getmonGBTLinkLocal(&la, NOH, doReset);
   getmonVFATLinkLocal(&la, NOH, doReset);
-
-  rtxn.abort();
 } //End getmonOHLink()
 
 void getmonOHmainLocal(localArgs * la, int NOH, int ohMask)
 {
-  int NOH_local = readReg(la,"GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  int NOH_local = hwNumOfOH(la);
   if (NOH_local < NOH) NOH = NOH_local;
-  std::string t1,t2;
+  std::string t1;
+  std::vector<std::string> keys, regs;
   for (int ohN = 0; ohN < NOH; ohN++) {
     // If this Optohybrid is masked skip it
     if (!((ohMask >> ohN) & 0x1)) {
@@ -346,56 +343,50 @@ void getmonOHmainLocal(localArgs * la, int NOH, int ohMask)
     }
     t1 = stdsprintf("OH%s.FW_VERSION",std::to_string(ohN).c_str());
     if (fw_version_check("getmonOHmain",la) == 3) {
+      uint32_t t_ver[4];
+      readRegs(la, {stdsprintf("GEM_AMC.OH.OH%s.FPGA.CONTROL.RELEASE.VERSION.MAJOR",std::to_string(ohN).c_str()),
+                    stdsprintf("GEM_AMC.OH.OH%s.FPGA.CONTROL.RELEASE.VERSION.MINOR",std::to_string(ohN).c_str()),
+                    stdsprintf("GEM_AMC.OH.OH%s.FPGA.CONTROL.RELEASE.VERSION.BUILD",std::to_string(ohN).c_str()),
+                    stdsprintf("GEM_AMC.OH.OH%s.FPGA.CONTROL.RELEASE.VERSION.GENERATION",std::to_string(ohN).c_str())},
+               t_ver);
       uint32_t t_fwver=0xffffffff;
-      t2 = stdsprintf("GEM_AMC.OH.OH%s.FPGA.CONTROL.RELEASE.VERSION.MAJOR",std::to_string(ohN).c_str());
-      t_fwver = t_fwver & (0x00ffffff|(readReg(la,t2) << 24));
-      LOGGER->log_message(LogManager::INFO, stdsprintf("FW version MAJOR for OH%i is %08x, t_fwver is %08x ",ohN, readReg(la,t2), t_fwver));
-      t2 = stdsprintf("GEM_AMC.OH.OH%s.FPGA.CONTROL.RELEASE.VERSION.MINOR",std::to_string(ohN).c_str());
-      t_fwver = t_fwver & (0xff00ffff|(readReg(la,t2) << 16));
-      LOGGER->log_message(LogManager::INFO, stdsprintf("FW version MINOR for OH%i is %08x, t_fwver is %08x ",ohN, readReg(la,t2), t_fwver));
-      t2 = stdsprintf("GEM_AMC.OH.OH%s.FPGA.CONTROL.RELEASE.VERSION.BUILD",std::to_string(ohN).c_str());
-      t_fwver = t_fwver & (0xffff00ff|(readReg(la,t2) << 8));
-      LOGGER->log_message(LogManager::INFO, stdsprintf("FW version BUILD for OH%i is %08x, t_fwver is %08x ",ohN, readReg(la,t2), t_fwver));
-      t2 = stdsprintf("GEM_AMC.OH.OH%s.FPGA.CONTROL.RELEASE.VERSION.GENERATION",std::to_string(ohN).c_str());
-      t_fwver = t_fwver & (0xffffff00|(readReg(la,t2)));
-      LOGGER->log_message(LogManager::INFO, stdsprintf("FW version GENERATION for OH%i is %08x, t_fwver is %08x ",ohN, readReg(la,t2), t_fwver));
+      t_fwver = t_fwver & (0x00ffffff|(t_ver[0] << 24));
+      t_fwver = t_fwver & (0xff00ffff|(t_ver[1] << 16));
+      t_fwver = t_fwver & (0xffff00ff|(t_ver[2] << 8));
+      t_fwver = t_fwver & (0xffffff00|(t_ver[3]));
+      LOGGER->log_message(LogManager::INFO, stdsprintf("FW version for OH%i is %08x (MAJOR %x, MINOR %x, BUILD %x, GENERATION %x)",
+                                                       ohN, t_fwver, t_ver[0], t_ver[1], t_ver[2], t_ver[3]));
       la->response->set_word(t1,t_fwver);
     } else {
-      t2 = stdsprintf("GEM_AMC.OH.OH%s.STATUS.FW.VERSION",std::to_string(ohN).c_str());
-      la->response->set_word(t1,readReg(la,t2));
+      keys.push_back(t1);
+      regs.push_back(stdsprintf("GEM_AMC.OH.OH%s.STATUS.FW.VERSION",std::to_string(ohN).c_str()));
     }
-    t1 = stdsprintf("OH%s.EVENT_COUNTER",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.OH%s.COUNTERS.EVN",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.EVENT_RATE",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.OH%s.COUNTERS.EVT_RATE",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.GTX.TRK_ERR",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.OH.OH%s.COUNTERS.GTX_LINK.TRK_ERR",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.GTX.TRG_ERR",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.OH.OH%s.COUNTERS.GTX_LINK.TRG_ERR",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.GBT.TRK_ERR",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.OH.OH%s.COUNTERS.GBT_LINK.TRK_ERR",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.CORR_VFAT_BLK_CNT",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.DAQ.OH%s.COUNTERS.CORRUPT_VFAT_BLK_CNT",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.COUNTERS.SEU",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.OH.OH%s.COUNTERS.SEU",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
-    t1 = stdsprintf("OH%s.STATUS.SEU",std::to_string(ohN).c_str());
-    t2 = stdsprintf("GEM_AMC.OH.OH%s.STATUS.SEU",std::to_string(ohN).c_str());
-    la->response->set_word(t1,readReg(la,t2));
+    const std::string ohs = std::to_string(ohN);
+    keys.push_back(stdsprintf("OH%s.EVENT_COUNTER",ohs.c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.DAQ.OH%s.COUNTERS.EVN",ohs.c_str()));
+    keys.push_back(stdsprintf("OH%s.EVENT_RATE",ohs.c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.DAQ.OH%s.COUNTERS.EVT_RATE",ohs.c_str()));
+    keys.push_back(stdsprintf("OH%s.GTX.TRK_ERR",ohs.c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.OH.OH%s.COUNTERS.GTX_LINK.TRK_ERR",ohs.c_str()));
+    keys.push_back(stdsprintf("OH%s.GTX.TRG_ERR",ohs.c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.OH.OH%s.COUNTERS.GTX_LINK.TRG_ERR",ohs.c_str()));
+    keys.push_back(stdsprintf("OH%s.GBT.TRK_ERR",ohs.c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.OH.OH%s.COUNTERS.GBT_LINK.TRK_ERR",ohs.c_str()));
+    keys.push_back(stdsprintf("OH%s.CORR_VFAT_BLK_CNT",ohs.c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.DAQ.OH%s.COUNTERS.CORRUPT_VFAT_BLK_CNT",ohs.c_str()));
+    keys.push_back(stdsprintf("OH%s.COUNTERS.SEU",ohs.c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.OH.OH%s.COUNTERS.SEU",ohs.c_str()));
+    keys.push_back(stdsprintf("OH%s.STATUS.SEU",ohs.c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.OH.OH%s.STATUS.SEU",ohs.c_str()));
   }
+  setWordsFromRegs(la, keys, regs);
 }
 
 void getmonOHmain(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
   int ohMask = 0xfff;
   if (request->get_key_exists("ohMask")) {
     ohMask = request->get_word("ohMask");
@@ -411,19 +402,19 @@ void getmonOHmain(const RPCMsg *request, RPCMsg *response)
   }
 
   getmonOHmainLocal(&la, NOH, ohMask);
-  rtxn.abort();
 }
 
 void getmonOHSCAmainLocal(localArgs *la, int NOH, int ohMask)
 {
-    std::string strRegName, strKeyName;
+    std::string strKeyName;
+    std::vector<std::string> strRegNames, strKeyNames;
 
     //Get original monitoring mask
     uint32_t initSCAMonOffMask = readReg(la, "GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.MONITORING_OFF");
 
     //Turn on monitoring for requested links
     writeReg(la, "GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.MONITORING_OFF", (~ohMask) & 0x3fc);
-    int NOH_local = readReg(la,"GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    int NOH_local = hwNumOfOH(la);
     if (NOH_local < NOH) NOH = NOH_local;
 
     for (int ohN = 0; ohN < NOH; ++ohN) { //Loop over all optohybrids
@@ -473,68 +464,17 @@ void getmonOHSCAmainLocal(localArgs *la, int NOH, int ohMask)
         //Log Message
         LOGGER->log_message(LogManager::INFO, stdsprintf("Reading SCA Monitoring Values for OH%i",ohN));
 
-        //SCA Temperature
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.SCA_TEMP",ohN);
-        strKeyName = stdsprintf("OH%i.SCA_TEMP",ohN);
-        la->response->set_word(strKeyName,readReg(la, strRegName));
-
-        //OH Temperature Sensors
-        for (int tempVal=1; tempVal <= 9; ++tempVal) { //Loop over optohybrid temperatures sensosrs
-            strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.BOARD_TEMP%i",ohN,tempVal);
-            strKeyName = stdsprintf("OH%i.BOARD_TEMP%i",ohN,tempVal);
-            la->response->set_word(strKeyName, readReg(la, strRegName));
-        } //End Loop over optohybrid temeprature sensors
-
-        //Voltage Monitor - AVCCN
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.AVCCN",ohN);
-        strKeyName = stdsprintf("OH%i.AVCCN",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - AVTTN
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.AVTTN",ohN);
-        strKeyName = stdsprintf("OH%i.AVTTN",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - 1V0_INT
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.1V0_INT",ohN);
-        strKeyName = stdsprintf("OH%i.1V0_INT",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - 1V8F
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.1V8F",ohN);
-        strKeyName = stdsprintf("OH%i.1V8F",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - 1V5
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.1V5",ohN);
-        strKeyName = stdsprintf("OH%i.1V5",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - 2V5_IO
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.2V5_IO",ohN);
-        strKeyName = stdsprintf("OH%i.2V5_IO",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - 3V0
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.3V0",ohN);
-        strKeyName = stdsprintf("OH%i.3V0",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - 1V8
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.1V8",ohN);
-        strKeyName = stdsprintf("OH%i.1V8",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - VTRX_RSSI2
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.VTRX_RSSI2",ohN);
-        strKeyName = stdsprintf("OH%i.VTRX_RSSI2",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
-
-        //Voltage Monitor - VTRX_RSSI1
-        strRegName = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.VTRX_RSSI1",ohN);
-        strKeyName = stdsprintf("OH%i.VTRX_RSSI1",ohN);
-        la->response->set_word(strKeyName, readReg(la, strRegName));
+        //SCA Temperature, OH Temperature Sensors and Voltage Monitors
+        for (auto const& sensor : {"SCA_TEMP",
+                                   "BOARD_TEMP1", "BOARD_TEMP2", "BOARD_TEMP3", "BOARD_TEMP4", "BOARD_TEMP5",
+                                   "BOARD_TEMP6", "BOARD_TEMP7", "BOARD_TEMP8", "BOARD_TEMP9",
+                                   "AVCCN", "AVTTN", "1V0_INT", "1V8F", "1V5", "2V5_IO", "3V0", "1V8",
+                                   "VTRX_RSSI2", "VTRX_RSSI1"}) {
+            strRegNames.push_back(stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.OH%i.%s",ohN,sensor));
+            strKeyNames.push_back(stdsprintf("OH%i.%s",ohN,sensor));
+        }
     } //End Loop over all optohybrids
+    setWordsFromRegs(la, strKeyNames, strRegNames);
 
     //Return monitoring to original value
     writeReg(la, "GEM_AMC.SLOW_CONTROL.SCA.ADC_MONITORING.MONITORING_OFF", initSCAMonOffMask);
@@ -544,9 +484,9 @@ void getmonOHSCAmainLocal(localArgs *la, int NOH, int ohMask)
 
 void getmonOHSCAmain(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
   int ohMask = 0xfff;
   if (request->get_key_exists("ohMask")) {
     ohMask = request->get_word("ohMask");
@@ -562,14 +502,13 @@ void getmonOHSCAmain(const RPCMsg *request, RPCMsg *response)
   }
 
   getmonOHSCAmainLocal(&la, NOH, ohMask);
-  rtxn.abort();
 }
 
 void getmonOHSysmonLocal(localArgs *la, int NOH, int ohMask, bool doReset)
 {
     std::string strKeyName;
     std::string strRegBase;
-    int NOH_local = readReg(la,"GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    int NOH_local = hwNumOfOH(la);
     if (NOH_local < NOH) NOH = NOH_local;
 
     if (fw_version_check("getmonOHSysmon", la) == 3) {
@@ -615,26 +554,13 @@ void getmonOHSysmonLocal(localArgs *la, int NOH, int ohMask, bool doReset)
                 writeReg(la, strRegBase+"RESET", 0x1);
             }
 
-            //Read Alarm conditions & counters - OVERTEMP
-            strKeyName = stdsprintf("OH%i.OVERTEMP",ohN);
-            la->response->set_word(strKeyName,readReg(la, strRegBase + "OVERTEMP"));
-
-            strKeyName = stdsprintf("OH%i.CNT_OVERTEMP",ohN);
-            la->response->set_word(strKeyName,readReg(la, strRegBase + "CNT_OVERTEMP"));
-
-            //Read Alarm conditions & counters - VCCAUX_ALARM
-            strKeyName = stdsprintf("OH%i.VCCAUX_ALARM",ohN);
-            la->response->set_word(strKeyName,readReg(la, strRegBase + "VCCAUX_ALARM"));
-
-            strKeyName = stdsprintf("OH%i.CNT_VCCAUX_ALARM",ohN);
-            la->response->set_word(strKeyName,readReg(la, strRegBase + "CNT_VCCAUX_ALARM"));
-
-            //Read Alarm conditions & counters - VCCINT_ALARM
-            strKeyName = stdsprintf("OH%i.VCCINT_ALARM",ohN);
-            la->response->set_word(strKeyName,readReg(la, strRegBase + "VCCINT_ALARM"));
-
-            strKeyName = stdsprintf("OH%i.CNT_VCCINT_ALARM",ohN);
-            la->response->set_word(strKeyName,readReg(la, strRegBase + "CNT_VCCINT_ALARM"));
+            //Read Alarm conditions & counters - OVERTEMP, VCCAUX_ALARM, VCCINT_ALARM
+            std::vector<std::string> strKeyNames, strRegNames;
+            for (auto const& alarm : {"OVERTEMP", "CNT_OVERTEMP", "VCCAUX_ALARM", "CNT_VCCAUX_ALARM", "VCCINT_ALARM", "CNT_VCCINT_ALARM"}) {
+                strKeyNames.push_back(stdsprintf("OH%i.%s",ohN,alarm));
+                strRegNames.push_back(strRegBase + alarm);
+            }
+            setWordsFromRegs(la, strKeyNames, strRegNames);
 
             //Enable Sysmon ADC Read
             writeReg(la, strRegBase + "ENABLE", 0x1);
@@ -699,9 +625,9 @@ void getmonOHSysmonLocal(localArgs *la, int NOH, int ohMask, bool doReset)
 
 void getmonOHSysmon(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
   int ohMask = 0xfff;
   if (request->get_key_exists("ohMask")) {
     ohMask = request->get_word("ohMask");
@@ -719,31 +645,28 @@ void getmonOHSysmon(const RPCMsg *request, RPCMsg *response)
   bool doReset = request->get_word("doReset");
 
   getmonOHSysmonLocal(&la, NOH, ohMask, doReset);
-  rtxn.abort();
 } //End getmonOHSysmon()
 
 void getmonSCALocal(localArgs * la, int NOH)
 {
-  int NOH_local = readReg(la,"GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  int NOH_local = hwNumOfOH(la);
   if (NOH_local < NOH) NOH = NOH_local;
-  std::string t1,t2;
-  la->response->set_word("SCA.STATUS.READY", readReg(la, "GEM_AMC.SLOW_CONTROL.SCA.STATUS.READY"));
-  la->response->set_word("SCA.STATUS.CRITICAL_ERROR", readReg(la, "GEM_AMC.SLOW_CONTROL.SCA.STATUS.CRITICAL_ERROR"));
+  std::vector<std::string> keys = {"SCA.STATUS.READY", "SCA.STATUS.CRITICAL_ERROR"};
+  std::vector<std::string> regs = {"GEM_AMC.SLOW_CONTROL.SCA.STATUS.READY", "GEM_AMC.SLOW_CONTROL.SCA.STATUS.CRITICAL_ERROR"};
   for (int i = 0; i < NOH; ++i) {
-    t1 = stdsprintf("SCA.STATUS.NOT_READY_CNT_OH%s",std::to_string(i).c_str());
-    t2 = stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.STATUS.NOT_READY_CNT_OH%s",std::to_string(i).c_str());
-    la->response->set_word(t1,readReg(la,t2));
+    keys.push_back(stdsprintf("SCA.STATUS.NOT_READY_CNT_OH%s",std::to_string(i).c_str()));
+    regs.push_back(stdsprintf("GEM_AMC.SLOW_CONTROL.SCA.STATUS.NOT_READY_CNT_OH%s",std::to_string(i).c_str()));
   }
+  setWordsFromRegs(la, keys, regs);
 }
 
 void getmonSCA(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   int NOH = request->get_word("NOH");
 
   getmonSCALocal(&la, NOH);
-  rtxn.abort();
 } //End getmonSCA()
 
 void getmonVFATLinkLocal(localArgs * la, int NOH, bool doReset)
@@ -751,34 +674,44 @@ void getmonVFATLinkLocal(localArgs * la, int NOH, bool doReset)
     //Reset Requested?
     if (doReset) {
          writeReg(la, "GEM_AMC.GEM_SYSTEM.CTRL.LINK_RESET", 0x1);
+         hwContextInvalidate();
          std::this_thread::sleep_for(std::chrono::microseconds(92)); // FIXME sleep for N orbits
     }
 
-    std::string regName, respName; //regName used for read/write, respName sets word in RPC response
-    bool vfatOutOfSync = false;
+    STATIC_REGS_CHECK(la, );
+    REG_FAMILY(syncErrCnts, la, vfatSyncErrCnt, "GEM_AMC.OH_LINKS.OH*.VFAT*.SYNC_ERR_CNT");
+    REG_FAMILY(daqEventCnts, la, vfatDaqEventCnt, "GEM_AMC.OH_LINKS.OH*.VFAT*.DAQ_EVENT_CNT");
+    REG_FAMILY(daqCrcErrorCnts, la, vfatDaqCrcErrorCnt, "GEM_AMC.OH_LINKS.OH*.VFAT*.DAQ_CRC_ERROR_CNT");
+
+    std::vector<regDescriptor> regs; //regs used for read/write, respNames set words in RPC response
+    std::vector<std::string> respNames;
     for (int ohN=0; ohN < NOH; ++ohN) {
         for (unsigned int vfatN=0; vfatN < oh::VFATS_PER_OH; ++vfatN) {
             //Sync Error Counters
-            respName = stdsprintf("OH%i.VFAT%i.SYNC_ERR_CNT",ohN,vfatN);
-            regName = stdsprintf("GEM_AMC.OH_LINKS.OH%i.VFAT%i.SYNC_ERR_CNT",ohN,vfatN);
-            int nSyncErrs = readReg(la,regName);
-            la->response->set_word(respName,nSyncErrs);
-            if ( nSyncErrs > 0 ) {
-                vfatOutOfSync = true;
-            }
+            respNames.push_back(stdsprintf("OH%i.VFAT%i.SYNC_ERR_CNT",ohN,vfatN));
+            regs.push_back(syncErrCnts.member(ohN, vfatN));
 
             //DAQ Event Counters
-            respName = stdsprintf("OH%i.VFAT%i.DAQ_EVENT_CNT",ohN,vfatN);
-            regName = stdsprintf("GEM_AMC.OH_LINKS.OH%i.VFAT%i.DAQ_EVENT_CNT",ohN,vfatN);
-            la->response->set_word(respName,readReg(la,regName));
+            respNames.push_back(stdsprintf("OH%i.VFAT%i.DAQ_EVENT_CNT",ohN,vfatN));
+            regs.push_back(daqEventCnts.member(ohN, vfatN));
 
             //DAQ CRC Error Counters
-            respName = stdsprintf("OH%i.VFAT%i.DAQ_CRC_ERROR_CNT",ohN,vfatN);
-            regName = stdsprintf("GEM_AMC.OH_LINKS.OH%i.VFAT%i.DAQ_CRC_ERROR_CNT",ohN,vfatN);
-            la->response->set_word(respName,readReg(la,regName));
+            respNames.push_back(stdsprintf("OH%i.VFAT%i.DAQ_CRC_ERROR_CNT",ohN,vfatN));
+            regs.push_back(daqCrcErrorCnts.member(ohN, vfatN));
         } //End Loop Over VFAT's
     } //End Loop Over All OH's
 
+    std::vector<uint32_t> values(regs.size());
+    readRegs(la, regs, values.data());
+    bool vfatOutOfSync = false;
+    for (size_t i = 0; i < regs.size(); ++i) {
+        la->response->set_word(respNames[i], values[i]);
+        //Sync Error Counters come first for each VFAT
+        if ((i % 3) == 0 && static_cast<int>(values[i]) > 0) {
+            vfatOutOfSync = true;
+        }
+    }
+
     //Set OOS flag (out of sync)
     if (vfatOutOfSync) {
         la->response->set_string("warning","One or more VFATs found to be out of sync\n");
@@ -789,9 +722,9 @@ void getmonVFATLinkLocal(localArgs * la, int NOH, bool doReset)
 
 void getmonVFATLink(const RPCMsg *request, RPCMsg *response)
 {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+  unsigned int NOH = hwNumOfOH(&la);
 
   if (request->get_key_exists("NOH")) {
     unsigned int NOH_requested = request->get_word("NOH");
@@ -807,7 +740,6 @@ void getmonVFATLink(const RPCMsg *request, RPCMsg *response)
   }
 
   getmonVFATLinkLocal(&la, NOH, doReset);
-  rtxn.abort();
 } //End getmonVFATLink()
 
 extern "C" {
@@ -32,7 +32,7 @@ void mblockread(const RPCMsg *request, RPCMsg *response) {
 /*! \fn void mfiforead(const RPCMsg *request, RPCMsg *response)
  *  \brief Sequentially reads a block of values from the same raw register address.
  *  Register mask is not applied
- *  The address acts like a port/FIFO
+ *  The address acts like a port/FIFO, all the values are read under a single memhub lock hold
  *  \param request RPC request message
  *  \param response RPC response message
  */
@@ -41,35 +41,33 @@ void mfiforead(const RPCMsg *request, RPCMsg *response) {
   uint32_t addr  = request->get_word("address");
   uint32_t data[count];
 
-  for (unsigned int i=0; i<count; i++){
-    if (memhub_read(memsvc, addr, 1, &data[i]) != 0) {
-      response->set_string("error", memsvc_get_last_error(memsvc));
-      LOGGER->log_message(LogManager::INFO, stdsprintf("read memsvc error: %s",
-                                                       memsvc_get_last_error(memsvc)));
-      return;
-    }
+  if (memhub_read_port(memsvc, addr, count, data) != 0) {
+    response->set_string("error", memsvc_get_last_error(memsvc));
+    LOGGER->log_message(LogManager::INFO, stdsprintf("read memsvc error: %s",
+                                                     memsvc_get_last_error(memsvc)));
+    return;
   }
   response->set_word_array("data", data, count);
 }
 
 /*! \fn void mlistread(const RPCMsg *request, RPCMsg *response)
  *  \brief Reads a list of raw addresses
+ *  The addresses are read in increasing order, contiguous ones in a single block read, and the values are returned
+ *  in the order of the request. The "count" word of older clients is not needed and ignored.
  *  \param request RPC request message
  *  \param response RPC response message
  */
 void mlistread(const RPCMsg *request, RPCMsg *response) {
-  uint32_t count = request->get_word("count");
+  uint32_t count = request->get_word_array_size("addresses");
   uint32_t addr[count];
   request->get_word_array("addresses", addr);
   uint32_t data[count];
 
-  for (unsigned int i=0; i<count; i++){
-    if (memhub_read(memsvc, addr[i], 1, &data[i]) != 0) {
-      response->set_string("error", memsvc_get_last_error(memsvc));
-      LOGGER->log_message(LogManager::INFO, stdsprintf("read memsvc error: %s",
-                                                       memsvc_get_last_error(memsvc)));
-      return;
-    }
+  if (memhub_list_read(memsvc, addr, count, data) != 0) {
+    response->set_string("error", memsvc_get_last_error(memsvc));
+    LOGGER->log_message(LogManager::INFO, stdsprintf("read memsvc error: %s",
+                                                     memsvc_get_last_error(memsvc)));
+    return;
   }
   response->set_word_array("data", data, count);
 }
@@ -108,14 +106,12 @@ void mfifowrite(const RPCMsg *request, RPCMsg *response) {
   uint32_t data[count];
   request->get_word_array("data", data);
 
-  for (unsigned int i=0; i<count; i++){
-    if (memhub_write(memsvc, addr, 1, &data[i]) != 0) {
-      response->set_string("error", memsvc_get_last_error(memsvc));
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("fifowrite memsvc error: %s",
-                                                        memsvc_get_last_error(memsvc)));
-      // needs better error handling
-      return;
-    }
+  if (memhub_write_port(memsvc, addr, count, data) != 0) {
+    response->set_string("error", memsvc_get_last_error(memsvc));
+    LOGGER->log_message(LogManager::ERROR, stdsprintf("fifowrite memsvc error: %s",
+                                                      memsvc_get_last_error(memsvc)));
+    // needs better error handling
+    return;
   }
   // return type?
   response->set_word_array("data", data, count);
@@ -123,6 +119,7 @@ void mfifowrite(const RPCMsg *request, RPCMsg *response) {
 
 /*! \fn void mlistwrite(const RPCMsg *request, RPCMsg *response)
  *  \brief writes a set of values to a list of addresses
+ *  The values are written in the order of the request, runs of contiguous addresses in a single block write
  *  \param request RPC request message
  *  \param response RPC response message
  */
@@ -134,19 +131,47 @@ void mlistwrite(const RPCMsg *request, RPCMsg *response) {
   uint32_t data[count];
   request->get_word_array("data", data);
 
-  for (unsigned int i=0; i<count; i++){
-    if (memhub_write(memsvc, addr[i], 1, &data[i]) != 0) {
-      response->set_string("error", memsvc_get_last_error(memsvc));
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("listwrite memsvc error: %s",
-                                                        memsvc_get_last_error(memsvc)));
-      // needs better error handling
-      return;
-    }
+  if (memhub_list_write(memsvc, addr, count, data) != 0) {
+    response->set_string("error", memsvc_get_last_error(memsvc));
+    LOGGER->log_message(LogManager::ERROR, stdsprintf("listwrite memsvc error: %s",
+                                                      memsvc_get_last_error(memsvc)));
+    // needs better error handling
+    return;
   }
   // return type?
   response->set_word_array("data", data, count);
 }
 
+/*! \fn void mlistwritemasked(const RPCMsg *request, RPCMsg *response)
+ *  \brief writes the masked bits of a set of values to a list of addresses
+ *  The entries are grouped by address, and each distinct word is read and written once, all under a single memhub lock hold.
+ *  The indices of the entries which could not be written are returned in the "failed" array.
+ *  \param request RPC request message, with the "addresses", "masks" and "data" arrays of the same size
+ *  \param response RPC response message
+ */
+void mlistwritemasked(const RPCMsg *request, RPCMsg *response) {
+  uint32_t count = request->get_word_array_size("addresses");
+  if (request->get_word_array_size("masks") != count || request->get_word_array_size("data") != count) {
+    response->set_string("error", "addresses, masks and data must have the same size");
+    LOGGER->log_message(LogManager::ERROR, "listwritemasked: addresses, masks and data must have the same size");
+    return;
+  }
+  uint32_t addr[count];
+  request->get_word_array("addresses", addr);
+  uint32_t mask[count];
+  request->get_word_array("masks", mask);
+  uint32_t data[count];
+  request->get_word_array("data", data);
+
+  uint32_t failed[count];
+  uint32_t nFailed = memhub_list_write_masked(memsvc, addr, mask, data, count, failed);
+  if (nFailed) {
+    response->set_word_array("failed", failed, nFailed);
+    response->set_string("error", stdsprintf("%u of %u masked writes failed: %s", nFailed, count, memsvc_get_last_error(memsvc)));
+    LOGGER->log_message(LogManager::ERROR, stdsprintf("listwritemasked memsvc error: %u of %u writes failed: %s",
+                                                      nFailed, count, memsvc_get_last_error(memsvc)));
+  }
+}
 
 extern "C" {
   const char *module_version_key = "extras v1.0.1";
@@ -164,5 +189,6 @@ extern "C" {
     modmgr->register_method("extras", "fifowrite",  mfifowrite);
     modmgr->register_method("extras", "blockwrite", mblockwrite);
     modmgr->register_method("extras", "listwrite",  mlistwrite);
+    modmgr->register_method("extras", "listwritemasked", mlistwritemasked);
   }
 }
@@ -10,6 +10,7 @@
 #include "moduleapi.h"
 #include "memhub.h"
 #include "utils.h"
+#include "utils/static_regs.h"
 
 #include <array>
 #include <thread>
@@ -17,7 +18,7 @@
 
 void scanGBTPhases(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     // Get the keys
     const uint32_t ohN = request->get_word("ohN");
@@ -30,10 +31,7 @@ void scanGBTPhases(const RPCMsg *request, RPCMsg *response)
     LOGGER->log_message(LogManager::INFO, stdsprintf("Calling Local Method for OH #%u.", ohN));
     if (scanGBTPhasesLocal(&la, ohN, nScans, phaseMin, phaseMax, phaseStep)) {
         LOGGER->log_message(LogManager::INFO, stdsprintf("GBT Scan for OH #%u Failed.", ohN));
-        rtxn.abort();
     }
-
-    rtxn.abort();
 } //Enc scanGBTPhase
 
 bool scanGBTPhasesLocal(localArgs *la, const uint32_t ohN, const uint32_t N, const uint8_t phaseMin, const uint8_t phaseMax, const uint8_t phaseStep)
@@ -41,7 +39,7 @@ bool scanGBTPhasesLocal(localArgs *la, const uint32_t ohN, const uint32_t N, con
     LOGGER->log_message(LogManager::INFO, stdsprintf("Scanning the phases for OH #%u.", ohN));
 
     // ohN check
-    const uint32_t ohMax = readReg(la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    const uint32_t ohMax = hwNumOfOH(la);
     if (ohN >= ohMax)
         EMIT_RPC_ERROR(la->response, stdsprintf("The ohN parameter supplied (%u) exceeds the number of OH's supported by the CTP7 (%u).", ohN, ohMax), true);
 
@@ -53,6 +51,9 @@ bool scanGBTPhasesLocal(localArgs *la, const uint32_t ohN, const uint32_t N, con
     if (gbt::checkPhase(la->response, phaseMax))
         return true;
 
+    STATIC_REGS_CHECK(la, true);
+    REG_FAMILY(syncErrCnts, la, vfatSyncErrCnt, "GEM_AMC.OH_LINKS.OH*.VFAT*.SYNC_ERR_CNT");
+
     // Results array
     std::vector<std::vector<uint32_t>> results(oh::VFATS_PER_OH, std::vector<uint32_t>(16));
 
@@ -70,13 +71,14 @@ bool scanGBTPhasesLocal(localArgs *la, const uint32_t ohN, const uint32_t N, con
         for (uint32_t repN = 0; repN < N; repN++) {
             // Try to synchronize the VFAT's
             writeReg(la, "GEM_AMC.GEM_SYSTEM.CTRL.LINK_RESET", 1);
+            hwContextInvalidate();
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
             // Check the VFAT status
             slowCtrlErrCntVFAT vfatErrs;
             for (uint32_t vfatN = 0; vfatN < oh::VFATS_PER_OH; vfatN++) {
                 // check SYNC_ERR_CNT
-                if (readReg(la, stdsprintf("GEM_AMC.OH_LINKS.OH%hu.VFAT%hu.SYNC_ERR_CNT", ohN, vfatN)) != 0){
+                if (syncErrCnts.read(ohN, vfatN) != 0){
                     continue;
                 }
 
@@ -115,7 +117,7 @@ bool scanGBTPhasesLocal(localArgs *la, const uint32_t ohN, const uint32_t N, con
 
 void writeGBTConfig(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     // Get the keys
     const uint32_t ohN = request->get_word("ohN");
@@ -131,8 +133,6 @@ void writeGBTConfig(const RPCMsg *request, RPCMsg *response)
 
     // Write the configuration
     writeGBTConfigLocal(&la, ohN, gbtN, config);
-
-    rtxn.abort();
 } //End writeGBTConfig(...)
 
 bool writeGBTConfigLocal(localArgs *la, const uint32_t ohN, const uint32_t gbtN, const gbt::config_t &config)
@@ -140,7 +140,7 @@ bool writeGBTConfigLocal(localArgs *la, const uint32_t ohN, const uint32_t gbtN,
     LOGGER->log_message(LogManager::INFO, stdsprintf("Writing the configuration of OH #%u - GBTX #%u.", ohN, gbtN));
 
     // ohN check
-    const uint32_t ohMax = readReg(la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    const uint32_t ohMax = hwNumOfOH(la);
     if (ohN >= ohMax)
         EMIT_RPC_ERROR(la->response, stdsprintf("The ohN parameter supplied (%u) exceeds the number of OH's supported by the CTP7 (%u).", ohN, ohMax), true);
 
@@ -159,7 +159,7 @@ bool writeGBTConfigLocal(localArgs *la, const uint32_t ohN, const uint32_t gbtN,
 
 void writeGBTPhase(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     // Get the keys
     const uint32_t ohN = request->get_word("ohN");
@@ -168,8 +168,6 @@ void writeGBTPhase(const RPCMsg *request, RPCMsg *response)
 
     // Write the phase
     writeGBTPhaseLocal(&la, ohN, vfatN, phase);
-
-    rtxn.abort();
 } //End writeGBTPhase
 
 bool writeGBTPhaseLocal(localArgs *la, const uint32_t ohN, const uint32_t vfatN, const uint8_t phase)
@@ -177,7 +175,7 @@ bool writeGBTPhaseLocal(localArgs *la, const uint32_t ohN, const uint32_t vfatN,
     //LOGGER->log_message(LogManager::INFO, stdsprintf("Writing %u to the VFAT #%u phase of OH #%u.", phase, vfatN, ohN));
 
     // ohN check
-    const uint32_t ohMax = readReg(la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    const uint32_t ohMax = hwNumOfOH(la);
     if (ohN >= ohMax)
         EMIT_RPC_ERROR(la->response, stdsprintf("The ohN parameter supplied (%u) exceeds the number of OH's supported by the CTP7 (%u).", ohN, ohMax), true);
 
@@ -213,17 +211,24 @@ bool writeGBTRegLocal(localArgs *la, const uint32_t ohN, const uint32_t gbtN, co
     if (address >= gbt::CONFIG_SIZE)
         EMIT_RPC_ERROR(la->response, stdsprintf("GBT has %hu writable addresses while the provided address is %hu.", gbt::CONFIG_SIZE-1, address), true);
 
+    STATIC_REGS_CHECK(la, true);
+    REG_SINGLE(icLength, la, icReadWriteLength, "GEM_AMC.SLOW_CONTROL.IC.READ_WRITE_LENGTH");
+    REG_SINGLE(icLinkSelect, la, icGbtxLinkSelect, "GEM_AMC.SLOW_CONTROL.IC.GBTX_LINK_SELECT");
+    REG_SINGLE(icAddress, la, icAddress, "GEM_AMC.SLOW_CONTROL.IC.ADDRESS");
+    REG_SINGLE(icWriteData, la, icWriteData, "GEM_AMC.SLOW_CONTROL.IC.WRITE_DATA");
+    REG_SINGLE(icExecuteWrite, la, icExecuteWrite, "GEM_AMC.SLOW_CONTROL.IC.EXECUTE_WRITE");
+
     // GBT registers are 8 bits long
-    writeReg(la, "GEM_AMC.SLOW_CONTROL.IC.READ_WRITE_LENGTH", 1);
+    icLength.write(1);
 
     // Select the link number
     const uint32_t linkN = ohN*gbt::GBTS_PER_OH + gbtN;
-    writeReg(la, "GEM_AMC.SLOW_CONTROL.IC.GBTX_LINK_SELECT", linkN);
+    icLinkSelect.write(linkN);
 
     // Write to the register
-    writeReg(la, "GEM_AMC.SLOW_CONTROL.IC.ADDRESS", address);
-    writeReg(la, "GEM_AMC.SLOW_CONTROL.IC.WRITE_DATA", value);
-    writeReg(la, "GEM_AMC.SLOW_CONTROL.IC.EXECUTE_WRITE", 1);
+    icAddress.write(address);
+    icWriteData.write(value);
+    icExecuteWrite.write(1);
 
     return false;
 } //End writeGBTRegLocal(...)
@@ -1,78 +1,733 @@
 #include "memhub.h"
+#include "memhub/sim.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <semaphore.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/wait.h>
 #include <fcntl.h>
+#include <time.h>
 #include <unistd.h>
 
-#define SEM_NAME "/memhub"
-#define SEM_PERMS (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP)
-#define SEM_INIT 1
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
-static sem_t *semaphore = NULL;
-static bool busy = false;
+#define SHM_NAME "/memhub"
+#define SHM_PERMS (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP)
+#define SHM_MAGIC 0x6d686204U
+#define SHM_LOCK_PATH "/dev/shm/memhub.lock"
 
-int memhub_open(memsvc_handle_t *handle) {
-    if (semaphore == NULL) {
-        semaphore = sem_open(SEM_NAME, O_CREAT, SEM_PERMS, SEM_INIT);
-        int semval = 0;
-        sem_getvalue(semaphore, &semval);
-        if (semval > 1) {
-            LOGGER->log_message(LogManager::INFO, stdsprintf("Invalid semaphore value = %d. Probably it was messed up by a dying process. Please clean up this semaphore (you can just delete /dev/shm/sem.memhub, I think)\n", semval));
-            exit(1);
+#define MAX_HOLD_ENV "MEMHUB_MAX_HOLD_US"
+#define MAX_HOLD_DEFAULT_US 10000
+
+#define DOMAINS_ENV "MEMHUB_DOMAINS"
+
+#define BACKEND_ENV "MEMHUB_BACKEND"
+#define MMAP_DEVICE_ENV "MEMHUB_MMAP_DEVICE"
+#define MMAP_BASE_ENV "MEMHUB_MMAP_BASE"
+#define MMAP_SIZE_ENV "MEMHUB_MMAP_SIZE"
+#define MMAP_OFFSET_ENV "MEMHUB_MMAP_OFFSET"
+#define MMAP_DEVICE_DEFAULT "/dev/mem"
+
+// Host builds have no hardware access, their registers are simulated by default
+#ifdef MEMHUB_HOST
+#define BACKEND_DEFAULT "sim"
+#else
+#define BACKEND_DEFAULT "memsvc"
+#endif
+
+// Statistics of one process, only ever written by the process owning the slot
+struct stats_slot {
+    int32_t  pid;  // owner, 0 if free
+    uint32_t reserved;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t read_words;
+    uint64_t write_words;
+    uint64_t errors;
+    uint64_t recoveries;
+    uint64_t wait_ns;
+    uint64_t hold_ns;
+    uint64_t wait_hist[MEMHUB_STATS_BUCKETS];
+    uint64_t hold_hist[MEMHUB_STATS_BUCKETS];
+} __attribute__((aligned(64)));
+
+// State shared by all the processes: the lock domain table, the robust mutexes and the statistics,
+// lock i+1 protects [d[i].base, d[i].last], lock 0 everything else
+struct memhub_shared {
+    uint32_t magic;  // written last, once the segment is initialized
+    uint32_t size;   // sizeof(struct memhub_shared) of the process which created the segment
+    uint32_t n;
+    struct {
+        uint32_t base;
+        uint32_t last;
+    } d[MEMHUB_MAX_DOMAINS];
+    pthread_mutex_t locks[MEMHUB_MAX_DOMAINS+1];
+    struct stats_slot stats[MEMHUB_STATS_SLOTS];
+};
+
+static struct memhub_shared *shared = NULL;
+static struct stats_slot *stats = NULL;                // slot of this process, NULL if all the slots are taken
+static uint32_t n_domains = 0;
+static uint64_t held = 0;                              // locks currently held by this process, one bit per lock
+
+static unsigned int tx_depth = 0;                      // nesting level of memhub_transaction_begin
+static uint32_t max_hold_us = MAX_HOLD_DEFAULT_US;     // 0 means the locks are never released during a transaction
+static uint64_t hold_start_ns = 0;
+
+static uint64_t now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec*1000000000ULL + now.tv_nsec;
+}
+
+// The slot has a single writer, so plain relaxed loads and stores are enough for the readers to see consistent counters
+static void stats_add(uint64_t *counter, uint64_t value) {
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static void stats_hist(uint64_t *hist, uint64_t ns) {
+    uint32_t bucket = ns ? 63 - __builtin_clzll(ns) : 0;
+    if (bucket >= MEMHUB_STATS_BUCKETS)
+        bucket = MEMHUB_STATS_BUCKETS - 1;
+    stats_add(&hist[bucket], 1);
+}
+
+// Locks are always taken in increasing order and released in decreasing order.
+// A lock left behind by a process which died while holding it is recovered.
+static int lock(uint64_t mask) {
+    const uint64_t start = stats ? now_ns() : 0;
+    const bool first = (held == 0);
+    for (uint32_t i = 0; i <= n_domains; ++i) {
+        if (((mask >> i) & 1) == 0)
+            continue;
+        int err = pthread_mutex_lock(&shared->locks[i]);
+        if (err == EOWNERDEAD) {
+            LOGGER->log_message(LogManager::WARNING, stdsprintf("Memhub lock %u was held by a process which died, recovering it\n", i));
+            if (stats)
+                stats_add(&stats->recoveries, 1);
+            err = pthread_mutex_consistent(&shared->locks[i]);
+        }
+        if (err != 0) {
+            LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to take memhub lock %u: %s\n", i, strerror(err)));
+            return -1;
+        }
+        held |= (1ULL << i);
+    }
+    const uint64_t end = (stats || max_hold_us) ? now_ns() : 0;
+    if (first)
+        hold_start_ns = end;
+    if (stats) {
+        stats_add(&stats->wait_ns, end - start);
+        stats_hist(stats->wait_hist, end - start);
+    }
+    return 0;
+}
+
+static void unlock(uint64_t mask) {
+    for (uint32_t i = n_domains+1; i-- > 0; ) {
+        if (((mask & held) >> i) & 1) {
+            held &= ~(1ULL << i);
+            pthread_mutex_unlock(&shared->locks[i]);
+            if (held == 0 && stats) {
+                const uint64_t hold = now_ns() - hold_start_ns;
+                stats_add(&stats->hold_ns, hold);
+                stats_hist(stats->hold_hist, hold);
+            }
+        }
+    }
+}
+
+static void count_op(bool write, uint32_t words, int ret) {
+    if (!stats)
+        return;
+    if (ret != 0) {
+        stats_add(&stats->errors, 1);
+    } else if (write) {
+        stats_add(&stats->writes, 1);
+        stats_add(&stats->write_words, words);
+    } else {
+        stats_add(&stats->reads, 1);
+        stats_add(&stats->read_words, words);
+    }
+}
+
+static bool alive(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+// Takes a free slot, or the slot of a process which is gone, keeping its counters
+static struct stats_slot *claim_stats_slot() {
+    const int32_t me = getpid();
+    for (uint32_t i = 0; i < MEMHUB_STATS_SLOTS; ++i) {
+        int32_t expected = 0;
+        if (__atomic_compare_exchange_n(&shared->stats[i].pid, &expected, me, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            return &shared->stats[i];
+    }
+    for (uint32_t i = 0; i < MEMHUB_STATS_SLOTS; ++i) {
+        int32_t owner = __atomic_load_n(&shared->stats[i].pid, __ATOMIC_RELAXED);
+        if (!alive(owner) && __atomic_compare_exchange_n(&shared->stats[i].pid, &owner, me, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            return &shared->stats[i];
+    }
+    LOGGER->log_message(LogManager::WARNING, "All the memhub statistics slots are taken, not recording statistics for this process\n");
+    return NULL;
+}
+
+// A forked child must not write to the slot of its parent
+static void reclaim_stats_slot() {
+    stats = claim_stats_slot();
+}
+
+// Returns the locks protecting the byte range of an operation
+static uint64_t locks_for(uint32_t addr, uint32_t words) {
+    if (n_domains == 0)
+        return 1;
+
+    const uint64_t last = addr + (words ? 4ULL*words : 4ULL) - 1;
+    uint32_t lo = 0, hi = n_domains;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (shared->d[mid].last < addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    uint64_t mask = 0;
+    uint64_t covered = addr;  // first byte not yet attributed to a domain
+    for (uint32_t i = lo; i < n_domains && shared->d[i].base <= last; ++i) {
+        if (shared->d[i].base > covered)
+            mask |= 1;
+        mask |= (1ULL << (i+1));
+        covered = shared->d[i].last + 1ULL;
+    }
+    if (covered <= last)
+        mask |= 1;
+    return mask;
+}
+
+// Takes the locks needed by the next operation of a transaction, keeping the lock order strict
+static int extend(uint64_t mask) {
+    const uint64_t missing = mask & ~held;
+    if (!missing)
+        return 0;
+    if (held && __builtin_ctzll(missing) < 63 - __builtin_clzll(held)) {
+        const uint64_t all = held | mask;
+        unlock(held);
+        return lock(all);
+    }
+    return lock(missing);
+}
+
+// Called before each operation of a transaction: hands the locks over to the other processes once they were held for too long
+static int yield_if_held_too_long() {
+    if (max_hold_us == 0 || held == 0 || now_ns() - hold_start_ns < max_hold_us*1000ULL)
+        return 0;
+    const uint64_t mask = held;
+    unlock(mask);
+    sched_yield();
+    return lock(mask);
+}
+
+// Parses the domain file, the table stays empty if there is none
+static void read_domains(struct memhub_shared *table) {
+    char path[512];
+    const char *file = getenv(DOMAINS_ENV);
+    const char *gem_path = getenv("GEM_PATH");
+    if (!file && gem_path) {
+        snprintf(path, sizeof(path), "%s/%s", gem_path, MEMHUB_DOMAINS_FILE);
+        file = path;
+    }
+    FILE *f = file ? fopen(file, "r") : NULL;
+    if (!f)
+        return;
+
+    char line[256];
+    unsigned long base, last;
+    while (table->n < MEMHUB_MAX_DOMAINS && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || sscanf(line, "%lx %lx", &base, &last) != 2 || last < base)
+            continue;
+        if (table->n > 0 && base <= table->d[table->n-1].last) {
+            LOGGER->log_message(LogManager::ERROR, stdsprintf("Ignoring unsorted or overlapping memhub lock domain 0x%08lx-0x%08lx\n", base, last));
+            continue;
+        }
+        table->d[table->n].base = base;
+        table->d[table->n].last = last;
+        ++table->n;
+    }
+    fclose(f);
+}
+
+static int init_shared(struct memhub_shared *sh) {
+    read_domains(sh);
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    int err = 0;
+    for (uint32_t i = 0; err == 0 && i <= MEMHUB_MAX_DOMAINS; ++i)
+        err = pthread_mutex_init(&sh->locks[i], &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (err != 0) {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to initialize the memhub locks: %s\n", strerror(err)));
+        return -1;
+    }
+    sh->size = sizeof(struct memhub_shared);
+    __atomic_store_n(&sh->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Maps the segment, NULL if it cannot be mapped or is not an initialized segment of this layout
+static struct memhub_shared *map_shared(int fd, bool *valid) {
+    struct stat st;
+    *valid = false;
+    if (fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(struct memhub_shared))
+        return NULL;
+    void *addr = mmap(NULL, sizeof(struct memhub_shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+        return NULL;
+    struct memhub_shared *sh = (struct memhub_shared *)addr;
+    *valid = (__atomic_load_n(&sh->magic, __ATOMIC_ACQUIRE) == SHM_MAGIC && sh->size == sizeof(struct memhub_shared));
+    return sh;
+}
+
+// The segment is opened under an exclusive flock on SHM_LOCK_PATH, which the kernel releases if the process dies, so
+// that exactly one process creates it and the others find it initialized. A segment which is not initialized (its
+// creator died first) or has another layout (written by another release) is unlinked and created again: the processes
+// still using it keep their mapping, the new ones share the new segment.
+static struct memhub_shared *open_shared() {
+    int lock_fd = open(SHM_LOCK_PATH, O_RDWR | O_CREAT | O_CLOEXEC, SHM_PERMS);
+    if (lock_fd < 0 || flock(lock_fd, LOCK_EX) != 0) {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to lock %s: %s\n", SHM_LOCK_PATH, strerror(errno)));
+        if (lock_fd >= 0)
+            close(lock_fd);
+        return NULL;
+    }
+
+    struct memhub_shared *sh = NULL;
+    int fd = shm_open(SHM_NAME, O_RDWR, SHM_PERMS);
+    if (fd >= 0) {
+        bool valid;
+        sh = map_shared(fd, &valid);
+        close(fd);
+        if (!valid) {
+            LOGGER->log_message(LogManager::WARNING, "The memhub shared memory is stale or has another layout, creating it again\n");
+            if (sh)
+                munmap(sh, sizeof(struct memhub_shared));
+            sh = NULL;
+            shm_unlink(SHM_NAME);
+        }
+    } else if (errno != ENOENT) {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to open the memhub shared memory: %s\n", strerror(errno)));
+        close(lock_fd);
+        return NULL;
+    }
+
+    if (!sh) {
+        fd = shm_open(SHM_NAME, O_RDWR | O_CREAT | O_EXCL, SHM_PERMS);
+        if (fd < 0 || ftruncate(fd, sizeof(struct memhub_shared)) != 0) {
+            LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to create the memhub shared memory: %s\n", strerror(errno)));
+            if (fd >= 0) {
+                close(fd);
+                shm_unlink(SHM_NAME);
+            }
+            close(lock_fd);
+            return NULL;
+        }
+        bool valid;
+        sh = map_shared(fd, &valid);
+        close(fd);
+        if (!sh || init_shared(sh) != 0) {
+            LOGGER->log_message(LogManager::ERROR, "Unable to initialize the memhub shared memory\n");
+            if (sh)
+                munmap(sh, sizeof(struct memhub_shared));
+            shm_unlink(SHM_NAME);
+            sh = NULL;
         }
-        LOGGER->log_message(LogManager::INFO, stdsprintf("\nMemhub initialized a semaphore. Current semaphore value = %d\n", semval));
     }
-    if (semaphore == SEM_FAILED) {
-        perror("sem_open(3) error");
-        exit(1);
+    close(lock_fd);
+    return sh;
+}
+
+// Register access backends, all the accesses go through the locks above
+// read_port/write_port access words times the same address
+struct backend {
+    const char *name;
+    int (*read)(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data);
+    int (*write)(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data);
+    int (*read_port)(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data);
+    int (*write_port)(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data);
+};
+
+// libmemsvc block accesses always increment the address, ports are accessed word by word
+static int memsvc_read_port(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data) {
+    for (uint32_t i = 0; i < words; ++i)
+        if (memsvc_read(handle, addr, 1, &data[i]) != 0)
+            return -1;
+    return 0;
+}
+
+static int memsvc_write_port(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data) {
+    for (uint32_t i = 0; i < words; ++i)
+        if (memsvc_write(handle, addr, 1, &data[i]) != 0)
+            return -1;
+    return 0;
+}
+
+static const struct backend memsvc_backend = {"memsvc", memsvc_read, memsvc_write, memsvc_read_port, memsvc_write_port};
+
+// AXI window mapped by the mmap backend, accesses outside of it go through libmemsvc
+static volatile uint32_t *window = NULL;
+static uint32_t window_base = 0;
+static uint32_t window_size = 0;
+
+static bool in_window(uint32_t addr, uint32_t words) {
+    return (addr & 3) == 0 && addr >= window_base && (uint64_t)(addr - window_base) + 4ULL*words <= window_size;
+}
+
+static int mmap_read(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data) {
+    if (!in_window(addr, words))
+        return memsvc_read(handle, addr, words, data);
+    const volatile uint32_t *reg = window + (addr - window_base)/4;
+    for (uint32_t i = 0; i < words; ++i)
+        data[i] = reg[i];
+    return 0;
+}
+
+static int mmap_write(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data) {
+    if (!in_window(addr, words))
+        return memsvc_write(handle, addr, words, data);
+    volatile uint32_t *reg = window + (addr - window_base)/4;
+    for (uint32_t i = 0; i < words; ++i)
+        reg[i] = data[i];
+    return 0;
+}
+
+static int mmap_read_port(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data) {
+    if (!in_window(addr, 1))
+        return memsvc_read_port(handle, addr, words, data);
+    const volatile uint32_t *reg = window + (addr - window_base)/4;
+    for (uint32_t i = 0; i < words; ++i)
+        data[i] = *reg;
+    return 0;
+}
+
+static int mmap_write_port(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data) {
+    if (!in_window(addr, 1))
+        return memsvc_write_port(handle, addr, words, data);
+    volatile uint32_t *reg = window + (addr - window_base)/4;
+    for (uint32_t i = 0; i < words; ++i)
+        *reg = data[i];
+    return 0;
+}
+
+static const struct backend mmap_backend = {"mmap", mmap_read, mmap_write, mmap_read_port, mmap_write_port};
+
+static int sim_read(memsvc_handle_t, uint32_t addr, uint32_t words, uint32_t *data) {
+    return memhub_sim_read(addr, words, data);
+}
+
+static int sim_write(memsvc_handle_t, uint32_t addr, uint32_t words, const uint32_t *data) {
+    return memhub_sim_write(addr, words, data);
+}
+
+static int sim_read_port(memsvc_handle_t, uint32_t addr, uint32_t words, uint32_t *data) {
+    for (uint32_t i = 0; i < words; ++i)
+        if (memhub_sim_read(addr, 1, &data[i]) != 0)
+            return -1;
+    return 0;
+}
+
+static int sim_write_port(memsvc_handle_t, uint32_t addr, uint32_t words, const uint32_t *data) {
+    for (uint32_t i = 0; i < words; ++i)
+        if (memhub_sim_write(addr, 1, &data[i]) != 0)
+            return -1;
+    return 0;
+}
+
+static const struct backend sim_backend = {"sim", sim_read, sim_write, sim_read_port, sim_write_port};
+
+static const struct backend *backend = &memsvc_backend;
+
+// Maps the AXI window described by the environment, returns false if it is not available
+static bool open_window() {
+    const char *device = getenv(MMAP_DEVICE_ENV);
+    const char *base   = getenv(MMAP_BASE_ENV);
+    const char *size   = getenv(MMAP_SIZE_ENV);
+    const char *offset = getenv(MMAP_OFFSET_ENV);
+    if (!device)
+        device = MMAP_DEVICE_DEFAULT;
+    if (!base || !size) {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("%s and %s are needed by the mmap backend\n", MMAP_BASE_ENV, MMAP_SIZE_ENV));
+        return false;
+    }
+    window_base = strtoul(base, NULL, 0);
+    window_size = strtoul(size, NULL, 0);
+    // the window is found at its AXI address in /dev/mem, a regular file usually starts with it
+    const uint64_t file_offset = offset ? strtoull(offset, NULL, 0) : window_base;
+    const uint64_t page = sysconf(_SC_PAGESIZE);
+    const uint64_t skip = file_offset % page;
+
+    int fd = open(device, O_RDWR | O_SYNC);
+    if (fd < 0) {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to open %s: %s\n", device, strerror(errno)));
+        return false;
+    }
+    void *addr = mmap(NULL, window_size + skip, PROT_READ | PROT_WRITE, MAP_SHARED, fd, file_offset - skip);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to map 0x%x bytes of %s: %s\n", window_size, device, strerror(errno)));
+        return false;
+    }
+    window = (volatile uint32_t *)((char *)addr + skip);
+    LOGGER->log_message(LogManager::INFO, stdsprintf("Memhub mapped AXI addresses 0x%08x-0x%08x from %s\n",
+                                                     window_base, window_base + window_size - 1, device));
+    return true;
+}
+
+static void select_backend() {
+    const char *name = getenv(BACKEND_ENV);
+    if (!name)
+        name = BACKEND_DEFAULT;
+    if (strcmp(name, memsvc_backend.name) == 0)
+        return;
+    if (strcmp(name, mmap_backend.name) == 0) {
+        if (open_window())
+            backend = &mmap_backend;
+        else
+            LOGGER->log_message(LogManager::WARNING, "Memhub falls back to the memsvc backend\n");
+        return;
+    }
+    if (strcmp(name, sim_backend.name) == 0) {
+        if (memhub_sim_open())
+            backend = &sim_backend;
+        else
+            LOGGER->log_message(LogManager::WARNING, "Memhub falls back to the memsvc backend\n");
+        return;
     }
+    LOGGER->log_message(LogManager::ERROR, stdsprintf("Unknown memhub backend %s, using memsvc\n", name));
+}
 
-    // handle all signals in attempt to undo an active semaphore if the process is killed in the middle of a transaction..
-    signal(SIGABRT, die);
-    signal(SIGFPE, die);
-    signal(SIGILL, die);
-    signal(SIGINT, die);
-    signal(SIGSEGV, die);
-    signal(SIGTERM, die);
+int memhub_open(memsvc_handle_t *handle) {
+    if (shared == NULL) {
+        shared = open_shared();
+        if (shared == NULL)
+            return -1;
+        n_domains = shared->n;
+        stats = claim_stats_slot();
+        pthread_atfork(NULL, NULL, reclaim_stats_slot);
+        LOGGER->log_message(LogManager::INFO, stdsprintf("Memhub initialized, using %u lock domains\n", n_domains));
 
+        const char *max_hold = getenv(MAX_HOLD_ENV);
+        if (max_hold)
+            memhub_set_max_hold_time(strtoul(max_hold, NULL, 0));
+
+        select_backend();
+    }
     return memsvc_open(handle);
 }
 
 int memhub_close(memsvc_handle_t *handle) {
-    sem_close(semaphore);
     return memsvc_close(handle);
 }
 
+// Runs a backend operation on [addr, addr + 4*words) under the corresponding locks
+template <typename Op>
+static int locked(uint32_t addr, uint32_t words, Op op) {
+    const uint64_t mask = locks_for(addr, words);
+    int ret = -1;
+    if (tx_depth > 0) {
+        if (yield_if_held_too_long() == 0 && extend(mask) == 0)
+            ret = op();
+    } else {
+        if (lock(mask) == 0)
+            ret = op();
+        unlock(mask);
+    }
+    return ret;
+}
+
 int memhub_read(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data) {
-    sem_wait(semaphore);
-    busy = true;
-    int ret = memsvc_read(handle, addr, words, data);
-    sem_post(semaphore);
-    busy = false;
+    int ret = locked(addr, words, [&]() { return backend->read(handle, addr, words, data); });
+    count_op(false, words, ret);
     return ret;
 }
 
 int memhub_write(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data) {
-    sem_wait(semaphore);
-    busy = true;
-    int ret = memsvc_write(handle, addr, words, data);
-    sem_post(semaphore);
-    busy = false;
+    int ret = locked(addr, words, [&]() { return backend->write(handle, addr, words, data); });
+    count_op(true, words, ret);
+    return ret;
+}
+
+int memhub_read_port(memsvc_handle_t handle, uint32_t addr, uint32_t words, uint32_t *data) {
+    int ret = locked(addr, 1, [&]() { return backend->read_port(handle, addr, words, data); });
+    count_op(false, words, ret);
+    return ret;
+}
+
+int memhub_write_port(memsvc_handle_t handle, uint32_t addr, uint32_t words, const uint32_t *data) {
+    int ret = locked(addr, 1, [&]() { return backend->write_port(handle, addr, words, data); });
+    count_op(true, words, ret);
+    return ret;
+}
+
+int memhub_write_masked(memsvc_handle_t handle, uint32_t addr, uint32_t mask, uint32_t value) {
+    if (mask == 0xFFFFFFFF)
+        return memhub_write(handle, addr, 1, &value);
+    bool read = false;
+    int ret = locked(addr, 1, [&]() {
+        uint32_t current;
+        if (backend->read(handle, addr, 1, &current) != 0)
+            return -1;
+        read = true;
+        current = (current & ~mask) | (value & mask);
+        return backend->write(handle, addr, 1, &current);
+    });
+    count_op(false, 1, read ? 0 : -1);
+    if (read)
+        count_op(true, 1, ret);
+    return ret;
+}
+
+int memhub_list_read(memsvc_handle_t handle, const uint32_t *addrs, uint32_t count, uint32_t *data) {
+    // perm[i] is the request index of the i-th lowest address, equal addresses keep their request order
+    std::vector<uint32_t> perm(count);
+    for (uint32_t i = 0; i < count; ++i)
+        perm[i] = i;
+    std::stable_sort(perm.begin(), perm.end(), [addrs](uint32_t a, uint32_t b) { return addrs[a] < addrs[b]; });
+
+    if (memhub_transaction_begin() != 0)
+        return -1;
+    int ret = 0;
+    std::vector<uint32_t> block;
+    for (uint32_t first = 0; first < count && ret == 0; ) {
+        uint32_t last = first;
+        while (last+1 < count && addrs[perm[last+1]] == addrs[perm[last]] + 4)
+            ++last;
+        const uint32_t words = last - first + 1;
+        block.resize(words);
+        ret = memhub_read(handle, addrs[perm[first]], words, block.data());
+        for (uint32_t i = 0; ret == 0 && i < words; ++i)
+            data[perm[first+i]] = block[i];
+        first = last + 1;
+    }
+    memhub_transaction_end();
+    return ret;
+}
+
+int memhub_list_write(memsvc_handle_t handle, const uint32_t *addrs, uint32_t count, const uint32_t *data) {
+    if (memhub_transaction_begin() != 0)
+        return -1;
+    int ret = 0;
+    for (uint32_t first = 0; first < count && ret == 0; ) {
+        uint32_t last = first;
+        while (last+1 < count && addrs[last+1] == addrs[last] + 4)
+            ++last;
+        ret = memhub_write(handle, addrs[first], last - first + 1, &data[first]);
+        first = last + 1;
+    }
+    memhub_transaction_end();
     return ret;
 }
 
-void die(int signo) {
-    int semval = 0;
-    sem_getvalue(semaphore, &semval);
+uint32_t memhub_list_write_masked(memsvc_handle_t handle, const uint32_t *addrs, const uint32_t *masks, const uint32_t *values,
+                                  uint32_t count, uint32_t *failed) {
+    // one entry per distinct word, in order of first appearance, later entries taking precedence on the bits they share
+    struct masked_word {
+        uint32_t addr;
+        uint32_t mask;
+        uint32_t value;
+    };
+    std::vector<masked_word> words;
+    std::vector<uint32_t> word_of(count);
+    std::unordered_map<uint32_t, uint32_t> index;
+    words.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        auto it = index.find(addrs[i]);
+        if (it == index.end()) {
+            it = index.insert(std::make_pair(addrs[i], (uint32_t)words.size())).first;
+            words.push_back({addrs[i], 0, 0});
+        }
+        masked_word &w = words[it->second];
+        w.value = (w.value & ~masks[i]) | (values[i] & masks[i]);
+        w.mask |= masks[i];
+        word_of[i] = it->second;
+    }
+
+    std::vector<bool> word_failed(words.size(), true);
+    if (memhub_transaction_begin() == 0) {
+        for (size_t w = 0; w < words.size(); ++w) {
+            // no bit to write: skip the read-modify-write, the word is left as it is
+            if (words[w].mask == 0) {
+                word_failed[w] = false;
+                continue;
+            }
+            word_failed[w] = (memhub_write_masked(handle, words[w].addr, words[w].mask, words[w].value) != 0);
+        }
+        memhub_transaction_end();
+    }
+
+    uint32_t n_failed = 0;
+    for (uint32_t i = 0; i < count; ++i)
+        if (word_failed[word_of[i]])
+            failed[n_failed++] = i;
+    return n_failed;
+}
+
+int memhub_transaction_begin(void) {
+    if (shared == NULL)
+        return -1;
+    ++tx_depth;
+    return 0;
+}
 
-    if (busy && (semval == 0)) {
-        LOGGER->log_message(LogManager::ERROR, stdsprintf("[!] Application is dying, trying to undo an active semaphore..\n"));
-        sem_post(semaphore);
+int memhub_transaction_end(void) {
+    if (tx_depth == 0)
+        return -1;
+    if (--tx_depth == 0)
+        unlock(held);
+    return 0;
+}
+
+void memhub_set_max_hold_time(uint32_t usec) {
+    max_hold_us = usec;
+}
+
+const char *memhub_backend(void) {
+    return backend->name;
+}
+
+int memhub_get_stats(struct memhub_stats *total) {
+    if (shared == NULL)
+        return -1;
+    memset(total, 0, sizeof(*total));
+    for (uint32_t i = 0; i < MEMHUB_STATS_SLOTS; ++i) {
+        struct stats_slot *slot = &shared->stats[i];
+        const int32_t owner = __atomic_load_n(&slot->pid, __ATOMIC_RELAXED);
+        if (owner == 0)
+            continue;
+        if (alive(owner))
+            ++total->processes;
+        total->reads       += __atomic_load_n(&slot->reads, __ATOMIC_RELAXED);
+        total->writes      += __atomic_load_n(&slot->writes, __ATOMIC_RELAXED);
+        total->read_words  += __atomic_load_n(&slot->read_words, __ATOMIC_RELAXED);
+        total->write_words += __atomic_load_n(&slot->write_words, __ATOMIC_RELAXED);
+        total->errors      += __atomic_load_n(&slot->errors, __ATOMIC_RELAXED);
+        total->recoveries  += __atomic_load_n(&slot->recoveries, __ATOMIC_RELAXED);
+        total->wait_ns     += __atomic_load_n(&slot->wait_ns, __ATOMIC_RELAXED);
+        total->hold_ns     += __atomic_load_n(&slot->hold_ns, __ATOMIC_RELAXED);
+        for (uint32_t b = 0; b < MEMHUB_STATS_BUCKETS; ++b) {
+            total->wait_hist[b] += __atomic_load_n(&slot->wait_hist[b], __ATOMIC_RELAXED);
+            total->hold_hist[b] += __atomic_load_n(&slot->hold_hist[b], __ATOMIC_RELAXED);
+        }
     }
-    LOGGER->log_message(LogManager::ERROR, stdsprintf("[!] Application was killed or died with signal %d (semaphore value at the time of the kill = %d)...\n", signo, semval));
-    exit(1);
+    return 0;
 }
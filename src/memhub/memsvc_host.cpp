@@ -0,0 +1,47 @@
+/*!
+ * \file memhub/memsvc_host.cpp
+ * \brief libmemsvc replacement for host builds, where all the registers are simulated
+ */
+
+#ifdef MEMHUB_HOST
+
+#include "memhub.h"
+#include "memhub/sim.h"
+
+struct memsvc_handle {
+};
+
+static struct memsvc_handle s_handle;
+
+extern "C" {
+  int memsvc_open(memsvc_handle_t *handle)
+  {
+    *handle = &s_handle;
+    return 0;
+  }
+
+  int memsvc_close(memsvc_handle_t *handle)
+  {
+    *handle = nullptr;
+    return 0;
+  }
+
+  const char *memsvc_get_last_error(memsvc_handle_t)
+  {
+    return memhub_sim_last_error();
+  }
+
+  int memsvc_read(memsvc_handle_t, uint32_t, uint32_t, uint32_t *)
+  {
+    memhub_sim_set_error("No hardware access in host builds");
+    return -1;
+  }
+
+  int memsvc_write(memsvc_handle_t, uint32_t, uint32_t, const uint32_t *)
+  {
+    memhub_sim_set_error("No hardware access in host builds");
+    return -1;
+  }
+}
+
+#endif
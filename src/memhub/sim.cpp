@@ -0,0 +1,237 @@
+/*!
+ * \file memhub/sim.cpp
+ * \brief Simulated register space backend of memhub
+ */
+
+#include "memhub/sim.h"
+#include "utils.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <unordered_map>
+
+namespace {
+  enum simBehaviour : uint8_t {
+    SIM_STROBE,
+    SIM_COUNTER,
+    SIM_BUSY,
+  };
+
+  struct simField {
+    uint32_t mask;
+    uint8_t  shift;
+    uint8_t  behaviour;
+    uint32_t arg;       ///< counter step, or number of reads a busy flag stays set
+    uint32_t remaining; ///< reads left before a busy flag is cleared
+  };
+
+  struct simWord {
+    uint32_t value = 0;
+    uint32_t readOnlyMask = 0; ///< bits which are not modified by writes
+    std::vector<simField> fields;
+  };
+
+  struct simTrigger {
+    uint32_t mask;    ///< trigger bits
+    uint32_t address; ///< address of the busy flag
+    size_t   field;   ///< index of the busy flag in its word
+  };
+
+  std::unordered_map<uint32_t, simWord> s_words;
+  std::unordered_multimap<uint32_t, simTrigger> s_triggers;
+  uint64_t s_latencyNs = 0;
+  std::string s_error;
+
+  struct simTarget {
+    uint32_t address;
+    uint32_t mask;
+    uint8_t  shift;
+  };
+
+  bool resolve(lmdb::txn & rtxn, lmdb::dbi & dbi, const std::string & reg, simTarget & target)
+  {
+    if (std::isdigit(static_cast<unsigned char>(reg[0]))) {
+      target = {static_cast<uint32_t>(std::strtoul(reg.c_str(), nullptr, 0)), 0xFFFFFFFF, 0};
+      return true;
+    }
+    lmdb::val key, db_res;
+    key.assign(reg);
+    if (!dbi.get(rtxn, key, db_res) || db_res.size() != sizeof(regDescriptor)
+        || static_cast<uint8_t>(db_res.data()[0]) != REG_DESC_MAGIC)
+      return false;
+    regDescriptor desc;
+    std::memcpy(&desc, db_res.data(), sizeof(desc));
+    target = {desc.address, desc.mask, desc.shift};
+    return true;
+  }
+
+  void addField(const simTarget & target, simBehaviour behaviour, uint32_t arg)
+  {
+    s_words[target.address].fields.push_back({target.mask, target.shift, behaviour, arg, 0});
+  }
+
+  void configure(lmdb::txn & rtxn, lmdb::dbi & dbi, const char * path)
+  {
+    std::ifstream config(path);
+    if (!config) {
+      LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to read the register simulation configuration %s", path));
+      return;
+    }
+    std::string line, reg, behaviour, trigger;
+    int lineN = 0;
+    while (std::getline(config, line)) {
+      ++lineN;
+      std::istringstream tokens(line);
+      if (!(tokens >> reg) || reg[0] == '#')
+        continue;
+      tokens >> behaviour;
+      simTarget target, trig;
+      if (!resolve(rtxn, dbi, reg, target) || s_words.find(target.address) == s_words.end()) {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("%s:%d: unknown register %s", path, lineN, reg.c_str()));
+        continue;
+      }
+      simWord & w = s_words[target.address];
+      uint32_t arg = 1;
+      if (behaviour == "value" && (tokens >> std::setbase(0) >> arg)) {
+        w.value = (w.value & ~target.mask) | ((arg << target.shift) & target.mask);
+      } else if (behaviour == "strobe") {
+        addField(target, SIM_STROBE, 0);
+      } else if (behaviour == "counter") {
+        tokens >> std::setbase(0) >> arg;
+        addField(target, SIM_COUNTER, arg);
+      } else if (behaviour == "busy" && (tokens >> trigger >> arg) && resolve(rtxn, dbi, trigger, trig)) {
+        addField(target, SIM_BUSY, arg);
+        w.readOnlyMask |= target.mask;
+        s_triggers.insert({trig.address, {trig.mask, target.address, w.fields.size()-1}});
+      } else {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("%s:%d: invalid behaviour %s", path, lineN, line.c_str()));
+      }
+    }
+  }
+
+  void wait()
+  {
+    if (!s_latencyNs)
+      return;
+    // short latencies are spun, the scheduler is not accurate enough for them
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (s_latencyNs >= 100000) {
+      const struct timespec delay = {static_cast<time_t>(s_latencyNs / 1000000000), static_cast<long>(s_latencyNs % 1000000000)};
+      nanosleep(&delay, nullptr);
+      return;
+    }
+    do {
+      clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - start.tv_sec)*1000000000ULL + now.tv_nsec - start.tv_nsec < s_latencyNs);
+  }
+
+  simWord * word(uint32_t address)
+  {
+    auto it = s_words.find(address);
+    if (it != s_words.end())
+      return &it->second;
+    s_error = stdsprintf("No simulated register at address 0x%08x", address);
+    return nullptr;
+  }
+}
+
+bool memhub_sim_open()
+{
+  const char * table = std::getenv("MEMHUB_SIM_TABLE");
+  const char * gem_path = std::getenv("GEM_PATH");
+  const std::string path = table ? table : std::string(gem_path ? gem_path : ".") + "/address_table.mdb";
+  const char * latency = std::getenv("MEMHUB_SIM_LATENCY_NS");
+  if (latency)
+    s_latencyNs = std::strtoull(latency, nullptr, 0);
+
+  // The environment is closed before returning, it must not stay open next to the one of the utils module
+  try {
+    auto env = lmdb::env::create();
+    env.set_mapsize(LMDB_SIZE);
+    env.open(path.c_str(), MDB_RDONLY, 0664);
+    auto rtxn = lmdb::txn::begin(env, nullptr, MDB_RDONLY);
+    auto dbi  = lmdb::dbi::open(rtxn, nullptr);
+    auto cursor = lmdb::cursor::open(rtxn, dbi);
+    lmdb::val key, value;
+    regDescriptor desc;
+    while (cursor.get(key, value, MDB_NEXT)) {
+      if (value.size() != sizeof(regDescriptor) || static_cast<uint8_t>(value.data()[0]) != REG_DESC_MAGIC)
+        continue;
+      std::memcpy(&desc, value.data(), sizeof(desc));
+      const uint32_t nWords = (desc.mode == REG_MODE_BLOCK && desc.size > 1) ? desc.size : 1;
+      for (uint32_t i = 0; i < nWords; ++i)
+        s_words[desc.address + 4*i];
+    }
+    cursor.close();
+
+    const char * config = std::getenv("MEMHUB_SIM_CONFIG");
+    if (config)
+      configure(rtxn, dbi, config);
+  } catch (const lmdb::error & e) {
+    LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to build the simulated register file from %s: %s", path.c_str(), e.what()));
+    return false;
+  }
+  LOGGER->log_message(LogManager::INFO, stdsprintf("Simulating %d register words from %s", static_cast<int>(s_words.size()), path.c_str()));
+  return true;
+}
+
+int memhub_sim_read(uint32_t addr, uint32_t words, uint32_t *data)
+{
+  wait();
+  for (uint32_t i = 0; i < words; ++i) {
+    simWord * w = word(addr + 4*i);
+    if (!w)
+      return -1;
+    data[i] = w->value;
+    for (auto & f : w->fields) {
+      if (f.behaviour == SIM_COUNTER) {
+        const uint32_t next = (((w->value & f.mask) >> f.shift) + f.arg) << f.shift;
+        w->value = (w->value & ~f.mask) | (next & f.mask);
+      } else if (f.behaviour == SIM_BUSY && f.remaining && --f.remaining == 0) {
+        w->value &= ~f.mask;
+      }
+    }
+  }
+  return 0;
+}
+
+int memhub_sim_write(uint32_t addr, uint32_t words, const uint32_t *data)
+{
+  wait();
+  for (uint32_t i = 0; i < words; ++i) {
+    const uint32_t address = addr + 4*i;
+    simWord * w = word(address);
+    if (!w)
+      return -1;
+    uint32_t value = (data[i] & ~w->readOnlyMask) | (w->value & w->readOnlyMask);
+    for (auto const& f : w->fields)
+      if (f.behaviour == SIM_STROBE)
+        value &= ~f.mask;
+    w->value = value;
+
+    auto triggers = s_triggers.equal_range(address);
+    for (auto t = triggers.first; t != triggers.second; ++t) {
+      if (!(data[i] & t->second.mask))
+        continue;
+      simWord & target = s_words[t->second.address];
+      simField & flag  = target.fields[t->second.field];
+      target.value  |= flag.mask;
+      flag.remaining = flag.arg;
+    }
+  }
+  return 0;
+}
+
+const char * memhub_sim_last_error()
+{
+  return s_error.c_str();
+}
+
+void memhub_sim_set_error(const char * error)
+{
+  s_error = error;
+}
@@ -30,6 +30,42 @@ void mwrite(const RPCMsg *request, RPCMsg *response) {
 	}
 }
 
+// 64-bit counters are split into the low word, under key, and the high word, under key_hi
+static void set_counter(RPCMsg *response, const std::string &key, uint64_t value) {
+	response->set_word(key, value & 0xFFFFFFFF);
+	response->set_word(key+"_hi", value >> 32);
+}
+
+// Histogram buckets saturate at 0xFFFFFFFF
+static void set_histogram(RPCMsg *response, const std::string &key, const uint64_t *hist) {
+	uint32_t data[MEMHUB_STATS_BUCKETS];
+	for (int i = 0; i < MEMHUB_STATS_BUCKETS; ++i)
+		data[i] = hist[i] > 0xFFFFFFFF ? 0xFFFFFFFF : hist[i];
+	response->set_word_array(key, data, MEMHUB_STATS_BUCKETS);
+}
+
+// Memhub lock and traffic statistics aggregated over all the client processes, see memhub.h
+void mstats(const RPCMsg *request, RPCMsg *response) {
+	struct memhub_stats stats;
+	if (memhub_get_stats(&stats) != 0) {
+		response->set_string("error", "memhub statistics are not available");
+		LOGGER->log_message(LogManager::ERROR, "memhub statistics are not available");
+		return;
+	}
+	response->set_string("backend", memhub_backend());
+	response->set_word("processes", stats.processes);
+	set_counter(response, "reads", stats.reads);
+	set_counter(response, "writes", stats.writes);
+	set_counter(response, "read_words", stats.read_words);
+	set_counter(response, "write_words", stats.write_words);
+	set_counter(response, "errors", stats.errors);
+	set_counter(response, "recoveries", stats.recoveries);
+	set_counter(response, "wait_ns", stats.wait_ns);
+	set_counter(response, "hold_ns", stats.hold_ns);
+	set_histogram(response, "wait_hist", stats.wait_hist);
+	set_histogram(response, "hold_hist", stats.hold_hist);
+}
+
 extern "C" {
 	const char *module_version_key = "memory v1.0.1";
 	int module_activity_color = 4;
@@ -41,5 +77,6 @@ extern "C" {
 		}
 		modmgr->register_method("memory", "read", mread);
 		modmgr->register_method("memory", "write", mwrite);
+		modmgr->register_method("memory", "stats", mstats);
 	}
 }
@@ -1,9 +1,10 @@
 #include "amc.h"
 #include "optohybrid.h"
 #include "hw_constants.h"
+#include "utils/static_regs.h"
 
 void broadcastWriteLocal(localArgs * la, uint32_t ohN, std::string regName, uint32_t value, uint32_t mask) {
-  uint32_t fw_maj = readReg(la, "GEM_AMC.GEM_SYSTEM.RELEASE.MAJOR");
+  uint32_t fw_maj = hwFwMajor(la);
   if (fw_maj == 1) {
     char regBase [100];
     sprintf(regBase, "GEM_AMC.OH.OH%i.GEB.Broadcast",ohN);
@@ -42,7 +43,7 @@ void broadcastWriteLocal(localArgs * la, uint32_t ohN, std::string regName, uint
 }
 
 void broadcastWrite(const RPCMsg *request, RPCMsg *response) {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   std::string regName = request->get_string("reg_name");
   uint32_t value = request->get_word("value");
@@ -50,11 +51,10 @@ void broadcastWrite(const RPCMsg *request, RPCMsg *response) {
   uint32_t ohN = request->get_word("ohN");
 
   broadcastWriteLocal(&la, ohN, regName, value, mask);
-  rtxn.abort();
 }
 
 void broadcastReadLocal(localArgs * la, uint32_t * outData, uint32_t ohN, std::string regName, uint32_t mask) {
-  uint32_t fw_maj = readReg(la, "GEM_AMC.GEM_SYSTEM.RELEASE.MAJOR");
+  uint32_t fw_maj = hwFwMajor(la);
   char regBase [100];
   if (fw_maj == 1) {
     sprintf(regBase,"GEM_AMC.OH.OH%i.GEB.VFATS.VFAT",ohN);
@@ -77,7 +77,7 @@ void broadcastReadLocal(localArgs * la, uint32_t * outData, uint32_t ohN, std::s
 }
 
 void broadcastRead(const RPCMsg *request, RPCMsg *response) {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   std::string regName = request->get_string("reg_name");
   uint32_t mask = request->get_key_exists("mask")?request->get_word("mask"):0xFF000000;
@@ -86,8 +86,6 @@ void broadcastRead(const RPCMsg *request, RPCMsg *response) {
   uint32_t outData[oh::VFATS_PER_OH];
   broadcastReadLocal(&la, outData, ohN, regName, mask);
   response->set_word_array("data", outData, oh::VFATS_PER_OH);
-
-  rtxn.abort();
 }
 
 // Set default values to VFAT parameters. VFATs will remain in sleep mode
@@ -164,15 +162,13 @@ void loadVT1Local(localArgs * la, uint32_t ohN, std::string config_file, uint32_
 }
 
 void loadVT1(const RPCMsg *request, RPCMsg *response) {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t ohN = request->get_word("ohN");
   std::string config_file = request->get_key_exists("thresh_config_filename")?request->get_string("thresh_config_filename"):"";
   uint32_t vt1 = request->get_key_exists("vt1")?request->get_word("vt1"):0x64;
 
   loadVT1Local(&la, ohN, config_file, vt1);
-
-  rtxn.abort();
 }
 
 void loadTRIMDACLocal(localArgs * la, uint32_t ohN, std::string config_file) {
@@ -197,17 +193,16 @@ void loadTRIMDACLocal(localArgs * la, uint32_t ohN, std::string config_file) {
 }
 
 void loadTRIMDAC(const RPCMsg *request, RPCMsg *response) {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t ohN = request->get_word("ohN");
   std::string config_file = request->get_string("trim_config_filename");//"/mnt/persistent/texas/test/chConfig_GEMINIm01L1.txt";
 
   loadTRIMDACLocal(&la, ohN, config_file);
-  rtxn.abort();
 }
 
 void configureVFATs(const RPCMsg *request, RPCMsg *response) {
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t ohN = request->get_word("ohN");
   std::string trim_config_file = request->get_string("trim_config_filename");//"/mnt/persistent/texas/test/chConfig_GEMINIm01L1.txt";
@@ -221,8 +216,6 @@ void configureVFATs(const RPCMsg *request, RPCMsg *response) {
   LOGGER->log_message(LogManager::INFO, "LOAD TRIM VFATS");
   loadTRIMDACLocal(&la, ohN, trim_config_file);
   if (request->get_key_exists("set_run")) setAllVFATsToRunModeLocal(&la, ohN);
-
-  rtxn.abort();
 }
 
 void configureScanModuleLocal(localArgs * la, uint32_t ohN, uint32_t vfatN, uint32_t scanmode, bool useUltra, uint32_t mask, uint32_t ch, uint32_t nevts, uint32_t dacMin, uint32_t dacMax, uint32_t dacStep){
@@ -255,19 +248,21 @@ void configureScanModuleLocal(localArgs * la, uint32_t ohN, uint32_t vfatN, uint
     // reset scan module
     writeRawReg(la, scanBase + ".RESET", 0x1);
 
-    // write scan parameters
-    writeReg(la, scanBase + ".CONF.MODE", scanmode);
+    // write scan parameters, coalescing the fields sharing a CONF word
+    writeBatch conf(la);
+    conf.writeReg(scanBase + ".CONF.MODE", scanmode);
     if (useUltra){
-        writeReg(la, scanBase + ".CONF.MASK", mask);
+        conf.writeReg(scanBase + ".CONF.MASK", mask);
     }
     else{
-        writeReg(la, scanBase + ".CONF.CHIP", vfatN);
+        conf.writeReg(scanBase + ".CONF.CHIP", vfatN);
     }
-    writeReg(la, scanBase + ".CONF.CHAN", ch);
-    writeReg(la, scanBase + ".CONF.NTRIGS", nevts);
-    writeReg(la, scanBase + ".CONF.MIN", dacMin);
-    writeReg(la, scanBase + ".CONF.MAX", dacMax);
-    writeReg(la, scanBase + ".CONF.STEP", dacStep);
+    conf.writeReg(scanBase + ".CONF.CHAN", ch);
+    conf.writeReg(scanBase + ".CONF.NTRIGS", nevts);
+    conf.writeReg(scanBase + ".CONF.MIN", dacMin);
+    conf.writeReg(scanBase + ".CONF.MAX", dacMax);
+    conf.writeReg(scanBase + ".CONF.STEP", dacStep);
+    conf.commit();
 
     return;
 } //End configureScanModuleLocal(...)
@@ -284,7 +279,7 @@ void configureScanModule(const RPCMsg *request, RPCMsg *response){
      *            for ULTRA scan, specify the VFAT mask
      */
 
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     //Get OH and scanmode
     uint32_t ohN = request->get_word("ohN");
@@ -310,8 +305,6 @@ void configureScanModule(const RPCMsg *request, RPCMsg *response){
 
 
     configureScanModuleLocal(&la, ohN, vfatN, scanmode, useUltra, mask, ch, nevts, dacMin, dacMax, dacStep);
-
-    rtxn.abort();
 } //End configureScanModule(...)
 
 void printScanConfigurationLocal(localArgs * la, uint32_t ohN, bool useUltra){
@@ -355,7 +348,7 @@ void printScanConfigurationLocal(localArgs * la, uint32_t ohN, bool useUltra){
 } //End printScanConfigurationLocal(...)
 
 void printScanConfiguration(const RPCMsg *request, RPCMsg *response){
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
     
     uint32_t ohN = request->get_word("ohN");
 
@@ -365,8 +358,6 @@ void printScanConfiguration(const RPCMsg *request, RPCMsg *response){
     }
 
     printScanConfigurationLocal(&la, ohN, useUltra);
-
-    rtxn.abort();
 } //End printScanConfiguration(...)
 
 void startScanModuleLocal(localArgs * la, uint32_t ohN, bool useUltra){
@@ -406,7 +397,7 @@ void startScanModuleLocal(localArgs * la, uint32_t ohN, bool useUltra){
 } //End startScanModuleLocal(...)
 
 void startScanModule(const RPCMsg *request, RPCMsg *response){
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
     
     uint32_t ohN = request->get_word("ohN");
 
@@ -416,8 +407,6 @@ void startScanModule(const RPCMsg *request, RPCMsg *response){
     }
 
     startScanModuleLocal(&la, ohN, useUltra);
-
-    rtxn.abort();
 } //End startScanModule(...)
 
 void getUltraScanResultsLocal(localArgs * la, uint32_t *outData, uint32_t ohN, uint32_t nevts, uint32_t dacMin, uint32_t dacMax, uint32_t dacStep){
@@ -482,7 +471,7 @@ void getUltraScanResultsLocal(localArgs * la, uint32_t *outData, uint32_t ohN, u
 } //End getUltraScanResultsLocal(...)
 
 void getUltraScanResults(const RPCMsg *request, RPCMsg *response){
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
     
     uint32_t ohN = request->get_word("ohN");
     uint32_t nevts = request->get_word("nevts");
@@ -493,13 +482,11 @@ void getUltraScanResults(const RPCMsg *request, RPCMsg *response){
     uint32_t outData[oh::VFATS_PER_OH*(dacMax-dacMin+1)/dacStep];
     getUltraScanResultsLocal(&la, outData, ohN, nevts, dacMin, dacMax, dacStep);
     response->set_word_array("data",outData,oh::VFATS_PER_OH*(dacMax-dacMin+1)/dacStep);
-
-    rtxn.abort();
 } //End getUltraScanResults(...)
 
 void stopCalPulse2AllChannelsLocal(localArgs *la, uint32_t ohN, uint32_t mask, uint32_t ch_min, uint32_t ch_max){
     //Get FW release
-    uint32_t fw_maj = readReg(la, "GEM_AMC.GEM_SYSTEM.RELEASE.MAJOR");
+    uint32_t fw_maj = hwFwMajor(la);
 
     if (fw_maj == 1) {
         uint32_t trimVal=0;
@@ -515,10 +502,12 @@ void stopCalPulse2AllChannelsLocal(localArgs *la, uint32_t ohN, uint32_t mask, u
             }
         }
     } else if (fw_maj == 3) {
+        STATIC_REGS_CHECK(la, );
+        REG_FAMILY(chanCalPulse, la, vfatChannelCalPulse, "GEM_AMC.OH.OH*.GEB.VFAT*.VFAT_CHANNELS.CHANNEL*.CALPULSE_ENABLE");
         for (unsigned int vfatN = 0; vfatN < oh::VFATS_PER_OH; vfatN++) {
             if ((mask >> vfatN) & 0x1) continue; //skip masked VFATs
             for (uint32_t chan=ch_min; chan<=ch_max; ++chan) {
-                writeReg(la, stdsprintf("GEM_AMC.OH.OH%d.GEB.VFAT%d.VFAT_CHANNELS.CHANNEL%d.CALPULSE_ENABLE", ohN, vfatN, chan), 0x0);
+                chanCalPulse.write(0x0, ohN, vfatN, chan);
             }
         }
     } else {
@@ -529,7 +518,7 @@ void stopCalPulse2AllChannelsLocal(localArgs *la, uint32_t ohN, uint32_t mask, u
 }
 
 void stopCalPulse2AllChannels(const RPCMsg *request, RPCMsg *response){
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
     
     uint32_t ohN = request->get_word("ohN");
     uint32_t mask = request->get_word("mask");
@@ -537,8 +526,6 @@ void stopCalPulse2AllChannels(const RPCMsg *request, RPCMsg *response){
     uint32_t ch_max = request->get_word("ch_max");
 
     stopCalPulse2AllChannelsLocal(&la, ohN, mask, ch_min, ch_max);
-
-    rtxn.abort();
 }
 
 void statusOHLocal(localArgs * la, uint32_t ohEnMask){
@@ -582,13 +569,12 @@ void statusOHLocal(localArgs * la, uint32_t ohEnMask){
 
 void statusOH(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohEnMask = request->get_word("ohEnMask");
     LOGGER->log_message(LogManager::INFO, "Reeading OH status");
 
     statusOHLocal(&la, ohEnMask);
-    rtxn.abort();
 }
 
 extern "C" {
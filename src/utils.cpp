@@ -1,131 +1,365 @@
 #include "utils.h"
+#include "utils/address_table.h"
+#include "utils/batch.h"
+#include "utils/lock_domains.h"
+#include "utils/reg_index.h"
+#include "utils/subtree.h"
+#include "utils/wait.h"
+
+#include <sys/stat.h>
+#include <climits>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
 
 memsvc_handle_t memsvc;
 
+namespace {
+  /*! \struct addressTableHandles
+   *  Process-wide LMDB handles shared by all the RPC calls served by this process
+   */
+  struct addressTableHandles {
+    lmdb::env env{nullptr};
+    lmdb::txn rtxn{nullptr};
+    lmdb::dbi dbi{0};
+    dev_t dev{0}; ///< device of the data file the environment was opened on
+    ino_t ino{0}; ///< inode of the data file the environment was opened on
+  };
+
+  addressTableHandles s_at;
+
+  /*! \class regDescriptorCache
+   *  Per-process open addressing hash table of register descriptors, keyed by register name.
+   *  Entries are copies of the descriptors, so they stay valid across transaction renewals, and the whole
+   *  table is dropped whenever the generation stored in the address table changes.
+   */
+  class regDescriptorCache {
+  public:
+    regDescriptorCache() : m_slots(1024), m_count(0), m_generation(0) {}
+
+    const regDescriptor* find(const char* name, size_t len, uint64_t hash) const
+    {
+      const size_t mask = m_slots.size() - 1;
+      for (size_t i = hash & mask; m_slots[i].used; i = (i + 1) & mask) {
+        const slot& s = m_slots[i];
+        if (s.hash == hash && s.nameLen == len && std::memcmp(&m_names[s.nameOff], name, len) == 0)
+          return &s.desc;
+      }
+      return nullptr;
+    }
+
+    const regDescriptor* insert(const char* name, size_t len, uint64_t hash, const regDescriptor& desc)
+    {
+      if (2 * (m_count + 1) > m_slots.size())
+        grow();
+      const uint32_t off = m_names.size();
+      m_names.insert(m_names.end(), name, name + len);
+      return &place(hash, off, len, desc).desc;
+    }
+
+    uint64_t generation() const { return m_generation; }
+
+    void clear(uint64_t generation)
+    {
+      std::fill(m_slots.begin(), m_slots.end(), slot());
+      m_names.clear();
+      m_count      = 0;
+      m_generation = generation;
+    }
+
+  private:
+    struct slot {
+      uint64_t      hash{0};
+      uint32_t      nameOff{0};
+      uint32_t      nameLen{0};
+      bool          used{false};
+      regDescriptor desc;
+    };
+
+    slot& place(uint64_t hash, uint32_t off, uint32_t len, const regDescriptor& desc)
+    {
+      const size_t mask = m_slots.size() - 1;
+      size_t i = hash & mask;
+      while (m_slots[i].used)
+        i = (i + 1) & mask;
+      slot& s   = m_slots[i];
+      s.hash    = hash;
+      s.nameOff = off;
+      s.nameLen = len;
+      s.used    = true;
+      s.desc    = desc;
+      ++m_count;
+      return s;
+    }
+
+    void grow()
+    {
+      std::vector<slot> old(2 * m_slots.size());
+      old.swap(m_slots);
+      m_count = 0;
+      for (auto const& s : old)
+        if (s.used)
+          place(s.hash, s.nameOff, s.nameLen, s.desc);
+    }
+
+    std::vector<slot> m_slots; ///< power of two sized
+    std::vector<char> m_names; ///< arena holding the key strings
+    size_t            m_count;
+    uint64_t          m_generation;
+  };
+
+  regDescriptorCache s_descCache;
+
+  /*! FNV-1a hash of the register name */
+  inline uint64_t regNameHash(const char* name, size_t len)
+  {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+      hash ^= static_cast<uint8_t>(name[i]);
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
+
+  std::string addressTablePath()
+  {
+    const char* gem_path = std::getenv("GEM_PATH");
+    return std::string(gem_path ? gem_path : ".") + "/" + ADDRESS_TABLE_LINK;
+  }
+}
+
+void closeLocalArgs()
+{
+  s_at.dbi  = lmdb::dbi{0};
+  s_at.rtxn = lmdb::txn{nullptr};
+  s_at.env  = lmdb::env{nullptr};
+  s_at.dev  = 0;
+  s_at.ino  = 0;
+  s_descCache.clear(0);
+}
+
 struct localArgs getLocalArgs(RPCMsg *response)
 {
-  auto env = lmdb::env::create();
-  env.set_mapsize(LMDB_SIZE);
-  std::string gem_path       = std::getenv("GEM_PATH");
-  std::string lmdb_data_file = gem_path+"/address_table.mdb";
-  env.open(lmdb_data_file.c_str(), 0, 0664);
-  auto rtxn = lmdb::txn::begin(env, nullptr, MDB_RDONLY);
-  auto dbi  = lmdb::dbi::open(rtxn, nullptr);
-  struct localArgs la = {.rtxn     = rtxn,
-                         .dbi      = dbi,
-                         .response = response};
+  const std::string lmdb_area_file = addressTablePath();
+  struct stat st;
+  if (s_at.env.handle() && (::stat((lmdb_area_file+"/data.mdb").c_str(), &st) != 0 || st.st_dev != s_at.dev || st.st_ino != s_at.ino)) {
+    // address table was regenerated, the mapping we hold is stale
+    LOGGER->log_message(LogManager::INFO, "Address table changed on disk, reopening LMDB environment");
+    closeLocalArgs();
+  }
+
+  if (!s_at.env.handle()) {
+    // stat before opening: if the link is switched in between, the next call sees the change and reopens
+    if (::stat((lmdb_area_file+"/data.mdb").c_str(), &st) != 0)
+      st.st_dev = st.st_ino = 0;
+    auto env = lmdb::env::create();
+    env.set_mapsize(LMDB_SIZE);
+    env.open(lmdb_area_file.c_str(), 0, 0664);
+    auto rtxn = lmdb::txn::begin(env, nullptr, MDB_RDONLY);
+    auto dbi  = lmdb::dbi::open(rtxn, nullptr);
+    s_at.dev  = st.st_dev;
+    s_at.ino  = st.st_ino;
+    s_at.env  = std::move(env);
+    s_at.rtxn = std::move(rtxn);
+    s_at.dbi  = std::move(dbi);
+  } else {
+    // recycle the reader slot, but take a fresh snapshot for this call
+    s_at.rtxn.reset();
+    try {
+      s_at.rtxn.renew();
+    } catch (const lmdb::error& e) {
+      // e.g. MDB_MAP_RESIZED, the table grew past our map in an incremental update
+      LOGGER->log_message(LogManager::INFO, stdsprintf("Reopening LMDB environment: %s", e.what()));
+      closeLocalArgs();
+      return getLocalArgs(response);
+    }
+  }
+
+  const uint64_t generation = readGeneration(s_at.rtxn, s_at.dbi);
+  if (generation != s_descCache.generation())
+    s_descCache.clear(generation);
+
+  struct localArgs la = {.rtxn     = s_at.rtxn,
+                         .dbi      = s_at.dbi,
+                         .response = response,
+                         .reporter = regErrorReporter(response),
+                         .hw       = hwContext()};
   return la;
 }
 
-std::vector<std::string> split(const std::string &s, char delim)
+const char * regPermString(uint8_t perm)
+{
+  static const char* const names[] = {"", "r", "w", "rw"};
+  return names[perm & (REG_PERM_READ | REG_PERM_WRITE)];
+}
+
+const char * regModeString(uint8_t mode)
+{
+  static const char* const names[] = {"single", "block", "fifo", "incremental", "port"};
+  return (mode <= REG_MODE_PORT) ? names[mode] : "unknown";
+}
+
+const regDescriptor * decodeRegDescriptor(const lmdb::val & db_res)
+{
+  const char* raw = db_res.data();
+  const size_t len = db_res.size();
+  if (len == sizeof(regDescriptor) && static_cast<uint8_t>(raw[0]) == REG_DESC_MAGIC) {
+    const regDescriptor* desc = reinterpret_cast<const regDescriptor*>(raw);
+    if (desc->version == REG_DESC_VERSION)
+      return desc;
+    LOGGER->log_message(LogManager::ERROR, stdsprintf("Unsupported register descriptor version %d", desc->version));
+    return nullptr;
+  }
+
+  // Legacy text format: addr|perm|mask|mode|size, all numbers in hex
+  static thread_local regDescriptor legacy;
+  char buf[128];
+  if (len == 0 || len >= sizeof(buf))
+    return nullptr;
+  std::memcpy(buf, raw, len);
+  buf[len] = '\0';
+
+  const char* field[5];
+  size_t flen[5];
+  size_t nfields = 0;
+  const char* start = buf;
+  for (char* c = buf; nfields < 5; ++c) {
+    if (*c == '|' || *c == '\0') {
+      field[nfields]  = start;
+      flen[nfields++] = c - start;
+      if (*c == '\0')
+        break;
+      start = c + 1;
+    }
+  }
+  if (nfields != 5)
+    return nullptr;
+
+  legacy = regDescriptor{};
+  legacy.magic   = REG_DESC_MAGIC;
+  legacy.version = REG_DESC_VERSION;
+  legacy.address = std::strtoul(field[0], nullptr, 16);
+  legacy.perm    = regPermFromString(field[1], flen[1]);
+  legacy.mask    = std::strtoul(field[2], nullptr, 16);
+  legacy.mode    = regModeFromString(field[3], flen[3]);
+  legacy.size    = std::strtoul(field[4], nullptr, 16);
+  legacy.shift   = regMaskShift(legacy.mask);
+  return &legacy;
+}
+
+uint64_t addressTableGeneration()
 {
-  std::vector<std::string> elems;
-  split(s, delim, std::back_inserter(elems));
-  return elems;
+  return s_descCache.generation();
 }
 
-std::string serialize(xhal::utils::Node n)
+const regDescriptor * getRegDescriptor(localArgs * la, const std::string & regName)
 {
-  std::stringstream node;
-  node << std::hex << n.real_address << std::dec
-       << "|" << n.permission
-       << "|" << std::hex << n.mask << std::dec
-       << "|" << n.mode
-       << "|" << std::hex << n.size << std::dec;
-  return node.str();
+  if (const regIndex* index = getRegIndex(la)) {
+    const uint32_t id = index->find(regName);
+    return (id != REG_ID_INVALID) ? &index->descriptor(id) : nullptr;
+  }
+
+  const uint64_t hash = regNameHash(regName.data(), regName.size());
+  if (const regDescriptor* cached = s_descCache.find(regName.data(), regName.size(), hash))
+    return cached;
+
+  lmdb::val key, db_res;
+  key.assign(regName);
+  if (!la->dbi.get(la->rtxn,key,db_res))
+    return nullptr;
+  const regDescriptor* desc = decodeRegDescriptor(db_res);
+  if (!desc)
+    return nullptr;
+  return s_descCache.insert(regName.data(), regName.size(), hash, *desc);
 }
 
 void update_address_table(const RPCMsg *request, RPCMsg *response)
 {
   LOGGER->log_message(LogManager::INFO, "START UPDATE ADDRESS TABLE");
+  const auto start = std::chrono::steady_clock::now();
   std::string at_xml = request->get_string("at_xml");
   std::string gem_path = std::getenv("GEM_PATH");
-  std::string lmdb_data_file = gem_path+"/address_table.mdb/data.mdb";
-  std::string lmdb_lock_file = gem_path+"/address_table.mdb/lock.mdb";
-  std::string lmdb_area_file = gem_path+"/address_table.mdb";
+  const bool incremental = request->get_key_exists("incremental") && request->get_word("incremental");
   xhal::utils::XHALXMLParser * m_parser = new xhal::utils::XHALXMLParser(at_xml.c_str());
   try {
     m_parser->setLogLevel(0);
     m_parser->parseXML();
   } catch (...) {
+    delete m_parser;
     response->set_string("error", "XML parser failed");
     LOGGER->log_message(LogManager::INFO, "XML parser failed");
     return;
   }
+  const auto parsed = std::chrono::steady_clock::now();
   LOGGER->log_message(LogManager::INFO, "XML PARSING DONE");
   std::unordered_map<std::string,xhal::utils::Node> m_parsed_at;
   m_parsed_at = m_parser->getAllNodes();
   m_parsed_at.erase("top");
-  xhal::utils::Node t_node;
-
-  // Remove old DB
-  LOGGER->log_message(LogManager::INFO, "REMOVE OLD DB");
-  std::remove(lmdb_data_file.c_str());
-  std::remove(lmdb_lock_file.c_str());
-
-  auto env = lmdb::env::create();
-  env.set_mapsize(LMDB_SIZE);
-  env.open(lmdb_area_file.c_str(), 0, 0664);
-
-  LOGGER->log_message(LogManager::INFO, "LMDB ENV OPEN");
-
-  lmdb::val key;
-  lmdb::val value;
-  auto wtxn = lmdb::txn::begin(env);
-  auto dbi  = lmdb::dbi::open(wtxn, nullptr);
-
-  LOGGER->log_message(LogManager::INFO, "START ITERATING OVER MAP");
-
-  std::string t_key;
-  std::string t_value;
-  for (auto it:m_parsed_at) {
-    t_key = it.first;
-    t_node = it.second;
-    t_value = serialize(t_node);
-    key.assign(t_key);
-    value.assign(t_value);
-    dbi.put(wtxn, key, value);
+  delete m_parser; // the parsed document is no longer needed, free it before the import
+
+  // Release our own handles on the current DB, an environment must not be opened twice in the same process
+  closeLocalArgs();
+
+  addressTableUpdate update;
+  std::string error;
+  const bool done = incremental ? patchAddressTable(m_parsed_at, gem_path, update, error)
+                                : buildAddressTable(m_parsed_at, gem_path, update, error);
+  if (!done) {
+    response->set_string("error", error);
+    LOGGER->log_message(LogManager::ERROR, error);
+    return;
   }
-  wtxn.commit();
-  LOGGER->log_message(LogManager::INFO, "COMMIT DB");
-  wtxn.abort();
+  const auto imported = std::chrono::steady_clock::now();
+  const uint32_t parseTime  = std::chrono::duration_cast<std::chrono::milliseconds>(parsed - start).count();
+  const uint32_t importTime = std::chrono::duration_cast<std::chrono::milliseconds>(imported - parsed).count();
+  LOGGER->log_message(LogManager::INFO, stdsprintf("ADDRESS TABLE PARSED IN %u ms, IMPORTED IN %u ms, DB SIZE %llu BYTES",
+                                                   parseTime, importTime, static_cast<unsigned long long>(update.dbSize)));
+  LOGGER->log_message(LogManager::INFO, stdsprintf("ADDRESS TABLE GENERATION %llu: %d NODES, %d RECORDS WRITTEN, %d REMOVED, %d REGISTER FAMILIES INDEXED",
+                                                   static_cast<unsigned long long>(update.generation), static_cast<int>(update.nNodes),
+                                                   static_cast<int>(update.nWritten), static_cast<int>(update.nRemoved),
+                                                   static_cast<int>(update.nFamilies)));
+  if (update.nRegs)
+    LOGGER->log_message(LogManager::INFO, stdsprintf("%d REGISTER IDS ASSIGNED", static_cast<int>(update.nRegs)));
+  else
+    LOGGER->log_message(LogManager::WARNING, "Unable to write the register index, ID based methods are disabled");
+  response->set_word("generation", static_cast<uint32_t>(update.generation));
+  response->set_word("nodes",      update.nNodes);
+  response->set_word("written",    update.nWritten);
+  response->set_word("removed",    update.nRemoved);
+  response->set_word("parse_time",  parseTime);
+  response->set_word("import_time", importTime);
+  response->set_word("db_size",     static_cast<uint32_t>(std::min<uint64_t>(update.dbSize, 0xFFFFFFFF)));
+
+  // The running clients keep the domains published in /dev/shm/memhub until it is removed
+  size_t nDomains = buildLockDomains(m_parsed_at, gem_path+"/"+MEMHUB_DOMAINS_FILE);
+  if (nDomains)
+    LOGGER->log_message(LogManager::INFO, stdsprintf("%d MEMHUB LOCK DOMAINS WRITTEN", static_cast<int>(nDomains)));
+  else
+    LOGGER->log_message(LogManager::WARNING, "Unable to write the memhub lock domains");
 }
 
 void readRegFromDB(const RPCMsg *request, RPCMsg *response)
 {
   std::string regName = request->get_string("reg_name");
 
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
-  LOGGER->log_message(LogManager::INFO, "LMDB ENV OPEN");
-  lmdb::val key;
-  lmdb::val value;
-
-  key.assign(regName.c_str());
-  bool found = dbi.get(rtxn,key,value);
-  if (found) {
+  const regDescriptor* desc = getRegDescriptor(&la, regName);
+  if (desc) {
     LOGGER->log_message(LogManager::INFO, stdsprintf("Key: %s is found", regName.c_str()));
-    std::string t_value = std::string(value.data());
-    t_value = t_value.substr(0,value.size());
-    std::vector<std::string> tmp = split(t_value,'|');
-    uint32_t raddr = stoull(tmp[0], nullptr, 16);
-    uint32_t rmask = stoull(tmp[2], nullptr, 16);
-    uint32_t rsize = stoull(tmp[4], nullptr, 16);
-    std::string rperm = tmp[1];
-    std::string rmode = tmp[3];
     LOGGER->log_message(LogManager::DEBUG, stdsprintf("node %s properties: 0x%x  0x%x  0x%x  %s  %s",
-                                                      regName.c_str(), raddr, rmask, rsize, rmode.c_str(), rperm.c_str()));
-
-    response->set_string("permissions", rperm);
-    response->set_string("mode",        rmode);
-    response->set_word("address",       raddr);
-    response->set_word("mask",          rmask);
-    response->set_word("size",          rsize);
+                                                      regName.c_str(), desc->address, desc->mask, desc->size,
+                                                      regModeString(desc->mode), regPermString(desc->perm)));
+
+    response->set_string("permissions", regPermString(desc->perm));
+    response->set_string("mode",        regModeString(desc->mode));
+    response->set_word("address",       desc->address);
+    response->set_word("mask",          desc->mask);
+    response->set_word("size",          desc->size);
   } else {
     LOGGER->log_message(LogManager::ERROR, stdsprintf("Key: %s is NOT found", regName.c_str()));
     response->set_string("error", "Register not found");
   }
-  rtxn.abort();
 }
 
 uint32_t getNumNonzeroBits(uint32_t value)
@@ -143,38 +377,26 @@ uint32_t getNumNonzeroBits(uint32_t value)
 
 uint32_t getMask(localArgs * la, const std::string & regName)
 {
-  lmdb::val key, db_res;
-  bool found=false;
-  key.assign(regName.c_str());
-  found = la->dbi.get(la->rtxn,key,db_res);
-  uint32_t rmask = 0x0;
-  if (found) {
-    std::string t_db_res = std::string(db_res.data());
-    t_db_res = t_db_res.substr(0,db_res.size());
-    std::vector<std::string> tmp = split(t_db_res,'|');
-    rmask = stoull(tmp[2], nullptr, 16);
-  } else {
-    LOGGER->log_message(LogManager::ERROR, stdsprintf("Key: %s is NOT found", regName.c_str()));
-    la->response->set_string("error", "Register not found");
+  const regDescriptor* desc = getRegDescriptor(la, regName);
+  if (!desc) {
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
+    return 0x0;
   }
-  return rmask;
+  return desc->mask;
 }
 
 void writeRawAddress(uint32_t address, uint32_t value, RPCMsg *response)
 {
   uint32_t data[] = {value};
-  if (memhub_write(memsvc, address, 1, data) != 0) {
-    response->set_string("error", std::string("memsvc error: ")+memsvc_get_last_error(memsvc));
-    LOGGER->log_message(LogManager::INFO, stdsprintf("write memsvc error: %s", memsvc_get_last_error(memsvc)));
-  }
+  if (memhub_write(memsvc, address, 1, data) != 0)
+    regErrors().push(REG_ERR_WRITE, nullptr, 0, address, true, 1);
 }
 
 uint32_t readRawAddress(uint32_t address, RPCMsg* response)
 {
   uint32_t data[1];
   if (memhub_read(memsvc, address, 1, data) != 0) {
-    response->set_string("error", std::string("memsvc error: ")+memsvc_get_last_error(memsvc));
-    LOGGER->log_message(LogManager::ERROR, stdsprintf("read memsvc error: %s", memsvc_get_last_error(memsvc)));
+    regErrors().push(REG_ERR_READ, nullptr, 0, address, true, 1);
     return 0xdeaddead;
   }
   return data[0];
@@ -182,88 +404,81 @@ uint32_t readRawAddress(uint32_t address, RPCMsg* response)
 
 uint32_t getAddress(localArgs * la, const std::string & regName)
 {
-  lmdb::val key, db_res;
-  bool found;
-  key.assign(regName.c_str());
-  found = la->dbi.get(la->rtxn,key,db_res);
-  uint32_t raddr;
-  if (found){
-    std::string t_db_res = std::string(db_res.data());
-    t_db_res = t_db_res.substr(0,db_res.size());
-    std::vector<std::string> tmp = split(t_db_res,'|');
-    raddr = stoull(tmp[0], nullptr, 16);
-  } else {
-    LOGGER->log_message(LogManager::ERROR, stdsprintf("Key: %s is NOT found", regName.c_str()));
-    la->response->set_string("error", "Register not found");
+  const regDescriptor* desc = getRegDescriptor(la, regName);
+  if (!desc) {
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
     return 0xdeaddead;
   }
-  return raddr;
+  return desc->address;
+}
+
+namespace {
+  const std::string s_noName;
+
+  void writeDescAddress(const regDescriptor* desc, const std::string & regName, uint32_t value)
+  {
+    uint32_t data[] = {value};
+    if (memhub_write(memsvc, desc->address, 1, data) != 0)
+      regErrors().push(REG_ERR_WRITE, regName, desc->address, true, 1);
+  }
+
+  regError readDescAddress(const regDescriptor* desc, const std::string & regName, uint32_t & value)
+  {
+    static constexpr uint32_t N_TRIES = 10;
+    uint32_t data[1];
+    for (uint32_t n_tries = 1; n_tries <= N_TRIES; ++n_tries) {
+      if (memhub_read(memsvc, desc->address, 1, data) == 0) {
+        if (n_tries > 1)
+          regErrors().push(REG_ERR_READ_RETRIED, regName, desc->address, false, n_tries - 1);
+        value = data[0];
+        return REG_OK;
+      }
+    }
+    regErrors().push(REG_ERR_READ, regName, desc->address, true, 1);
+    return REG_ERR_READ;
+  }
 }
 
 void writeAddress(lmdb::val & db_res, uint32_t value, RPCMsg *response)
 {
-  std::string t_db_res = std::string(db_res.data());
-  t_db_res = t_db_res.substr(0,db_res.size());
-  std::vector<std::string> tmp = split(t_db_res,'|');
-  uint32_t data[1];
-  uint32_t raddr = stoull(tmp[0], nullptr, 16);
-  data[0] = value;
-  if (memhub_write(memsvc, raddr, 1, data) != 0) {
-    response->set_string("error", std::string("memsvc error: ")+memsvc_get_last_error(memsvc));
-    LOGGER->log_message(LogManager::INFO, stdsprintf("write memsvc error: %s", memsvc_get_last_error(memsvc)));
+  const regDescriptor* desc = decodeRegDescriptor(db_res);
+  if (!desc) {
+    regErrors().push(REG_ERR_MALFORMED, nullptr, 0, 0, true);
+    return;
   }
+  writeDescAddress(desc, s_noName, value);
 }
 
 uint32_t readAddress(lmdb::val & db_res, RPCMsg *response)
 {
-  std::string t_db_res = std::string(db_res.data());
-  t_db_res = t_db_res.substr(0,db_res.size());
-  std::vector<std::string> tmp = split(t_db_res,'|');
-  uint32_t data[1];
-  uint32_t raddr = stoull(tmp[0], nullptr, 16);
-  int n_current_tries = 0;
-  while (true) {
-    if (memhub_read(memsvc, raddr, 1, data) != 0) {
-      if (n_current_tries < 9) {
-        n_current_tries++;
-        LOGGER->log_message(LogManager::ERROR, stdsprintf("Reading reg %08X failed %i times.", raddr, n_current_tries));
-      } else {
-        response->set_string("error", std::string("memsvc error: ")+memsvc_get_last_error(memsvc));
-        LOGGER->log_message(LogManager::ERROR, stdsprintf("read memsvc error: %s failed 10 times", memsvc_get_last_error(memsvc)));
-        return 0xdeaddead;
-      }
-    } else {
-      break;
-    }
+  const regDescriptor* desc = decodeRegDescriptor(db_res);
+  if (!desc) {
+    regErrors().push(REG_ERR_MALFORMED, nullptr, 0, 0, true);
+    return 0xdeaddead;
   }
-  return data[0];
+  uint32_t value = 0xdeaddead;
+  readDescAddress(desc, s_noName, value);
+  return value;
 }
 
 void writeRawReg(localArgs * la, const std::string & regName, uint32_t value)
 {
-  lmdb::val key, db_res;
-  key.assign(regName.c_str());
-  bool found = la->dbi.get(la->rtxn,key,db_res);
-  if (found) {
-    writeAddress(db_res, value, la->response);
-  } else {
-    LOGGER->log_message(LogManager::ERROR, stdsprintf("Key: %s is NOT found", regName.c_str()));
-    la->response->set_string("error", "Register not found");
-  }
+  const regDescriptor* desc = getRegDescriptor(la, regName);
+  if (desc)
+    writeDescAddress(desc, regName, value);
+  else
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
 }
 
 uint32_t readRawReg(localArgs * la, const std::string & regName)
 {
-  lmdb::val key, db_res;
-  key.assign(regName.c_str());
-  bool found = la->dbi.get(la->rtxn,key,db_res);
-  if (found) {
-    return readAddress(db_res, la->response);
-  } else {
-    LOGGER->log_message(LogManager::ERROR, stdsprintf("Key: %s is NOT found", regName.c_str()));
-    la->response->set_string("error", "Register not found");
-    return 0xdeaddead;
-  }
+  uint32_t value = 0xdeaddead;
+  const regDescriptor* desc = getRegDescriptor(la, regName);
+  if (desc)
+    readDescAddress(desc, regName, value);
+  else
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
+  return value;
 }
 
 uint32_t applyMask(uint32_t data, uint32_t mask)
@@ -280,106 +495,200 @@ uint32_t applyMask(uint32_t data, uint32_t mask)
   return result;
 }
 
+regError readReg(localArgs * la, const std::string & regName, uint32_t & value)
+{
+  // failures are not reported in "error", callers check the returned code or 0xdeaddead
+  const regDescriptor* desc = getRegDescriptor(la, regName);
+  if (!desc) {
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, false);
+    return REG_ERR_NOT_FOUND;
+  }
+  if (!(desc->perm & REG_PERM_READ)) {
+    regErrors().push(REG_ERR_NO_READ_PERM, regName, desc->address, false, desc->perm);
+    return REG_ERR_NO_READ_PERM;
+  }
+  uint32_t data[1];
+  if (memhub_read(memsvc, desc->address, 1, data) != 0) {
+    regErrors().push(REG_ERR_READ, regName, desc->address, false, 1);
+    return REG_ERR_READ;
+  }
+  if (desc->mask!=0xFFFFFFFF) {
+    value = (data[0] & desc->mask) >> desc->shift;
+  } else {
+    value = data[0];
+  }
+  return REG_OK;
+}
+
 uint32_t readReg(localArgs * la, const std::string & regName)
 {
-  lmdb::val key, db_res;
-  key.assign(regName.c_str());
-  bool found = la->dbi.get(la->rtxn,key,db_res);
-  if (found) {
-    std::string t_db_res = std::string(db_res.data());
-    t_db_res = t_db_res.substr(0,db_res.size());
-    std::vector<std::string> tmp = split(t_db_res,'|');
-    std::size_t found = tmp[1].find_first_of("r");
-    if (found==std::string::npos) {
-      // response->set_string("error", std::string("No read permissions"));
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("No read permissions for %s: %s", regName.c_str(), tmp[1].c_str()));
-      return 0xdeaddead;
+  uint32_t value = 0xdeaddead;
+  readReg(la, regName, value);
+  return value;
+}
+
+namespace {
+  struct regRead {
+    uint32_t address;
+    uint32_t mask;
+    uint8_t  shift;
+    size_t   index;
+  };
+
+  /*! Reads the registers sorted by address, runs of adjacent addresses with a single memhub transaction */
+  uint32_t readCoalesced(std::vector<regRead> & reads, uint32_t * result, uint32_t maxGap)
+  {
+    std::sort(reads.begin(), reads.end(), [](const regRead& a, const regRead& b) { return a.address < b.address; });
+
+    // AXI addresses are byte addresses of 32-bit words
+    const uint32_t maxStep = 4 * (maxGap + 1);
+    uint32_t nTransactions = 0;
+    std::vector<uint32_t> block;
+    memhubTransaction transaction;
+    for (size_t first = 0; first < reads.size(); ) {
+      size_t last = first;
+      while (last+1 < reads.size() && (reads[last+1].address - reads[last].address) <= maxStep)
+        ++last;
+
+      const uint32_t base   = reads[first].address;
+      const uint32_t nWords = (reads[last].address - base) / 4 + 1;
+      block.resize(nWords);
+      ++nTransactions;
+      if (memhub_read(memsvc, base, nWords, block.data()) != 0) {
+        regErrors().push(REG_ERR_READ, nullptr, 0, base, false, nWords);
+        for (size_t r = first; r <= last; ++r)
+          result[reads[r].index] = 0xdeaddead;
+      } else {
+        for (size_t r = first; r <= last; ++r) {
+          const uint32_t data = block[(reads[r].address - base) / 4];
+          result[reads[r].index] = (reads[r].mask != 0xFFFFFFFF) ? ((data & reads[r].mask) >> reads[r].shift) : data;
+        }
+      }
+      first = last+1;
     }
-    uint32_t data[1];
-    uint32_t raddr = stoull(tmp[0], nullptr, 16);
-    uint32_t rmask = stoull(tmp[2], nullptr, 16);
-    if (memhub_read(memsvc, raddr, 1, data) != 0) {
-      // response->set_string("error", std::string("memsvc error: ")+memsvc_get_last_error(memsvc));
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("read memsvc error: %s", memsvc_get_last_error(memsvc)));
-      return 0xdeaddead;
+    return nTransactions;
+  }
+}
+
+uint32_t readRegs(localArgs * la, const std::vector<std::string> & regNames, uint32_t * result, uint32_t maxGap)
+{
+  std::vector<regRead> reads;
+  reads.reserve(regNames.size());
+  for (size_t i = 0; i < regNames.size(); ++i) {
+    const regDescriptor* desc = getRegDescriptor(la, regNames[i]);
+    if (!desc) {
+      regErrors().push(REG_ERR_NOT_FOUND, regNames[i], 0, false);
+      result[i] = 0xdeaddead;
+    } else if (!(desc->perm & REG_PERM_READ)) {
+      regErrors().push(REG_ERR_NO_READ_PERM, regNames[i], desc->address, false, desc->perm);
+      result[i] = 0xdeaddead;
+    } else {
+      reads.push_back({desc->address, desc->mask, desc->shift, i});
     }
-    if (rmask!=0xFFFFFFFF) {
-      return applyMask(data[0],rmask);
+  }
+  return readCoalesced(reads, result, maxGap);
+}
+
+uint32_t readRegs(localArgs * la, const std::vector<regDescriptor> & descs, uint32_t * result, uint32_t maxGap)
+{
+  std::vector<regRead> reads;
+  reads.reserve(descs.size());
+  for (size_t i = 0; i < descs.size(); ++i) {
+    if (!(descs[i].perm & REG_PERM_READ)) {
+      regErrors().push(REG_ERR_NO_READ_PERM, nullptr, 0, descs[i].address, false, descs[i].perm);
+      result[i] = 0xdeaddead;
     } else {
-      return data[0];
+      reads.push_back({descs[i].address, descs[i].mask, descs[i].shift, i});
     }
-  } else {
-    // response->set_string("error", "Register not found");
-    LOGGER->log_message(LogManager::ERROR, stdsprintf("Key: %s is NOT found", regName.c_str()));
-    return 0xdeaddead;
   }
+  return readCoalesced(reads, result, maxGap);
 }
 
 uint32_t readBlock(localArgs* la, const std::string& regName, uint32_t* result, const uint32_t& size, const uint32_t& offset)
 {
-  lmdb::val key, db_res;
-  key.assign(regName.c_str());
-  bool found = la->dbi.get(la->rtxn,key,db_res);
-  if (found) {
-    std::string t_db_res = std::string(db_res.data());
-    t_db_res = t_db_res.substr(0,db_res.size());
-    std::vector<std::string> tmp = split(t_db_res,'|');
-    uint32_t raddr = stoull(tmp[0], nullptr, 16);
-    uint32_t rmask = stoull(tmp[2], nullptr, 16);
-    uint32_t rsize = stoull(tmp[4], nullptr, 16);
-    std::string rperm = tmp[1];
-    std::string rmode = tmp[3];
-    LOGGER->log_message(LogManager::DEBUG, stdsprintf("node %s properties: 0x%x  0x%x  0x%x  %s  %s",
-                                                      regName.c_str(), raddr, rmask, rsize, rmode.c_str(), rperm.c_str()));
+  const regDescriptor* desc = getRegDescriptor(la, regName);
+  if (desc) {
+    const uint32_t raddr = desc->address;
+    const uint32_t rmask = desc->mask;
+    const uint32_t rsize = desc->size;
 
     if (rmask != 0xFFFFFFFF) {
       // deny block read on masked register, but what if mask is None?
-      std::stringstream errmsg;
-      errmsg << "Block read attempted on masked register";
-      la->response->set_string("error", errmsg.str());
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("block read error: %s", errmsg.str().c_str()));
-      // throw std::range_error(errmsg.str());
-    } else if (rmode.rfind("single") != std::string::npos && size > 1) {
+      regErrors().push(REG_ERR_MASKED_BLOCK, regName, raddr, true);
+    } else if (desc->mode == REG_MODE_SINGLE && size > 1) {
       // only allow block read of size 1 on single registers?
-      std::stringstream errmsg;
-      errmsg << "Block read attempted on single register with size greater than 1";
-      la->response->set_string("error", errmsg.str());
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("block read error: %s", errmsg.str().c_str()));
-      // throw std::range_error(errmsg.str());
+      regErrors().push(REG_ERR_SINGLE_BLOCK, regName, raddr, true);
     } else if ((offset+size) > rsize) {
       // don't allow the read to go beyond the range
-      std::stringstream errmsg;
-      errmsg << "Block read attempted would go beyond the size of the RAM: "
-             << "raddr: 0x"    << std::hex << raddr
-             << ", offset: 0x" << std::hex << offset
-             << ", size: 0x"   << std::hex << size
-             << ", rsize: 0x"  << std::hex << rsize;
-      la->response->set_string("error", errmsg.str());
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("block read error: %s", errmsg.str().c_str()));
-      // throw std::range_error(errmsg.str());
-    } else {
-      if (memhub_read(memsvc, raddr+offset, size, result) != 0) {
-        std::stringstream errmsg;
-        errmsg << "Read memsvc error: " << memsvc_get_last_error(memsvc);
-        la->response->set_string("error", errmsg.str());
-        LOGGER->log_message(LogManager::ERROR, stdsprintf("readBlock: %s", errmsg.str().c_str()));
-        // throw std::runtime_error(errmsg.str());
-      } else {
-        std::stringstream msg;
-        msg << "Block read succeeded.";
-        la->response->set_string("debug", msg.str());
-        LOGGER->log_message(LogManager::DEBUG, stdsprintf("readBlock: %s", msg.str().c_str()));
-      }
+      regErrors().push(REG_ERR_BLOCK_RANGE, regName, raddr, true, offset, size, rsize);
+    } else if (memhub_read(memsvc, raddr + 4*offset, size, result) != 0) {
+      regErrors().push(REG_ERR_READ, regName, raddr, true, size);
     }
     return size;
   }
+  regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
   return 0;
 }
 
+namespace {
+  /*! Finds the register a raw address block access targets and validates the access as readBlock and writeBlock do.
+   *  Returns the descriptor and the word index of regAddr+offset in the register, nullptr if the access is denied.
+   */
+  const regDescriptor * rawBlockTarget(uint32_t regAddr, uint32_t size, uint32_t offset, uint8_t perm, uint32_t & word)
+  {
+    const regIndex* index = regIndex::open(addressTableGeneration());
+    if (!index) {
+      regErrors().push(REG_ERR_NO_INDEX, nullptr, 0, regAddr, true);
+      return nullptr;
+    }
+    static thread_local std::vector<uint32_t> ids;
+    index->findAddress(regAddr, ids);
+    if (ids.empty()) {
+      regErrors().push(REG_ERR_NO_REG_AT_ADDR, nullptr, 0, regAddr, true);
+      return nullptr;
+    }
+    // the fields of a word cannot be accessed as a block, a register covering the whole word is needed
+    auto full = std::find_if(ids.begin(), ids.end(), [index](uint32_t id) { return index->descriptor(id).mask == 0xFFFFFFFF; });
+    if (full == ids.end()) {
+      const char* name = index->name(ids.front());
+      regErrors().push(REG_ERR_MASKED_BLOCK, name, std::strlen(name), regAddr, true);
+      return nullptr;
+    }
+    const regDescriptor & desc = index->descriptor(*full);
+    const char* name = index->name(*full);
+    if (!(desc.perm & perm)) {
+      regErrors().push((perm == REG_PERM_READ) ? REG_ERR_NO_READ_PERM : REG_ERR_NO_WRITE_PERM,
+                       name, std::strlen(name), regAddr, true, desc.perm);
+      return nullptr;
+    }
+    word = (regAddr - desc.address) / 4 + offset;
+    const uint32_t rsize = std::max<uint32_t>(desc.size, 1);
+    if (desc.mode == REG_MODE_SINGLE && size > 1) {
+      regErrors().push(REG_ERR_SINGLE_BLOCK, name, std::strlen(name), regAddr, true);
+      return nullptr;
+    }
+    if (size > rsize || word > rsize - size) {
+      regErrors().push(REG_ERR_BLOCK_RANGE, name, std::strlen(name), regAddr, true, offset, size, rsize);
+      return nullptr;
+    }
+    return &desc;
+  }
+}
+
 uint32_t readBlock(const uint32_t& regAddr, uint32_t* result, const uint32_t& size, const uint32_t& offset)
 {
-  // Might not make sense, as it would be impossible to do any validation at this level
-  return 0;
+  uint32_t word;
+  const regDescriptor* desc = rawBlockTarget(regAddr, size, offset, REG_PERM_READ, word);
+  if (!desc)
+    return 0;
+  const int rc = (desc->mode == REG_MODE_FIFO || desc->mode == REG_MODE_PORT)
+      ? memhub_read_port(memsvc, desc->address, size, result)
+      : memhub_read(memsvc, desc->address + 4*word, size, result);
+  if (rc != 0) {
+    regErrors().push(REG_ERR_READ, nullptr, 0, regAddr, true, size);
+    return 0;
+  }
+  return size;
 }
 
 slowCtrlErrCntVFAT repeatedRegReadLocal(localArgs * la, const std::string & regName, bool breakOnFailure, uint32_t nReads)
@@ -389,11 +698,13 @@ slowCtrlErrCntVFAT repeatedRegReadLocal(localArgs * la, const std::string & regN
 
     //Issue a link reset to reset counters under GEM_AMC.SLOW_CONTROL.VFAT3
     writeReg(la,"GEM_AMC.GEM_SYSTEM.CTRL.LINK_RESET", 0x1);
+    hwContextInvalidate();
     std::this_thread::sleep_for(std::chrono::microseconds(90));
 
     for (uint32_t i=0; i<nReads; i++){
         //Any time a bus error occurs for VFAT slow control the TIMEOUT_ERROR_CNT will increment
-        bool goodRead = (readReg(la, regName) != 0xdeaddead);
+        uint32_t value;
+        bool goodRead = (readReg(la, regName, value) == REG_OK);
         std::this_thread::sleep_for(std::chrono::microseconds(20));
 
         if(!goodRead && breakOnFailure){
@@ -415,107 +726,97 @@ slowCtrlErrCntVFAT repeatedRegReadLocal(localArgs * la, const std::string & regN
 
 void writeReg(localArgs * la, const std::string & regName, uint32_t value)
 {
-  lmdb::val key, db_res;
-  key.assign(regName.c_str());
-  bool found = la->dbi.get(la->rtxn,key,db_res);
-  if (found) {
-    std::string t_db_res = std::string(db_res.data());
-    t_db_res = t_db_res.substr(0,db_res.size());
-    std::vector<std::string> tmp = split(t_db_res,'|');
-    uint32_t rmask = stoull(tmp[2], nullptr, 16);
-    if (rmask==0xFFFFFFFF) {
-      writeAddress(db_res, value, la->response);
+  const regDescriptor* desc = getRegDescriptor(la, regName);
+  if (desc) {
+    if (desc->mask==0xFFFFFFFF) {
+      writeDescAddress(desc, regName, value);
     } else {
-      uint32_t current_value = readAddress(db_res, la->response);
-      if (current_value == 0xdeaddead) {
-        std::stringstream errmsg;
-        errmsg << "Writing masked register failed due to problem reading: " << regName;
-        la->response->set_string("error", errmsg.str());
-        LOGGER->log_message(LogManager::ERROR, errmsg.str().c_str());
+      uint32_t current_value;
+      if (readDescAddress(desc, regName, current_value) != REG_OK) {
+        regErrors().push(REG_ERR_MASKED_WRITE, regName, desc->address, true);
         return;
       }
-      int shift_amount = 0;
-      uint32_t mask_copy = rmask;
-      for (int i = 0; i < 32; i++) {
-        if (rmask & 1) {
-          break;
-        } else {
-          shift_amount +=1;
-          rmask = rmask >> 1;
-        }
-      }
-      uint32_t val_to_write = value << shift_amount;
-      val_to_write = (val_to_write & mask_copy) | (current_value & ~mask_copy);
-      writeAddress(db_res, val_to_write, la->response);
+      uint32_t val_to_write = value << desc->shift;
+      val_to_write = (val_to_write & desc->mask) | (current_value & ~desc->mask);
+      writeDescAddress(desc, regName, val_to_write);
     }
   } else {
-    std::stringstream errmsg;
-    errmsg << "Register " << regName << " key not found";
-    la->response->set_string("error", errmsg.str());
-    LOGGER->log_message(LogManager::ERROR, errmsg.str().c_str());
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
   }
 }
 
+void writeBatch::writeReg(const std::string & regName, uint32_t value)
+{
+  const regDescriptor* desc = getRegDescriptor(m_la, regName);
+  if (!desc) {
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
+    return;
+  }
+  writeMasked(desc->address, desc->mask, value << desc->shift);
+}
+
+void writeBatch::writeMasked(uint32_t address, uint32_t mask, uint32_t value)
+{
+  for (auto & word : m_words) {
+    if (word.address == address) {
+      word.value = (word.value & ~mask) | (value & mask);
+      word.mask |= mask;
+      return;
+    }
+  }
+  m_words.push_back({address, mask, value & mask});
+}
+
+bool writeBatch::commit()
+{
+  bool success = true;
+  memhubTransaction transaction;
+  for (auto const& word : m_words) {
+    if (memhub_write_masked(memsvc, word.address, word.mask, word.value) != 0) {
+      regErrors().push(REG_ERR_WRITE, nullptr, 0, word.address, true, 1);
+      success = false;
+    }
+  }
+  m_words.clear();
+  return success;
+}
+
 void writeBlock(localArgs* la, const std::string& regName, const uint32_t* values, const uint32_t& size, const uint32_t& offset)
 {
-  lmdb::val key, db_res;
-  key.assign(regName.c_str());
-  bool found = la->dbi.get(la->rtxn,key,db_res);
-  if (found) {
-    std::string t_db_res = std::string(db_res.data());
-    t_db_res = t_db_res.substr(0,db_res.size());
-    std::vector<std::string> tmp = split(t_db_res,'|');
-    uint32_t raddr = stoull(tmp[0], nullptr, 16);
-    uint32_t rmask = stoull(tmp[2], nullptr, 16);
-    uint32_t rsize = stoull(tmp[4], nullptr, 16);
-    std::string rmode = tmp[3];
-    std::string rperm = tmp[1];
-    LOGGER->log_message(LogManager::DEBUG, stdsprintf("node %s properties: 0x%x  0x%x  0x%x  %s  %s",
-                                                      regName.c_str(), raddr, rmask, rsize, rmode.c_str(), rperm.c_str()));
+  const regDescriptor* desc = getRegDescriptor(la, regName);
+  if (desc) {
+    const uint32_t raddr = desc->address;
+    const uint32_t rmask = desc->mask;
+    const uint32_t rsize = desc->size;
 
     if (rmask != 0xFFFFFFFF) {
       // deny block write on masked register
-      std::stringstream errmsg;
-      errmsg << "Block write attempted on masked register";
-      la->response->set_string("error", errmsg.str());
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("block write error: %s", errmsg.str().c_str()));
-    } else if (rmode.rfind("single") != std::string::npos && size > 1) {
+      regErrors().push(REG_ERR_MASKED_BLOCK, regName, raddr, true);
+    } else if (desc->mode == REG_MODE_SINGLE && size > 1) {
       // only allow block write of size 1 on single registers
-      std::stringstream errmsg;
-      errmsg << "Block write attempted on single register with size greater than 1";
-      la->response->set_string("error", errmsg.str());
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("block write error: %s", errmsg.str().c_str()));
+      regErrors().push(REG_ERR_SINGLE_BLOCK, regName, raddr, true);
     } else if ((offset+size) > rsize) {
       // don't allow the write to go beyond the block range
-      std::stringstream errmsg;
-      errmsg << "Block write attempted would go beyond the size of the RAM: "
-             << "raddr: 0x"    << std::hex << raddr
-             << ", offset: 0x" << std::hex << offset
-             << ", size: 0x"   << std::hex << size
-             << ", rsize: 0x"  << std::hex << rsize;
-      la->response->set_string("error", errmsg.str());
-      LOGGER->log_message(LogManager::ERROR, stdsprintf("block write error: %s", errmsg.str().c_str()));
-    } else {
-      if (memhub_write(memsvc, raddr+offset, size, values) != 0) {
-        std::stringstream errmsg;
-        errmsg << "Write memsvc error: " << memsvc_get_last_error(memsvc);
-        la->response->set_string("error", errmsg.str());
-        LOGGER->log_message(LogManager::ERROR, stdsprintf("writeBlock: %s", errmsg.str().c_str()));
-      } else {
-        std::stringstream msg;
-        msg << "Block write succeeded.";
-        la->response->set_string("debug", msg.str());
-        LOGGER->log_message(LogManager::DEBUG, stdsprintf("writeBlock: %s", msg.str().c_str()));
-      }
+      regErrors().push(REG_ERR_BLOCK_RANGE, regName, raddr, true, offset, size, rsize);
+    } else if (memhub_write(memsvc, raddr + 4*offset, size, values) != 0) {
+      regErrors().push(REG_ERR_WRITE, regName, raddr, true, size);
     }
+  } else {
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
   }
 }
 
-void writeBlock(const uint32_t& regAddr, const uint32_t* values, const size_t& size, const uint32_t& offset)
+void writeBlock(const uint32_t& regAddr, const uint32_t* values, const uint32_t& size, const uint32_t& offset)
 {
-  // This function doesn't make sense with an offset, why would we specify an offset when accessing by register address?
-  // Maybe just to do validation checks on the size?
-  return;
+  uint32_t word;
+  const regDescriptor* desc = rawBlockTarget(regAddr, size, offset, REG_PERM_WRITE, word);
+  if (!desc)
+    return;
+  const int rc = (desc->mode == REG_MODE_FIFO || desc->mode == REG_MODE_PORT)
+      ? memhub_write_port(memsvc, desc->address, size, values)
+      : memhub_write(memsvc, desc->address + 4*word, size, values);
+  if (rc != 0)
+    regErrors().push(REG_ERR_WRITE, nullptr, 0, regAddr, true, size);
 }
 
 extern "C" {
@@ -530,5 +831,12 @@ extern "C" {
     }
     modmgr->register_method("utils", "update_address_table", update_address_table);
     modmgr->register_method("utils", "readRegFromDB",        readRegFromDB);
+    modmgr->register_method("utils", "execBatch",            execBatch);
+    modmgr->register_method("utils", "waitForReg",           waitForReg);
+    modmgr->register_method("utils", "resolveRegs",          resolveRegs);
+    modmgr->register_method("utils", "readRegsById",         readRegsById);
+    modmgr->register_method("utils", "writeRegsById",        writeRegsById);
+    modmgr->register_method("utils", "readSubtree",          readSubtree);
+    modmgr->register_method("utils", "addressToName",        addressToName);
   }
 }
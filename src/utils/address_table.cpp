@@ -0,0 +1,390 @@
+/*!
+ * \file utils/address_table.cpp
+ * \brief Versioned LMDB address table builds and atomic switches between versions
+ */
+
+#include "utils/address_table.h"
+#include "utils/families.h"
+#include "utils/reg_index.h"
+
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+uint64_t readGeneration(lmdb::txn & txn, lmdb::dbi & dbi)
+{
+  lmdb::val key, value;
+  key.assign(LMDB_GENERATION_KEY);
+  uint64_t generation = 0;
+  if (dbi.get(txn, key, value) && value.size() == sizeof(generation))
+    std::memcpy(&generation, value.data(), sizeof(generation));
+  return generation;
+}
+
+namespace {
+  /*! \class tableLock
+   *  Holds the exclusive lock on ADDRESS_TABLE_LOCK for its lifetime, so that concurrent updates do not pick the same generation
+   */
+  class tableLock {
+  public:
+    explicit tableLock(const std::string & gem_path) :
+      m_fd(::open((gem_path + "/" + ADDRESS_TABLE_LOCK).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0664))
+    {
+      if (m_fd >= 0 && ::flock(m_fd, LOCK_EX) != 0) {
+        ::close(m_fd);
+        m_fd = -1;
+      }
+    }
+    ~tableLock() { if (m_fd >= 0) ::close(m_fd); }
+    tableLock(const tableLock &) = delete;
+    tableLock & operator=(const tableLock &) = delete;
+
+    bool locked() const { return m_fd >= 0; }
+
+  private:
+    int m_fd;
+  };
+
+  /*! \struct tableRecord
+   *  LMDB record to write, pointing into the storage of the caller
+   */
+  struct tableRecord {
+    const std::string * key;
+    const void *        data;
+    size_t              size;
+  };
+
+  /*! Storage of the records of a table, kept alive while they are written. The node names are those of the parsed table. */
+  struct tableContents {
+    std::vector<regDescriptor>                                descs;
+    std::vector<std::pair<std::string, regFamilyDescriptor> > families;
+    std::string                                               generationKey{LMDB_GENERATION_KEY};
+    uint64_t                                                  generation{0};
+    std::vector<tableRecord>                                  records; ///< sorted by key, as LMDB orders them
+    size_t                                                    payload{0}; ///< total size of the keys and values
+  };
+
+  void collectRecords(const std::unordered_map<std::string, xhal::utils::Node> & nodes, uint64_t generation, tableContents & contents)
+  {
+    contents.generation = generation;
+    contents.descs.clear();
+    contents.descs.reserve(nodes.size());
+    buildRegFamilies(nodes, contents.families);
+
+    std::vector<tableRecord> & records = contents.records;
+    records.clear();
+    records.reserve(nodes.size() + contents.families.size() + 1);
+    for (auto const& n : nodes) {
+      contents.descs.push_back(makeRegDescriptor(n.second));
+      records.push_back({&n.first, &contents.descs.back(), sizeof(regDescriptor)});
+    }
+    for (auto const& f : contents.families)
+      records.push_back({&f.first, &f.second, sizeof(f.second)});
+    records.push_back({&contents.generationKey, &contents.generation, sizeof(contents.generation)});
+    // LMDB compares keys byte-wise, shorter keys first on a common prefix, as std::string does
+    std::sort(records.begin(), records.end(), [](const tableRecord & a, const tableRecord & b) { return *a.key < *b.key; });
+
+    contents.payload = 0;
+    for (auto const& r : records)
+      contents.payload += r.key->size() + r.size;
+  }
+
+  /*! LMDB map size for a table: each record costs an 8 byte node header and a 2 byte page index next to its key and
+   *  value, and leaf pages are nearly full when written in order. Three times the data leaves room for the branch
+   *  pages and for the copy-on-write pages of incremental updates.
+   */
+  size_t mapSize(const tableContents & contents)
+  {
+    static constexpr size_t MiB = 1024 * 1024;
+    const size_t data = contents.payload + 10 * contents.records.size();
+    return ((3 * data + MiB) / MiB + 1) * MiB;
+  }
+
+  uint64_t fileSize(const std::string & path)
+  {
+    struct stat st;
+    return (::stat(path.c_str(), &st) == 0) ? st.st_size : 0;
+  }
+
+  std::string versionName(uint64_t generation)
+  {
+    return ADDRESS_TABLE_VERSION + std::to_string(generation);
+  }
+
+  /*! Reads the generation of the current table, 0 if there is none. Returns false if the table exists but cannot be
+   *  read: the next version cannot be chosen safely then, it could be the live one.
+   */
+  bool currentGeneration(const std::string & link, uint64_t & generation, std::string & error)
+  {
+    generation = 0;
+    struct stat st;
+    if (::stat((link + "/data.mdb").c_str(), &st) != 0) {
+      if (errno == ENOENT)
+        return true;
+      error = stdsprintf("Unable to access %s/data.mdb: %s", link.c_str(), std::strerror(errno));
+      return false;
+    }
+    try {
+      auto env = lmdb::env::create();
+      env.set_mapsize(LMDB_SIZE);
+      env.open(link.c_str(), MDB_RDONLY, 0664);
+      auto rtxn = lmdb::txn::begin(env, nullptr, MDB_RDONLY);
+      auto dbi  = lmdb::dbi::open(rtxn, nullptr);
+      generation = readGeneration(rtxn, dbi);
+      return true;
+    } catch (const lmdb::error & e) {
+      error = stdsprintf("Unable to read the generation of %s: %s", link.c_str(), e.what());
+      return false;
+    }
+  }
+
+  /*! Returns the directory the link points to, empty if it is not a link */
+  std::string linkTarget(const std::string & gem_path, const std::string & link)
+  {
+    char target[PATH_MAX];
+    const ssize_t len = ::readlink(link.c_str(), target, sizeof(target) - 1);
+    if (len <= 0)
+      return std::string();
+    const std::string name(target, len);
+    return (name[0] == '/') ? name : gem_path + "/" + name;
+  }
+
+  void removeVersion(const std::string & dir)
+  {
+    if (DIR* d = ::opendir(dir.c_str())) {
+      while (struct dirent* e = ::readdir(d)) {
+        if (std::strcmp(e->d_name, ".") && std::strcmp(e->d_name, ".."))
+          ::unlink((dir + "/" + e->d_name).c_str());
+      }
+      ::closedir(d);
+    }
+    ::rmdir(dir.c_str());
+  }
+
+  /*! Removes the version directories other than the given ones */
+  void removeOldVersions(const std::string & gem_path, const std::string & keep1, const std::string & keep2)
+  {
+    const size_t prefixLen = std::strlen(ADDRESS_TABLE_VERSION);
+    std::vector<std::string> stale;
+    if (DIR* d = ::opendir(gem_path.c_str())) {
+      while (struct dirent* e = ::readdir(d)) {
+        if (std::strncmp(e->d_name, ADDRESS_TABLE_VERSION, prefixLen) == 0 && keep1 != e->d_name && keep2 != e->d_name)
+          stale.push_back(e->d_name);
+      }
+      ::closedir(d);
+    }
+    for (auto const& name : stale) {
+      LOGGER->log_message(LogManager::INFO, stdsprintf("Removing address table version %s", name.c_str()));
+      removeVersion(gem_path + "/" + name);
+    }
+  }
+
+  /*! Writes the LMDB environment of a new version, records inserted in key order */
+  void writeEnvironment(const std::string & dir, const tableContents & contents)
+  {
+    auto env = lmdb::env::create();
+    env.set_mapsize(mapSize(contents));
+    env.open(dir.c_str(), 0, 0664);
+    auto wtxn = lmdb::txn::begin(env);
+    auto dbi  = lmdb::dbi::open(wtxn, nullptr);
+    lmdb::val key, value;
+    for (auto const& r : contents.records) {
+      key.assign(*r.key);
+      value.assign(r.data, r.size);
+      dbi.put(wtxn, key, value, MDB_APPEND);
+    }
+    wtxn.commit();
+  }
+
+  /*! Atomically points the link to the given version directory */
+  bool switchVersion(const std::string & gem_path, const std::string & version, uint64_t previous, std::string & error)
+  {
+    const std::string link = gem_path + "/" + ADDRESS_TABLE_LINK;
+    struct stat st;
+    if (::lstat(link.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+      // table written by an earlier release, turned into a version directory
+      const std::string legacy = gem_path + "/" + versionName(previous);
+      if (::rename(link.c_str(), legacy.c_str()) != 0) {
+        error = stdsprintf("Unable to move %s to %s: %s", link.c_str(), legacy.c_str(), std::strerror(errno));
+        return false;
+      }
+    }
+    const std::string tmp = link + ".tmp";
+    ::unlink(tmp.c_str());
+    if (::symlink(version.c_str(), tmp.c_str()) != 0 || ::rename(tmp.c_str(), link.c_str()) != 0) {
+      error = stdsprintf("Unable to link %s to %s: %s", link.c_str(), version.c_str(), std::strerror(errno));
+      ::unlink(tmp.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool buildLocked(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & gem_path,
+                   addressTableUpdate & update, std::string & error)
+  {
+    const std::string link = gem_path + "/" + ADDRESS_TABLE_LINK;
+    uint64_t previous;
+    if (!currentGeneration(link, previous, error))
+      return false;
+    const std::string version = versionName(previous + 1);
+    const std::string dir     = gem_path + "/" + version;
+
+    // never touch the table the readers are using, whatever its generation says
+    const std::string live = linkTarget(gem_path, link);
+    if (live == dir || live == dir + "/") {
+      error = stdsprintf("%s is the live address table, it cannot be rebuilt as generation %llu", dir.c_str(),
+                         static_cast<unsigned long long>(previous + 1));
+      return false;
+    }
+
+    tableContents contents;
+    collectRecords(nodes, previous + 1, contents);
+
+    removeVersion(dir); // leftover of a failed update
+    if (::mkdir(dir.c_str(), 0775) != 0) {
+      error = stdsprintf("Unable to create %s: %s", dir.c_str(), std::strerror(errno));
+      return false;
+    }
+    try {
+      writeEnvironment(dir, contents);
+    } catch (const lmdb::error & e) {
+      error = stdsprintf("Unable to write %s: %s", dir.c_str(), e.what());
+      removeVersion(dir);
+      return false;
+    }
+    update.nRegs = buildRegIndex(nodes, contents.generation, dir + "/" + REG_INDEX_FILE);
+
+    const std::string previousVersion = live.empty() ? versionName(previous) : live.substr(live.rfind('/') + 1);
+    if (!switchVersion(gem_path, version, previous, error)) {
+      removeVersion(dir);
+      return false;
+    }
+    removeOldVersions(gem_path, version, previousVersion);
+
+    update.generation = contents.generation;
+    update.nNodes     = contents.descs.size();
+    update.nWritten   = contents.records.size();
+    update.nRemoved   = 0;
+    update.nFamilies  = contents.families.size();
+    update.dbSize     = fileSize(dir + "/data.mdb");
+    return true;
+  }
+}
+
+bool buildAddressTable(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & gem_path,
+                       addressTableUpdate & update, std::string & error)
+{
+  tableLock lock(gem_path);
+  if (!lock.locked()) {
+    error = stdsprintf("Unable to lock %s/%s: %s", gem_path.c_str(), ADDRESS_TABLE_LOCK, std::strerror(errno));
+    return false;
+  }
+  update = addressTableUpdate();
+  return buildLocked(nodes, gem_path, update, error);
+}
+
+bool patchAddressTable(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & gem_path,
+                       addressTableUpdate & update, std::string & error)
+{
+  tableLock lock(gem_path);
+  if (!lock.locked()) {
+    error = stdsprintf("Unable to lock %s/%s: %s", gem_path.c_str(), ADDRESS_TABLE_LOCK, std::strerror(errno));
+    return false;
+  }
+  update = addressTableUpdate();
+
+  const std::string link = gem_path + "/" + ADDRESS_TABLE_LINK;
+  struct stat st;
+  if (::stat((link + "/data.mdb").c_str(), &st) != 0) {
+    LOGGER->log_message(LogManager::INFO, "No address table to update, building a new one");
+    return buildLocked(nodes, gem_path, update, error);
+  }
+
+  try {
+    // the generation is only known once the table is open, it is set right after
+    tableContents contents;
+    collectRecords(nodes, 0, contents);
+
+    auto env = lmdb::env::create();
+    env.set_mapsize(fileSize(link + "/data.mdb") + mapSize(contents));
+    env.open(link.c_str(), 0, 0664);
+    auto wtxn = lmdb::txn::begin(env);
+    auto dbi  = lmdb::dbi::open(wtxn, nullptr);
+    contents.generation = readGeneration(wtxn, dbi) + 1;
+
+    // merge the current records, in key order, with the new ones
+    std::vector<std::string> stale;
+    std::vector<const tableRecord*> changed;
+    {
+      auto cursor = lmdb::cursor::open(wtxn, dbi);
+      lmdb::val key, value;
+      auto next = contents.records.cbegin();
+      const auto end = contents.records.cend();
+      bool more = cursor.get(key, value, MDB_FIRST);
+      while (more || next != end) {
+        const int cmp = !more ? 1 : (next == end) ? -1 : std::string(key.data(), key.size()).compare(*next->key);
+        if (cmp < 0) {
+          stale.emplace_back(key.data(), key.size());
+        } else if (cmp > 0) {
+          changed.push_back(&*next);
+        } else if (value.size() != next->size || std::memcmp(value.data(), next->data, next->size) != 0) {
+          changed.push_back(&*next);
+        }
+        if (cmp <= 0)
+          more = cursor.get(key, value, MDB_NEXT);
+        if (cmp >= 0)
+          ++next;
+      }
+    }
+
+    lmdb::val key, value;
+    for (auto const& k : stale) {
+      key.assign(k);
+      dbi.del(wtxn, key);
+    }
+    for (auto const* r : changed) {
+      key.assign(*r->key);
+      value.assign(r->data, r->size);
+      dbi.put(wtxn, key, value);
+    }
+
+    // the index carries the new generation: written aside, and only put in place once the table is committed, so
+    // that a failed commit leaves the index of the current generation
+    const std::string index = link + "/" + REG_INDEX_FILE;
+    const std::string next  = index + ".next";
+    update.nRegs = buildRegIndex(nodes, contents.generation, next);
+    try {
+      wtxn.commit();
+    } catch (...) {
+      std::remove(next.c_str());
+      throw;
+    }
+    if (update.nRegs && std::rename(next.c_str(), index.c_str()) != 0) {
+      LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to move %s to %s, register IDs are unavailable until the next update: %s",
+                                                        next.c_str(), index.c_str(), std::strerror(errno)));
+      std::remove(next.c_str());
+      update.nRegs = 0;
+    }
+
+    update.generation = contents.generation;
+    update.nNodes     = contents.descs.size();
+    update.nWritten   = changed.size();
+    update.nRemoved   = stale.size();
+    update.nFamilies  = contents.families.size();
+    update.dbSize     = fileSize(link + "/data.mdb");
+  } catch (const lmdb::error & e) {
+    error = stdsprintf("Unable to update %s: %s", link.c_str(), e.what());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,152 @@
+/*!
+ * \file utils/batch.cpp
+ * \brief Server-side execution of register operation programs
+ */
+
+#include "utils/batch.h"
+#include "utils/wait.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+  /*! Keeps the consecutive register accesses of a program in the same memhub transaction */
+  class batchTransaction {
+  public:
+    ~batchTransaction() { close(); }
+    void open()  { if (!m_open) m_open = (memhub_transaction_begin() == 0); }
+    void close() { if (m_open) memhub_transaction_end(); m_open = false; }
+
+  private:
+    bool m_open = false;
+  };
+
+  /*! Records the error stopping the program, the operation is given by the "executed" key of the response */
+  bool fail(regError code, const std::string & name, uint32_t address, uint32_t arg0=0, uint32_t arg1=0, uint32_t arg2=0)
+  {
+    regErrors().push(code, name, address, true, arg0, arg1, arg2);
+    return false;
+  }
+}
+
+bool execBatchLocal(localArgs * la, const std::vector<std::string> & regNames, const std::vector<uint32_t> & program,
+                    std::vector<uint32_t> & results, uint32_t & nExecuted)
+{
+  nExecuted = 0;
+  std::vector<regDescriptor> regs;
+  regs.reserve(regNames.size());
+  for (auto const& name : regNames) {
+    const regDescriptor* desc = getRegDescriptor(la, name);
+    if (!desc)
+      return fail(REG_ERR_NOT_FOUND, name, 0);
+    regs.push_back(*desc);
+  }
+
+  batchTransaction transaction;
+  static const std::string noName;
+  for (size_t pc = 0; pc < program.size(); ++nExecuted) {
+    const batchOp  op  = static_cast<batchOp>(program[pc] >> 24);
+    const uint32_t arg = program[pc] & 0xFFFFFF;
+    ++pc;
+
+    static const size_t nOperands[] = {0, 0, 1, 2, 2, 0, 3};
+    if (op < BATCH_READ_REG || op > BATCH_POLL)
+      return fail(REG_ERR_BATCH_PROGRAM, noName, 0, nExecuted, static_cast<uint32_t>(pc - 1));
+    if (op != BATCH_SLEEP && arg >= regs.size())
+      return fail(REG_ERR_NOT_FOUND, noName, 0);
+    if (pc + nOperands[op] > program.size())
+      return fail(REG_ERR_BATCH_PROGRAM, noName, 0, nExecuted, static_cast<uint32_t>(pc - 1));
+    const uint32_t* operands = program.data() + pc;
+    pc += nOperands[op];
+
+    static const regDescriptor noReg = {};
+    const regDescriptor & desc = (op != BATCH_SLEEP) ? regs[arg] : noReg;
+    const std::string & name   = (op != BATCH_SLEEP) ? regNames[arg] : noName;
+
+    switch (op) {
+    case BATCH_READ_REG: {
+      if (!(desc.perm & REG_PERM_READ))
+        return fail(REG_ERR_NO_READ_PERM, name, desc.address, desc.perm);
+      uint32_t data;
+      transaction.open();
+      if (memhub_read(memsvc, desc.address, 1, &data) != 0)
+        return fail(REG_ERR_READ, name, desc.address, 1);
+      results.push_back((data & desc.mask) >> desc.shift);
+      break;
+    }
+    case BATCH_WRITE_REG: {
+      if (!(desc.perm & REG_PERM_WRITE))
+        return fail(REG_ERR_NO_WRITE_PERM, name, desc.address, desc.perm);
+      transaction.open();
+      if (memhub_write_masked(memsvc, desc.address, desc.mask, operands[0] << desc.shift) != 0)
+        return fail(REG_ERR_WRITE, name, desc.address, 1);
+      break;
+    }
+    case BATCH_READ_BLOCK:
+    case BATCH_WRITE_BLOCK: {
+      const bool     write  = (op == BATCH_WRITE_BLOCK);
+      const uint32_t size   = operands[0];
+      const uint32_t offset = operands[1];
+      if (!(desc.perm & (write ? REG_PERM_WRITE : REG_PERM_READ)))
+        return fail(write ? REG_ERR_NO_WRITE_PERM : REG_ERR_NO_READ_PERM, name, desc.address, desc.perm);
+      if (desc.mask != 0xFFFFFFFF)
+        return fail(REG_ERR_MASKED_BLOCK, name, desc.address);
+      // a port is accessed at its address, but its transfers are still bounded by its size as in readBlock
+      const bool     port  = (desc.mode == REG_MODE_FIFO || desc.mode == REG_MODE_PORT);
+      const uint32_t rsize = std::max<uint32_t>(desc.size, 1);
+      if (size > rsize || (!port && offset > rsize - size))
+        return fail(REG_ERR_BLOCK_RANGE, name, desc.address, offset, size, desc.size);
+      if (write && size > program.size() - pc)
+        return fail(REG_ERR_BATCH_PROGRAM, noName, 0, nExecuted, static_cast<uint32_t>(pc - 1));
+      transaction.open();
+      int ret;
+      if (write) {
+        const uint32_t* values = program.data() + pc;
+        pc += size;
+        ret = port ? memhub_write_port(memsvc, desc.address, size, values)
+                   : memhub_write(memsvc, desc.address + 4*offset, size, values);
+      } else {
+        results.resize(results.size() + size);
+        uint32_t* data = results.data() + results.size() - size;
+        ret = port ? memhub_read_port(memsvc, desc.address, size, data)
+                   : memhub_read(memsvc, desc.address + 4*offset, size, data);
+      }
+      if (ret != 0)
+        return fail(write ? REG_ERR_WRITE : REG_ERR_READ, name, desc.address, size);
+      break;
+    }
+    case BATCH_SLEEP:
+      transaction.close();
+      std::this_thread::sleep_for(std::chrono::microseconds(arg));
+      break;
+    case BATCH_POLL: {
+      if (!(desc.perm & REG_PERM_READ))
+        return fail(REG_ERR_NO_READ_PERM, name, desc.address, desc.perm);
+      transaction.close();
+      waitResult result;
+      if (!waitForRegLocal(desc, operands[0], WAIT_EQ, operands[1], operands[2], result))
+        return fail(REG_ERR_READ, name, desc.address, 1);
+      if (!result.met)
+        return fail(REG_ERR_TIMEOUT, name, desc.address, operands[0], operands[1], result.value);
+      results.push_back(result.value);
+      break;
+    }
+    }
+  }
+  return true;
+}
+
+void execBatch(const RPCMsg *request, RPCMsg *response)
+{
+  LocalArgs la = getLocalArgs(response);
+  const std::vector<std::string> regNames = request->get_key_exists("names") ? request->get_string_array("names")
+                                                                             : std::vector<std::string>();
+  const std::vector<uint32_t> program = request->get_word_array("program");
+
+  std::vector<uint32_t> results;
+  uint32_t nExecuted = 0;
+  execBatchLocal(&la, regNames, program, results, nExecuted);
+  response->set_word_array("data", results);
+  response->set_word("executed", nExecuted);
+}
@@ -0,0 +1,197 @@
+/*!
+ * \file utils/errors.cpp
+ * \brief Register access error codes and the per-request error ring
+ */
+
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+  regErrorRing s_errors;
+  uint32_t     s_reporters = 0; ///< Number of live regErrorReporter, the ring belongs to the request of the outermost one
+
+  std::string renderRecord(const regErrorRecord & r)
+  {
+    const regError code = static_cast<regError>(r.code);
+    std::string text = regErrorString(code);
+    if (r.nameLen)
+      text += stdsprintf(": %s%.*s", (r.flags & REG_ERR_FLAG_TRUNCATED) ? "..." : "", static_cast<int>(r.nameLen), r.name);
+    if (r.address)
+      text += stdsprintf(" at 0x%08x", r.address);
+    switch (code) {
+    case REG_ERR_NO_READ_PERM:
+    case REG_ERR_NO_WRITE_PERM:
+      text += stdsprintf(", permissions %s", regPermString(static_cast<uint8_t>(r.args[0])));
+      break;
+    case REG_ERR_READ:
+    case REG_ERR_WRITE:
+      // the text of the last memhub error only, earlier ones are gone
+      text += stdsprintf(", %u words, last memsvc error: %s", r.args[0], memsvc_get_last_error(memsvc));
+      break;
+    case REG_ERR_BLOCK_RANGE:
+      text += stdsprintf(", offset: 0x%x, size: 0x%x, rsize: 0x%x", r.args[0], r.args[1], r.args[2]);
+      break;
+    case REG_ERR_READ_RETRIED:
+      text += stdsprintf(", %u failed attempts", r.args[0]);
+      break;
+    case REG_ERR_INDEX_RANGE:
+      text += stdsprintf(", level %u, index %u, %u indices", r.args[0], r.args[1], r.args[2]);
+      break;
+    case REG_ERR_INDEX_COUNT:
+      text += stdsprintf(", %u indices given, %u expected", r.args[0], r.args[1]);
+      break;
+    case REG_ERR_BATCH_PROGRAM:
+      text += stdsprintf(", operation %u, word %u", r.args[0], r.args[1]);
+      break;
+    case REG_ERR_TIMEOUT:
+      text += stdsprintf(", waiting for value & 0x%x against 0x%x, last value 0x%x", r.args[0], r.args[1], r.args[2]);
+      break;
+    case REG_ERR_WAIT_CONDITION:
+      text += stdsprintf(" %u", r.args[0]);
+      break;
+    case REG_ERR_STALE_IDS:
+      text += stdsprintf(", generation 0x%x requested, address table is at 0x%x", r.args[0], r.args[1]);
+      break;
+    case REG_ERR_ID_RANGE:
+      text += stdsprintf(" %u, %u registers", r.args[0], r.args[1]);
+      break;
+    default:
+      break;
+    }
+    if (r.count > 1)
+      text += stdsprintf(" (%u times)", r.count);
+    return text;
+  }
+}
+
+const char * regErrorString(regError code)
+{
+  switch (code) {
+  case REG_OK:                 return "No error";
+  case REG_ERR_NOT_FOUND:      return "Register not found";
+  case REG_ERR_NO_READ_PERM:   return "No read permissions";
+  case REG_ERR_NO_WRITE_PERM:  return "No write permissions";
+  case REG_ERR_READ:           return "Read memsvc error";
+  case REG_ERR_WRITE:          return "Write memsvc error";
+  case REG_ERR_MALFORMED:      return "Malformed register descriptor";
+  case REG_ERR_MASKED_BLOCK:   return "Block access attempted on masked register";
+  case REG_ERR_SINGLE_BLOCK:   return "Block access attempted on single register with size greater than 1";
+  case REG_ERR_BLOCK_RANGE:    return "Block access attempted would go beyond the size of the register";
+  case REG_ERR_MASKED_WRITE:   return "Writing masked register failed due to problem reading";
+  case REG_ERR_NO_INDEX:       return "No register index to validate the address";
+  case REG_ERR_NO_REG_AT_ADDR: return "No register at address";
+  case REG_ERR_READ_RETRIED:   return "Read succeeded after retries";
+  case REG_ERR_STATIC_REGS:    return "Static registers do not match the address table, rebuild the modules";
+  case REG_ERR_INDEX_RANGE:    return "Register family index out of range";
+  case REG_ERR_INDEX_COUNT:    return "Wrong number of register family indices";
+  case REG_ERR_BATCH_PROGRAM:  return "Malformed execBatch program";
+  case REG_ERR_TIMEOUT:        return "Timeout waiting for register";
+  case REG_ERR_WAIT_CONDITION: return "Unknown wait condition";
+  case REG_ERR_STALE_IDS:      return "Register IDs belong to another address table generation, resolve them again";
+  case REG_ERR_ID_RANGE:       return "Invalid register ID";
+  case REG_ERR_BAD_REQUEST:    return "Missing or inconsistent request key";
+  case REG_ERR_EMPTY_SUBTREE:  return "No readable register below node";
+  }
+  return "Unknown error";
+}
+
+void regErrorRing::push(regError code, const char * name, size_t len, uint32_t address, bool report,
+                        uint32_t arg0, uint32_t arg1, uint32_t arg2) noexcept
+{
+  ++m_total;
+  static const char none = 0;
+  if (!name) {
+    name = &none;
+    len  = 0;
+  }
+  const size_t keep = std::min(len, sizeof(regErrorRecord::name));
+  const char * tail = name + (len - keep);
+
+  if (m_used) {
+    // retries and loops over the same register end up in the same record
+    regErrorRecord & last = m_records[(m_next + SIZE - 1) % SIZE];
+    if (last.code == code && last.address == address && last.nameLen == keep &&
+        last.args[0] == arg0 && last.args[1] == arg1 && last.args[2] == arg2 &&
+        std::memcmp(last.name, tail, keep) == 0) {
+      ++last.count;
+      if (report)
+        last.flags |= REG_ERR_FLAG_REPORT;
+      return;
+    }
+  }
+
+  regErrorRecord & r = m_records[m_next];
+  r.code    = code;
+  r.flags   = (report ? REG_ERR_FLAG_REPORT : 0) | (keep < len ? REG_ERR_FLAG_TRUNCATED : 0);
+  r.nameLen = static_cast<uint8_t>(keep);
+  r.count   = 1;
+  r.address = address;
+  r.args[0] = arg0;
+  r.args[1] = arg1;
+  r.args[2] = arg2;
+  std::memcpy(r.name, tail, keep);
+  m_next = (m_next + 1) % SIZE;
+  if (m_used < SIZE)
+    ++m_used;
+}
+
+void regErrorRing::render(RPCMsg * response) const
+{
+  if (!m_total)
+    return;
+
+  std::vector<uint32_t>    codes;
+  std::vector<std::string> texts;
+  codes.reserve(m_used + 1);
+  texts.reserve(m_used + 1);
+  uint32_t recorded = 0;
+  for (uint32_t i = 0; i < m_used; ++i)
+    recorded += m_records[i].count;
+  if (recorded < m_total) {
+    codes.push_back(REG_OK);
+    texts.push_back(stdsprintf("%u earlier errors dropped", m_total - recorded));
+    LOGGER->log_message(LogManager::ERROR, texts.back());
+  }
+
+  const regErrorRecord * reported = nullptr;
+  for (uint32_t i = 0; i < m_used; ++i) {
+    const regErrorRecord & r = m_records[(m_next + SIZE - m_used + i) % SIZE];
+    codes.push_back(r.code);
+    texts.push_back(renderRecord(r));
+    if (r.flags & REG_ERR_FLAG_REPORT)
+      reported = &r;
+    LOGGER->log_message(r.code == REG_ERR_READ_RETRIED ? LogManager::WARNING : LogManager::ERROR, texts.back());
+  }
+
+  response->set_word_array("error_codes", codes);
+  response->set_string_array("errors", texts);
+  if (reported && !response->get_key_exists("error"))
+    response->set_string("error", renderRecord(*reported));
+}
+
+regErrorRing & regErrors()
+{
+  return s_errors;
+}
+
+regErrorReporter::regErrorReporter(RPCMsg * response) :
+  m_response(response)
+{
+  if (s_reporters++ == 0)
+    s_errors.clear();
+}
+
+regErrorReporter::~regErrorReporter()
+{
+  if (!m_counted)
+    return;
+  if (--s_reporters == 0 && m_response) {
+    try {
+      s_errors.render(m_response);
+    } catch (const std::exception & e) {
+      LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to report the register access errors: %s", e.what()));
+    }
+  }
+}
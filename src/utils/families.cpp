@@ -0,0 +1,155 @@
+/*!
+ * \file utils/families.cpp
+ * \brief Indexed register families: stride based address resolution for arrayed address table nodes
+ */
+
+#include "utils/families.h"
+#include "utils/family_rules.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+regFamily::regFamily(localArgs * la, const std::string & pattern) :
+  m_la(la),
+  m_pattern(pattern),
+  m_indexed(false),
+  m_fam()
+{
+  // a single register is simply looked up by name
+  if (pattern.find('*') == std::string::npos)
+    return;
+  lmdb::val key, db_res;
+  const std::string t_key = LMDB_FAMILY_PREFIX + pattern;
+  key.assign(t_key);
+  if (la->dbi.get(la->rtxn, key, db_res) && db_res.size() == sizeof(regFamilyDescriptor)) {
+    std::memcpy(&m_fam, db_res.data(), sizeof(regFamilyDescriptor));
+    m_indexed = (m_fam.desc.magic == REG_DESC_MAGIC && m_fam.desc.version == REG_DESC_VERSION);
+  }
+  if (!m_indexed)
+    LOGGER->log_message(LogManager::DEBUG, stdsprintf("Register family %s is not indexed, resolving members by name", pattern.c_str()));
+}
+
+std::string regFamily::memberName(const uint32_t * idx, size_t n) const
+{
+  std::string name;
+  size_t d = 0;
+  for (char c : m_pattern) {
+    if (c == '*' && d < n)
+      name += std::to_string(idx[d++]);
+    else
+      name += c;
+  }
+  return name;
+}
+
+uint32_t regFamily::addressOf(const uint32_t * idx, size_t n, bool report) const
+{
+  if (!m_indexed)
+    return getAddress(m_la, memberName(idx, n));
+
+  if (n != m_fam.nDims) {
+    regErrors().push(REG_ERR_INDEX_COUNT, m_pattern, 0, report, static_cast<uint32_t>(n), m_fam.nDims);
+    return 0xdeaddead;
+  }
+  int64_t address = m_fam.desc.address;
+  for (size_t d = 0; d < n; ++d) {
+    const uint32_t rel = idx[d] - m_fam.first[d];
+    if (rel >= m_fam.count[d]) {
+      regErrors().push(REG_ERR_INDEX_RANGE, m_pattern, 0, report, static_cast<uint32_t>(d), idx[d], m_fam.count[d]);
+      return 0xdeaddead;
+    }
+    address += static_cast<int64_t>(rel) * m_fam.stride[d];
+  }
+  return static_cast<uint32_t>(address);
+}
+
+regDescriptor regFamily::memberOf(const uint32_t * idx, size_t n) const
+{
+  regDescriptor desc = m_fam.desc;
+  if (!m_indexed) {
+    const std::string name = memberName(idx, n);
+    const regDescriptor* found = getRegDescriptor(m_la, name);
+    if (found)
+      return *found;
+    regErrors().push(REG_ERR_NOT_FOUND, name, 0, false);
+    desc.address = 0xdeaddead;
+  } else {
+    desc.address = addressOf(idx, n);
+  }
+  if (desc.address == 0xdeaddead)
+    desc.perm = REG_PERM_NONE;
+  return desc;
+}
+
+regError regFamily::readOf(const uint32_t * idx, size_t n, uint32_t & value) const
+{
+  if (!m_indexed)
+    return readReg(m_la, memberName(idx, n), value);
+
+  if (!(m_fam.desc.perm & REG_PERM_READ)) {
+    regErrors().push(REG_ERR_NO_READ_PERM, m_pattern, m_fam.desc.address, false, m_fam.desc.perm);
+    return REG_ERR_NO_READ_PERM;
+  }
+  const uint32_t address = addressOf(idx, n);
+  if (address == 0xdeaddead)
+    return regErrors().last();
+  uint32_t data[1];
+  if (memhub_read(memsvc, address, 1, data) != 0) {
+    regErrors().push(REG_ERR_READ, m_pattern, address, false, 1);
+    return REG_ERR_READ;
+  }
+  value = (m_fam.desc.mask != 0xFFFFFFFF) ? ((data[0] & m_fam.desc.mask) >> m_fam.desc.shift) : data[0];
+  return REG_OK;
+}
+
+void regFamily::writeOf(uint32_t value, const uint32_t * idx, size_t n) const
+{
+  if (!m_indexed) {
+    writeReg(m_la, memberName(idx, n), value);
+    return;
+  }
+
+  if (!(m_fam.desc.perm & REG_PERM_WRITE)) {
+    regErrors().push(REG_ERR_NO_WRITE_PERM, m_pattern, m_fam.desc.address, true, m_fam.desc.perm);
+    return;
+  }
+  const uint32_t address = addressOf(idx, n, true);
+  if (address == 0xdeaddead)
+    return;
+  // a plain write for full words, a read-modify-write under the memhub lock for fields
+  if (memhub_write_masked(memsvc, address, m_fam.desc.mask, value << m_fam.desc.shift) != 0)
+    regErrors().push(REG_ERR_WRITE, m_pattern, address, true, 1);
+}
+
+regFamily family(localArgs * la, const std::string & pattern)
+{
+  return regFamily(la, pattern);
+}
+
+size_t buildRegFamilies(const std::unordered_map<std::string, xhal::utils::Node> & nodes,
+                        std::vector<std::pair<std::string, regFamilyDescriptor> > & indexed)
+{
+  indexed.clear();
+  std::unordered_map<std::string, std::vector<regFamilyMember> > families;
+  std::unordered_map<std::string, size_t> familyDims;
+  std::string pattern;
+  for (auto const& it : nodes) {
+    regFamilyMember m;
+    const size_t nDims = regFamilyPattern(it.first, pattern, m.idx);
+    if (nDims == 0)
+      continue;
+    m.desc = makeRegDescriptor(it.second);
+    families[pattern].push_back(m);
+    familyDims[pattern] = nDims;
+  }
+
+  regFamilyDescriptor fam;
+  std::string error;
+  for (auto const& it : families) {
+    if (it.second.size() < 2 || !indexRegFamily(it.second, familyDims[it.first], fam, error))
+      continue;
+    indexed.emplace_back(LMDB_FAMILY_PREFIX + it.first, fam);
+  }
+  return indexed.size();
+}
@@ -0,0 +1,95 @@
+/*!
+ * \file utils/hw_context.cpp
+ * \brief Slow-changing hardware state resolved once per call: firmware release and number of OptoHybrids
+ */
+
+#include "utils/static_regs.h"
+
+#include <chrono>
+
+namespace {
+  uint64_t s_epoch = 1; ///< the zero-initialized hwContext of a new call is stale
+
+  /*! \struct sharedIdentity
+   *  Firmware release and number of OptoHybrids shared between calls
+   */
+  struct sharedIdentity {
+    hwContext                             ctx{};
+    uint64_t                              generation{0};
+    std::chrono::steady_clock::time_point time{};
+  };
+
+  sharedIdentity s_shared;
+
+  hwContext & current(localArgs * la)
+  {
+    hwContext & hw = la->hw;
+    if (hw.epoch != s_epoch) {
+      hw = hwContext();
+      hw.epoch = s_epoch;
+    }
+    return hw;
+  }
+
+  bool sharedFresh()
+  {
+    return s_shared.ctx.epoch == s_epoch && s_shared.generation == addressTableGeneration() &&
+           std::chrono::steady_clock::now() - s_shared.time < std::chrono::milliseconds(HW_CONTEXT_TTL_MS);
+  }
+
+  uint32_t readField(localArgs * la, hwContextField field)
+  {
+    STATIC_REGS_CHECK(la, 0xdeaddead);
+    if (field == HW_CTX_FW_MAJOR) {
+      REG_SINGLE(releaseMajor, la, releaseMajor, "GEM_AMC.GEM_SYSTEM.RELEASE.MAJOR");
+      return releaseMajor.read();
+    }
+    REG_SINGLE(numOfOh, la, numOfOh, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    return numOfOh.read();
+  }
+
+  /*! Returns a field of the call context, from the shared one if it is fresh, or from the hardware */
+  uint32_t field(localArgs * la, hwContextField field, uint32_t hwContext::* member)
+  {
+    hwContext & hw = current(la);
+    if (hw.valid & field)
+      return hw.*member;
+
+    if (!sharedFresh() || !(s_shared.ctx.valid & field)) {
+      const uint32_t value = readField(la, field);
+      if (value == 0xdeaddead)
+        return value;
+      if (!sharedFresh()) {
+        s_shared            = sharedIdentity();
+        s_shared.ctx.epoch  = s_epoch;
+        s_shared.generation = addressTableGeneration();
+        s_shared.time       = std::chrono::steady_clock::now();
+      }
+      s_shared.ctx.*member = value;
+      s_shared.ctx.valid  |= field;
+    }
+    hw.*member = s_shared.ctx.*member;
+    hw.valid  |= field;
+    return hw.*member;
+  }
+}
+
+uint64_t hwContextEpoch()
+{
+  return s_epoch;
+}
+
+void hwContextInvalidate()
+{
+  ++s_epoch;
+}
+
+uint32_t hwFwMajor(localArgs * la)
+{
+  return field(la, HW_CTX_FW_MAJOR, &hwContext::fwMajor);
+}
+
+uint32_t hwNumOfOH(localArgs * la)
+{
+  return field(la, HW_CTX_NUM_OF_OH, &hwContext::numOfOh);
+}
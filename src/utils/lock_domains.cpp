@@ -0,0 +1,101 @@
+/*!
+ * \file utils/lock_domains.cpp
+ * \brief Memhub lock domains derived from the address table
+ */
+
+#include "utils/lock_domains.h"
+#include "memhub.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+  struct lockDomain {
+    uint64_t    base;
+    uint64_t    last;
+    std::string name;
+  };
+
+  /*! Returns the module a register is attributed to: its first two levels, plus the third one if it is arrayed */
+  std::string domainName(const std::string & name)
+  {
+    size_t end = name.find('.');
+    if (end == std::string::npos)
+      return name;
+    end = name.find('.', end+1);
+    if (end == std::string::npos)
+      return name;
+    size_t next = name.find('.', end+1);
+    if (next == std::string::npos)
+      next = name.size();
+    if (next > end+1 && std::isdigit(static_cast<unsigned char>(name[next-1])) && !std::isdigit(static_cast<unsigned char>(name[end+1])))
+      return name.substr(0, next);
+    return name.substr(0, end);
+  }
+}
+
+size_t buildLockDomains(const std::unordered_map<std::string, xhal::utils::Node> & nodes, const std::string & path)
+{
+  std::vector<std::string> names;
+  names.reserve(nodes.size());
+  for (auto const& it : nodes)
+    names.push_back(it.first);
+  std::sort(names.begin(), names.end());
+
+  std::unordered_map<std::string, lockDomain> modules;
+  for (size_t i = 0; i < names.size(); ++i) {
+    // only the leaves carry register addresses, modules are prefixes of the following names
+    if (i+1 < names.size() && names[i+1].compare(0, names[i].size()+1, names[i]+".") == 0)
+      continue;
+    const regDescriptor desc = makeRegDescriptor(nodes.at(names[i]));
+    const uint64_t last = desc.address + 4ULL*std::max<uint32_t>(desc.size, 1) - 1;
+    const std::string module = domainName(names[i]);
+    auto it = modules.find(module);
+    if (it == modules.end()) {
+      modules[module] = {desc.address, last, module};
+    } else {
+      it->second.base = std::min<uint64_t>(it->second.base, desc.address);
+      it->second.last = std::max(it->second.last, last);
+    }
+  }
+
+  std::vector<lockDomain> domains;
+  for (auto const& it : modules)
+    domains.push_back(it.second);
+  std::sort(domains.begin(), domains.end(), [](const lockDomain& a, const lockDomain& b) { return a.base < b.base; });
+
+  std::vector<lockDomain> merged;
+  for (auto const& d : domains) {
+    if (!merged.empty() && d.base <= merged.back().last) {
+      merged.back().last  = std::max(merged.back().last, d.last);
+      merged.back().name += "+" + d.name;
+    } else {
+      merged.push_back(d);
+    }
+  }
+  while (merged.size() > MEMHUB_MAX_DOMAINS) {
+    size_t closest = 0;
+    for (size_t i = 1; i+1 < merged.size(); ++i)
+      if (merged[i+1].base - merged[i].last < merged[closest+1].base - merged[closest].last)
+        closest = i;
+    merged[closest].last  = merged[closest+1].last;
+    merged[closest].name += "+" + merged[closest+1].name;
+    merged.erase(merged.begin() + closest + 1);
+  }
+
+  const std::string tmp = path + ".tmp";
+  FILE* f = std::fopen(tmp.c_str(), "w");
+  if (!f)
+    return 0;
+  std::fprintf(f, "# memhub lock domains: first and last byte address, module\n");
+  for (auto const& d : merged)
+    std::fprintf(f, "0x%08x 0x%08x %s\n", static_cast<uint32_t>(d.base), static_cast<uint32_t>(d.last), d.name.c_str());
+  if (std::fclose(f) != 0 || std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    return 0;
+  }
+  return merged.size();
+}
@@ -0,0 +1,586 @@
+/*!
+ * \file utils/reg_index.cpp
+ * \brief Stable register IDs and the memory mapped register index
+ */
+
+#include "utils/reg_index.h"
+#include "utils/address_table.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+  /*! Index file found not to match a generation, looked for again only once the file has been replaced */
+  struct missingIndex {
+    uint64_t generation = 0;
+    bool     exists     = false;
+    dev_t    dev        = 0;
+    ino_t    ino        = 0;
+    time_t   mtime      = 0;
+    long     mtimeNsec  = 0;
+    off_t    size       = 0;
+  };
+
+  regIndex *   s_index = nullptr;
+  missingIndex s_missing;
+
+  /*! Identity of the file at path, following the address table link */
+  missingIndex indexFileState(const std::string & path, uint64_t generation)
+  {
+    missingIndex state;
+    state.generation = generation;
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0) {
+      state.exists    = true;
+      state.dev       = st.st_dev;
+      state.ino       = st.st_ino;
+      state.mtime     = st.st_mtim.tv_sec;
+      state.mtimeNsec = st.st_mtim.tv_nsec;
+      state.size      = st.st_size;
+    }
+    return state;
+  }
+
+  bool sameIndexFile(const missingIndex & a, const missingIndex & b)
+  {
+    return a.generation == b.generation && a.exists == b.exists && a.dev == b.dev && a.ino == b.ino &&
+           a.mtime == b.mtime && a.mtimeNsec == b.mtimeNsec && a.size == b.size;
+  }
+
+  std::string regIndexPath()
+  {
+    const char* gem_path = std::getenv("GEM_PATH");
+    return std::string(gem_path ? gem_path : ".") + "/" + ADDRESS_TABLE_LINK + "/" + REG_INDEX_FILE;
+  }
+
+  inline uint64_t fmix64(uint64_t h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  /*! Seeded FNV-1a hash of the register name, finalised so that all the bits are usable */
+  inline uint64_t nameHash(const char* name, size_t len, uint32_t seed)
+  {
+    uint64_t hash = 0xcbf29ce484222325ULL ^ (static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ULL);
+    for (size_t i = 0; i < len; ++i) {
+      hash ^= static_cast<uint8_t>(name[i]);
+      hash *= 0x100000001b3ULL;
+    }
+    return fmix64(hash);
+  }
+
+  inline uint32_t hashBucket(uint64_t hash, uint32_t nBuckets)
+  {
+    return (hash >> 32) % nBuckets;
+  }
+
+  inline uint32_t hashSlot(uint64_t hash, uint32_t pilot, uint32_t nSlots)
+  {
+    return fmix64(hash ^ (static_cast<uint64_t>(pilot) * 0x9e3779b97f4a7c15ULL)) % nSlots;
+  }
+
+  static constexpr uint32_t HASH_BUCKET_LOAD = 4;       ///< average number of names per bucket
+  static constexpr uint32_t HASH_MAX_PILOT   = 1 << 20; ///< displacements tried per bucket before changing the seed
+  static constexpr uint32_t HASH_MAX_SEEDS   = 32;
+
+  /*! CHD construction: buckets are placed largest first, each with the first displacement sending all its names to free slots */
+  bool buildHash(const std::vector<const std::string*> & names, uint32_t seed,
+                 std::vector<uint32_t> & pilots, std::vector<uint32_t> & slots)
+  {
+    const uint32_t n        = names.size();
+    const uint32_t nBuckets = n / HASH_BUCKET_LOAD + 1;
+    std::vector<uint64_t> hashes(n);
+    std::vector<std::vector<uint32_t> > buckets(nBuckets);
+    for (uint32_t id = 0; id < n; ++id) {
+      hashes[id] = nameHash(names[id]->data(), names[id]->size(), seed);
+      buckets[hashBucket(hashes[id], nBuckets)].push_back(id);
+    }
+    std::vector<uint32_t> order(nBuckets);
+    for (uint32_t b = 0; b < nBuckets; ++b)
+      order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    pilots.assign(nBuckets, 0);
+    slots.assign(n, REG_ID_INVALID);
+    std::vector<uint32_t> placed;
+    for (uint32_t b : order) {
+      const std::vector<uint32_t> & bucket = buckets[b];
+      if (bucket.empty())
+        break;
+      uint32_t pilot = 0;
+      for (; pilot < HASH_MAX_PILOT; ++pilot) {
+        placed.clear();
+        for (uint32_t id : bucket) {
+          const uint32_t slot = hashSlot(hashes[id], pilot, n);
+          if (slots[slot] != REG_ID_INVALID || std::find(placed.begin(), placed.end(), slot) != placed.end())
+            break;
+          placed.push_back(slot);
+        }
+        if (placed.size() == bucket.size())
+          break;
+      }
+      if (pilot == HASH_MAX_PILOT)
+        return false;
+      pilots[b] = pilot;
+      for (size_t i = 0; i < bucket.size(); ++i)
+        slots[placed[i]] = bucket[i];
+    }
+    return true;
+  }
+
+  size_t align8(size_t n)
+  {
+    return (n + 7) & ~size_t(7);
+  }
+
+  bool writeAll(int fd, const void* data, size_t size)
+  {
+    const char* p = static_cast<const char*>(data);
+    while (size) {
+      const ssize_t n = ::write(fd, p, size);
+      if (n < 0)
+        return false;
+      p    += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  /*! Returns true if the generation given in the request, if any, matches the index */
+  bool checkGeneration(const RPCMsg *request, RPCMsg *response, const regIndex & index)
+  {
+    if (!request->get_key_exists("generation"))
+      return true;
+    if (request->get_word("generation") == static_cast<uint32_t>(index.generation()))
+      return true;
+    regErrors().push(REG_ERR_STALE_IDS, nullptr, 0, 0, true, request->get_word("generation"),
+                     static_cast<uint32_t>(index.generation()));
+    return false;
+  }
+
+  const regIndex * requireRegIndex(LocalArgs * la)
+  {
+    const regIndex * index = getRegIndex(la);
+    if (!index)
+      regErrors().push(REG_ERR_NO_INDEX, regIndexPath(), 0, true);
+    return index;
+  }
+}
+
+uint32_t regIndex::find(const std::string & regName) const
+{
+  if (m_slots) {
+    const uint64_t hash = nameHash(regName.data(), regName.size(), m_hashSeed);
+    const uint32_t id   = m_slots[hashSlot(hash, m_pilots[hashBucket(hash, m_nBuckets)], m_nRegs)];
+    return (std::strcmp(name(id), regName.c_str()) == 0) ? id : REG_ID_INVALID;
+  }
+
+  uint32_t lo = 0, hi = m_nRegs;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    const int cmp = std::strcmp(name(mid), regName.c_str());
+    if (cmp == 0)
+      return mid;
+    if (cmp < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return REG_ID_INVALID;
+}
+
+void regIndex::findAddress(uint32_t address, std::vector<uint32_t> & ids) const
+{
+  ids.clear();
+  const uint32_t* end  = m_byAddress + m_nByAddress;
+  const uint32_t* last = std::upper_bound(m_byAddress, end, address,
+                                          [this](uint32_t a, uint32_t id) { return a < m_descs[id].address; });
+  if (last == m_byAddress)
+    return;
+  // no register before the first one whose running end is below address can reach it
+  const uint32_t start = m_descs[*(last-1)].address;
+  for (const uint32_t* it = last; it != m_byAddress; ) {
+    --it;
+    if (m_addressEnds ? (m_addressEnds[it - m_byAddress] < address) : (m_descs[*it].address != start))
+      break;
+    if ((address - m_descs[*it].address) / 4 < regWords(m_descs[*it]))
+      ids.push_back(*it);
+  }
+  std::sort(ids.begin(), ids.end());
+}
+
+bool regIndex::map(const std::string & path)
+{
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(regIndexHeader)) {
+    ::close(fd);
+    return false;
+  }
+  void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    return false;
+  m_map     = addr;
+  m_mapSize = st.st_size;
+
+  const char* base = static_cast<const char*>(addr);
+  const regIndexHeader* hdr = reinterpret_cast<const regIndexHeader*>(base);
+  if (hdr->magic != REG_INDEX_MAGIC || hdr->version != REG_INDEX_VERSION) {
+    unmap();
+    return false;
+  }
+  for (uint32_t s = 0; s < REG_INDEX_N_SECTIONS; ++s) {
+    if (hdr->sections[s].offset > m_mapSize || hdr->sections[s].size > m_mapSize - hdr->sections[s].offset) {
+      unmap();
+      return false;
+    }
+  }
+
+  const uint64_t nRegs     = hdr->nRegs;
+  const auto &   names     = hdr->sections[REG_INDEX_NAMES];
+  const uint32_t* offsets  = reinterpret_cast<const uint32_t*>(base + hdr->sections[REG_INDEX_NAME_OFFSETS].offset);
+  if (hdr->sections[REG_INDEX_DESCRIPTORS].size != nRegs * sizeof(regDescriptor)
+      || hdr->sections[REG_INDEX_NAME_OFFSETS].size != nRegs * sizeof(uint32_t)
+      || (nRegs && (names.size == 0 || base[names.offset + names.size - 1] != '\0'))) {
+    unmap();
+    return false;
+  }
+  for (uint64_t id = 0; id < nRegs; ++id) {
+    if (offsets[id] >= names.size) {
+      unmap();
+      return false;
+    }
+  }
+
+  // the hash is optional, but must be complete if present
+  const auto & pilots = hdr->sections[REG_INDEX_HASH_PILOTS];
+  const auto & slots  = hdr->sections[REG_INDEX_HASH_SLOTS];
+  if (nRegs && pilots.size && slots.size == nRegs * sizeof(uint32_t) && pilots.size % sizeof(uint32_t) == 0) {
+    const uint32_t* slotIds = reinterpret_cast<const uint32_t*>(base + slots.offset);
+    bool valid = true;
+    for (uint64_t slot = 0; valid && slot < nRegs; ++slot)
+      valid = slotIds[slot] < nRegs;
+    if (valid) {
+      m_hashSeed = hdr->hashSeed;
+      m_nBuckets = pilots.size / sizeof(uint32_t);
+      m_pilots   = reinterpret_cast<const uint32_t*>(base + pilots.offset);
+      m_slots    = slotIds;
+    }
+  }
+
+  const auto & byAddress = hdr->sections[REG_INDEX_BY_ADDRESS];
+  if (byAddress.size % sizeof(uint32_t) == 0) {
+    const uint32_t* addrIds = reinterpret_cast<const uint32_t*>(base + byAddress.offset);
+    const uint32_t  n       = byAddress.size / sizeof(uint32_t);
+    bool valid = true;
+    for (uint32_t i = 0; valid && i < n; ++i)
+      valid = addrIds[i] < nRegs;
+    if (valid) {
+      m_nByAddress = n;
+      m_byAddress  = addrIds;
+      if (hdr->sections[REG_INDEX_ADDRESS_ENDS].size == byAddress.size)
+        m_addressEnds = reinterpret_cast<const uint32_t*>(base + hdr->sections[REG_INDEX_ADDRESS_ENDS].offset);
+    }
+  }
+
+  m_generation  = hdr->generation;
+  m_nRegs       = hdr->nRegs;
+  m_descs       = reinterpret_cast<const regDescriptor*>(base + hdr->sections[REG_INDEX_DESCRIPTORS].offset);
+  m_nameOffsets = offsets;
+  m_names       = base + names.offset;
+  return true;
+}
+
+void regIndex::unmap()
+{
+  if (m_map)
+    ::munmap(m_map, m_mapSize);
+  *this = regIndex();
+}
+
+const regIndex * regIndex::open(uint64_t generation)
+{
+  if (s_index && s_index->m_map && s_index->m_generation == generation)
+    return s_index;
+  // patchAddressTable commits the generation before renaming its index into place: a miss is only remembered
+  // until the index file changes, so that a call between the two steps does not lose the index
+  const std::string path = regIndexPath();
+  const missingIndex state = indexFileState(path, generation);
+  if (sameIndexFile(state, s_missing))
+    return nullptr;
+
+  if (!s_index)
+    s_index = new regIndex();
+  s_index->unmap();
+  if (s_index->map(path) && s_index->m_generation == generation) {
+    LOGGER->log_message(LogManager::INFO, stdsprintf("Register index %s mapped, %u registers", path.c_str(), s_index->m_nRegs));
+    return s_index;
+  }
+  s_index->unmap();
+  s_missing = state;
+  LOGGER->log_message(LogManager::WARNING, stdsprintf("No register index matching the address table in %s", path.c_str()));
+  return nullptr;
+}
+
+const regIndex * getRegIndex(LocalArgs * la)
+{
+  (void)la; // the generation is the one of the snapshot taken by getLocalArgs
+  return regIndex::open(addressTableGeneration());
+}
+
+size_t buildRegIndex(const std::unordered_map<std::string, xhal::utils::Node> & nodes, uint64_t generation, const std::string & path)
+{
+  std::vector<const std::string*> names;
+  names.reserve(nodes.size());
+  for (auto const& it : nodes)
+    names.push_back(&it.first);
+  std::sort(names.begin(), names.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
+
+  std::vector<regDescriptor> descs;
+  std::vector<uint32_t> offsets;
+  std::vector<char> blob;
+  descs.reserve(names.size());
+  offsets.reserve(names.size());
+  for (auto const* name : names) {
+    descs.push_back(makeRegDescriptor(nodes.at(*name)));
+    offsets.push_back(blob.size());
+    blob.insert(blob.end(), name->c_str(), name->c_str() + name->size() + 1);
+  }
+
+  std::vector<uint32_t> byAddress;
+  for (uint32_t id = 0; id < descs.size(); ++id) {
+    if (descs[id].perm != REG_PERM_NONE)
+      byAddress.push_back(id);
+  }
+  std::stable_sort(byAddress.begin(), byAddress.end(),
+                   [&descs](uint32_t a, uint32_t b) { return descs[a].address < descs[b].address; });
+  std::vector<uint32_t> addressEnds;
+  uint32_t maxEnd = 0;
+  for (uint32_t id : byAddress) {
+    const uint64_t last = descs[id].address + 4ULL * regWords(descs[id]) - 1;
+    maxEnd = std::max(maxEnd, static_cast<uint32_t>(std::min<uint64_t>(last, 0xFFFFFFFF)));
+    addressEnds.push_back(maxEnd);
+  }
+
+  std::vector<uint32_t> pilots, slots;
+  uint32_t seed = 0;
+  while (seed < HASH_MAX_SEEDS && !names.empty() && !buildHash(names, seed, pilots, slots))
+    ++seed;
+  if (seed == HASH_MAX_SEEDS) {
+    LOGGER->log_message(LogManager::WARNING, "Unable to build the register name hash, names will be looked up by bisection");
+    pilots.clear();
+    slots.clear();
+  }
+
+  regIndexHeader hdr = {};
+  hdr.magic      = REG_INDEX_MAGIC;
+  hdr.version    = REG_INDEX_VERSION;
+  hdr.generation = generation;
+  hdr.nRegs      = names.size();
+  hdr.hashSeed   = seed;
+  const void* data[REG_INDEX_N_SECTIONS] = {descs.data(), offsets.data(), blob.data(), pilots.data(), slots.data(),
+                                            byAddress.data(), addressEnds.data()};
+  hdr.sections[REG_INDEX_DESCRIPTORS].size  = descs.size() * sizeof(regDescriptor);
+  hdr.sections[REG_INDEX_NAME_OFFSETS].size = offsets.size() * sizeof(uint32_t);
+  hdr.sections[REG_INDEX_NAMES].size        = blob.size();
+  hdr.sections[REG_INDEX_HASH_PILOTS].size  = pilots.size() * sizeof(uint32_t);
+  hdr.sections[REG_INDEX_HASH_SLOTS].size   = slots.size() * sizeof(uint32_t);
+  hdr.sections[REG_INDEX_BY_ADDRESS].size   = byAddress.size() * sizeof(uint32_t);
+  hdr.sections[REG_INDEX_ADDRESS_ENDS].size = addressEnds.size() * sizeof(uint32_t);
+  uint64_t offset = align8(sizeof(hdr));
+  for (uint32_t s = 0; s < REG_INDEX_N_SECTIONS; ++s) {
+    if (!hdr.sections[s].size)
+      continue;
+    hdr.sections[s].offset = offset;
+    offset = align8(offset + hdr.sections[s].size);
+  }
+
+  const std::string tmp = path + ".tmp";
+  const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664);
+  if (fd < 0) {
+    LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to create %s: %s", tmp.c_str(), std::strerror(errno)));
+    return 0;
+  }
+  static const char zeros[8] = {0};
+  bool ok = writeAll(fd, &hdr, sizeof(hdr)) && writeAll(fd, zeros, align8(sizeof(hdr)) - sizeof(hdr));
+  for (uint32_t s = 0; ok && s < REG_INDEX_N_SECTIONS; ++s) {
+    if (hdr.sections[s].size)
+      ok = writeAll(fd, data[s], hdr.sections[s].size) && writeAll(fd, zeros, align8(hdr.sections[s].size) - hdr.sections[s].size);
+  }
+  ok = (::fsync(fd) == 0) && ok;
+  ok = (::close(fd) == 0) && ok;
+  if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+    LOGGER->log_message(LogManager::ERROR, stdsprintf("Unable to write %s: %s", path.c_str(), std::strerror(errno)));
+    std::remove(tmp.c_str());
+    return 0;
+  }
+  return names.size();
+}
+
+void resolveRegs(const RPCMsg *request, RPCMsg *response)
+{
+  LocalArgs la = getLocalArgs(response);
+  const regIndex * index = requireRegIndex(&la);
+  if (!index)
+    return;
+
+  const std::vector<std::string> regNames = request->get_string_array("names");
+  const size_t n = regNames.size();
+  std::vector<uint32_t> ids(n), addresses(n), masks(n), sizes(n), flags(n);
+  for (size_t i = 0; i < n; ++i) {
+    ids[i] = index->find(regNames[i]);
+    if (ids[i] == REG_ID_INVALID) {
+      regErrors().push(REG_ERR_NOT_FOUND, regNames[i], 0, true);
+      continue;
+    }
+    const regDescriptor & desc = index->descriptor(ids[i]);
+    addresses[i] = desc.address;
+    masks[i]     = desc.mask;
+    sizes[i]     = desc.size;
+    flags[i]     = desc.perm | (static_cast<uint32_t>(desc.mode) << 8);
+  }
+  response->set_word_array("ids",       ids);
+  response->set_word_array("addresses", addresses);
+  response->set_word_array("masks",     masks);
+  response->set_word_array("sizes",     sizes);
+  response->set_word_array("flags",     flags);
+  response->set_word("generation", static_cast<uint32_t>(index->generation()));
+}
+
+void readRegsById(const RPCMsg *request, RPCMsg *response)
+{
+  LocalArgs la = getLocalArgs(response);
+  const regIndex * index = requireRegIndex(&la);
+  if (!index || !checkGeneration(request, response, *index))
+    return;
+
+  const std::vector<uint32_t> ids = request->get_word_array("ids");
+  std::vector<uint32_t> result(ids.size(), 0xdeaddead);
+  std::vector<uint32_t> addrs, slots;
+  addrs.reserve(ids.size());
+  slots.reserve(ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] >= index->size()) {
+      regErrors().push(REG_ERR_ID_RANGE, nullptr, 0, 0, false, ids[i], index->size());
+      continue;
+    }
+    const regDescriptor & desc = index->descriptor(ids[i]);
+    if (!(desc.perm & REG_PERM_READ)) {
+      const char* name = index->name(ids[i]);
+      regErrors().push(REG_ERR_NO_READ_PERM, name, std::strlen(name), desc.address, false, desc.perm);
+      continue;
+    }
+    addrs.push_back(desc.address);
+    slots.push_back(i);
+  }
+
+  std::vector<uint32_t> data(addrs.size());
+  if (!addrs.empty() && memhub_list_read(memsvc, addrs.data(), addrs.size(), data.data()) != 0) {
+    regErrors().push(REG_ERR_READ, nullptr, 0, addrs.front(), true, static_cast<uint32_t>(addrs.size()));
+  } else {
+    for (size_t r = 0; r < slots.size(); ++r) {
+      const regDescriptor & desc = index->descriptor(ids[slots[r]]);
+      result[slots[r]] = (desc.mask != 0xFFFFFFFF) ? ((data[r] & desc.mask) >> desc.shift) : data[r];
+    }
+  }
+  response->set_word_array("data", result);
+}
+
+void writeRegsById(const RPCMsg *request, RPCMsg *response)
+{
+  LocalArgs la = getLocalArgs(response);
+  const regIndex * index = requireRegIndex(&la);
+  if (!index || !checkGeneration(request, response, *index))
+    return;
+
+  const std::vector<uint32_t> ids    = request->get_word_array("ids");
+  const std::vector<uint32_t> values = request->get_word_array("data");
+  if (ids.size() != values.size()) {
+    regErrors().push(REG_ERR_BAD_REQUEST, "data", 4, 0, true);
+    return;
+  }
+
+  std::vector<uint32_t> failed;
+  std::vector<uint32_t> addrs, masks, words, slots;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] >= index->size()) {
+      regErrors().push(REG_ERR_ID_RANGE, nullptr, 0, 0, true, ids[i], index->size());
+      failed.push_back(i);
+      continue;
+    }
+    const regDescriptor & desc = index->descriptor(ids[i]);
+    if (!(desc.perm & REG_PERM_WRITE)) {
+      const char* name = index->name(ids[i]);
+      regErrors().push(REG_ERR_NO_WRITE_PERM, name, std::strlen(name), desc.address, true, desc.perm);
+      failed.push_back(i);
+      continue;
+    }
+    addrs.push_back(desc.address);
+    masks.push_back(desc.mask);
+    words.push_back(values[i] << desc.shift);
+    slots.push_back(i);
+  }
+
+  std::vector<uint32_t> writeFailed(addrs.size());
+  const uint32_t nWriteFailed = addrs.empty() ? 0
+      : memhub_list_write_masked(memsvc, addrs.data(), masks.data(), words.data(), addrs.size(), writeFailed.data());
+  for (uint32_t f = 0; f < nWriteFailed; ++f) {
+    const uint32_t slot = slots[writeFailed[f]];
+    const char* name = index->name(ids[slot]);
+    regErrors().push(REG_ERR_WRITE, name, std::strlen(name), addrs[writeFailed[f]], true, 1);
+    failed.push_back(slot);
+  }
+
+  if (!failed.empty()) {
+    std::sort(failed.begin(), failed.end());
+    response->set_word_array("failed", failed);
+  }
+}
+
+void addressToName(const RPCMsg *request, RPCMsg *response)
+{
+  LocalArgs la = getLocalArgs(response);
+  const regIndex * index = requireRegIndex(&la);
+  if (!index)
+    return;
+
+  const std::vector<uint32_t> addresses = request->get_word_array("addresses");
+  std::vector<uint32_t> counts(addresses.size()), ids, masks, flags;
+  std::vector<std::string> names;
+  std::vector<uint32_t> found;
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    index->findAddress(addresses[i], found);
+    counts[i] = found.size();
+    if (found.empty())
+      regErrors().push(REG_ERR_NO_REG_AT_ADDR, nullptr, 0, addresses[i], true);
+    for (uint32_t id : found) {
+      const regDescriptor & desc = index->descriptor(id);
+      names.push_back(index->name(id));
+      ids.push_back(id);
+      masks.push_back(desc.mask);
+      flags.push_back(desc.perm | (static_cast<uint32_t>(desc.mode) << 8));
+    }
+  }
+  response->set_word_array("counts", counts);
+  response->set_string_array("names", names);
+  response->set_word_array("ids",    ids);
+  response->set_word_array("masks",  masks);
+  response->set_word_array("flags",  flags);
+}
@@ -0,0 +1,183 @@
+/*!
+ * \file utils/static_regs.cpp
+ * \brief Compile-time register descriptors generated from the address table, enabled by GEM_STATIC_REGS
+ */
+
+#include "utils/static_regs.h"
+
+namespace {
+  /*! \struct staticRegsState
+   *  Outcome of the last comparison of the static registers with the address table
+   */
+  struct staticRegsState {
+    bool     checked{false};
+    uint64_t generation{0};
+    bool     match{false};
+  };
+
+  staticRegsState s_static;
+
+  /*! Refuses the accesses until staticRegsMatch validated the current address table */
+  bool usable(const staticReg & reg, uint32_t address)
+  {
+    if (!s_static.checked || s_static.generation != addressTableGeneration() || !s_static.match) {
+      regErrors().push(REG_ERR_STATIC_REGS, reg.name, std::strlen(reg.name), address, true);
+      return false;
+    }
+    if (address == 0xdeaddead) {
+      regErrors().push(REG_ERR_NOT_FOUND, reg.name, std::strlen(reg.name), 0, true);
+      return false;
+    }
+    return true;
+  }
+
+#ifdef GEM_STATIC_REGS
+  /*! Name of the member of a family pattern with the given indices */
+  std::string memberName(const char * pattern, const uint32_t * idx)
+  {
+    std::string name;
+    size_t d = 0;
+    for (const char * c = pattern; *c; ++c) {
+      if (*c == '*')
+        name += std::to_string(idx[d++]);
+      else
+        name += *c;
+    }
+    return name;
+  }
+
+  bool sameLayout(const regDescriptor & desc, const staticReg & reg, uint32_t address)
+  {
+    return desc.address == address && desc.mask == reg.mask && desc.perm == reg.perm && desc.mode == reg.mode &&
+           desc.size == reg.size;
+  }
+
+  /*! Resolves a static register in the address table, returns false if it is missing or does not match */
+  bool resolve(LocalArgs * la, const staticReg & reg, staticReg & runtime)
+  {
+    runtime = reg;
+    if (reg.nDims == 0) {
+      const regDescriptor* desc = getRegDescriptor(la, reg.name);
+      if (!desc)
+        return false;
+      runtime.base  = desc->address;
+      runtime.mask  = desc->mask;
+      runtime.shift = desc->shift;
+      runtime.perm  = desc->perm;
+      runtime.mode  = desc->mode;
+      runtime.size  = desc->size;
+      return true;
+    }
+
+    const regFamily fam(la, reg.name);
+    if (fam.indexed()) {
+      const regFamilyDescriptor & layout = fam.layout();
+      runtime.base  = layout.desc.address;
+      runtime.mask  = layout.desc.mask;
+      runtime.shift = layout.desc.shift;
+      runtime.perm  = layout.desc.perm;
+      runtime.mode  = layout.desc.mode;
+      runtime.size  = layout.desc.size;
+      runtime.nDims = layout.nDims;
+      for (size_t d = 0; d < REG_FAMILY_MAX_DIMS; ++d) {
+        runtime.first[d]  = layout.first[d];
+        runtime.count[d]  = layout.count[d];
+        runtime.stride[d] = layout.stride[d];
+      }
+      return true;
+    }
+
+    // family not indexed by the address table: every member is looked up by name
+    uint32_t idx[REG_FAMILY_MAX_DIMS];
+    for (size_t d = 0; d < reg.nDims; ++d) {
+      if (reg.count[d] == 0)
+        return false;
+      idx[d] = reg.first[d];
+    }
+    while (true) {
+      int64_t address = reg.base;
+      for (size_t d = 0; d < reg.nDims; ++d)
+        address += static_cast<int64_t>(idx[d] - reg.first[d]) * reg.stride[d];
+      const regDescriptor* desc = getRegDescriptor(la, memberName(reg.name, idx));
+      if (!desc || !sameLayout(*desc, reg, static_cast<uint32_t>(address)))
+        return false;
+      size_t d = reg.nDims;
+      while (d-- > 0 && ++idx[d] == reg.first[d] + reg.count[d])
+        idx[d] = reg.first[d];
+      if (d == static_cast<size_t>(-1))
+        return true;
+    }
+  }
+
+  bool compare(LocalArgs * la)
+  {
+    std::vector<staticReg> runtime(static_regs::N_REGS);
+    std::vector<const staticReg*> regs(static_regs::N_REGS);
+    bool resolved = true;
+    for (size_t r = 0; r < static_regs::N_REGS; ++r) {
+      if (!resolve(la, *static_regs::ALL[r], runtime[r])) {
+        LOGGER->log_message(LogManager::ERROR, stdsprintf("Static register %s is not in the address table, or has a different layout",
+                                                          static_regs::ALL[r]->name));
+        resolved = false;
+      }
+      regs[r] = &runtime[r];
+    }
+    const uint64_t checksum = staticRegsChecksum(regs.data(), regs.size());
+    if (!resolved || checksum != static_regs::CHECKSUM) {
+      LOGGER->log_message(LogManager::ERROR, stdsprintf("Static registers generated from %s (checksum 0x%016llx) do not match the address table (checksum 0x%016llx)",
+                                                        static_regs::SOURCE, static_cast<unsigned long long>(static_regs::CHECKSUM),
+                                                        static_cast<unsigned long long>(checksum)));
+      return false;
+    }
+    LOGGER->log_message(LogManager::INFO, stdsprintf("%d static registers match the address table", static_cast<int>(static_regs::N_REGS)));
+    return true;
+  }
+#endif
+}
+
+bool staticRegsMatch(LocalArgs * la)
+{
+  const uint64_t generation = addressTableGeneration();
+  if (!s_static.checked || s_static.generation != generation) {
+#ifdef GEM_STATIC_REGS
+    s_static.match = compare(la);
+#else
+    s_static.match = true;
+#endif
+    s_static.generation = generation;
+    s_static.checked    = true;
+  }
+  if (!s_static.match)
+    regErrors().push(REG_ERR_STATIC_REGS, nullptr, 0, 0, true);
+  return s_static.match;
+}
+
+regError staticReg::readStaticReg(const staticReg & reg, uint32_t address, uint32_t & value)
+{
+  if (!usable(reg, address))
+    return regErrors().last();
+  if (!(reg.perm & REG_PERM_READ)) {
+    regErrors().push(REG_ERR_NO_READ_PERM, reg.name, std::strlen(reg.name), address, false, reg.perm);
+    return REG_ERR_NO_READ_PERM;
+  }
+  uint32_t data[1];
+  if (memhub_read(memsvc, address, 1, data) != 0) {
+    regErrors().push(REG_ERR_READ, reg.name, std::strlen(reg.name), address, false, 1);
+    return REG_ERR_READ;
+  }
+  value = (reg.mask != 0xFFFFFFFF) ? ((data[0] & reg.mask) >> reg.shift) : data[0];
+  return REG_OK;
+}
+
+void staticReg::writeStaticReg(const staticReg & reg, uint32_t address, uint32_t value)
+{
+  if (!usable(reg, address))
+    return;
+  if (!(reg.perm & REG_PERM_WRITE)) {
+    regErrors().push(REG_ERR_NO_WRITE_PERM, reg.name, std::strlen(reg.name), address, true, reg.perm);
+    return;
+  }
+  // a plain write for full words, a read-modify-write under the memhub lock for fields
+  if (memhub_write_masked(memsvc, address, reg.mask, value << reg.shift) != 0)
+    regErrors().push(REG_ERR_WRITE, reg.name, std::strlen(reg.name), address, true, 1);
+}
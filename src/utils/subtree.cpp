@@ -0,0 +1,119 @@
+/*!
+ * \file utils/subtree.cpp
+ * \brief Bulk reads of all the registers below an address table node
+ */
+
+#include "utils/subtree.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+  /*! \struct subtreeCache
+   *  Per-process cache of the subtree expansions, dropped when the address table generation changes
+   */
+  struct subtreeCache {
+    uint64_t                                                  generation{0};
+    std::unordered_map<std::string, std::vector<subtreeReg> > expansions;
+  };
+
+  subtreeCache s_subtrees;
+
+  bool isBelow(const std::string & name, const std::string & node)
+  {
+    return name.size() > node.size() && name[node.size()] == '.' && name.compare(0, node.size(), node) == 0;
+  }
+}
+
+const std::vector<subtreeReg> & expandSubtree(LocalArgs * la, const std::string & prefix)
+{
+  const uint64_t generation = addressTableGeneration();
+  if (generation != s_subtrees.generation || s_subtrees.expansions.size() >= SUBTREE_CACHE_SIZE) {
+    s_subtrees.expansions.clear();
+    s_subtrees.generation = generation;
+  }
+  auto it = s_subtrees.expansions.find(prefix);
+  if (it != s_subtrees.expansions.end())
+    return it->second;
+
+  // all the nodes at or below the prefix, in key order
+  std::vector<subtreeReg> nodes;
+  auto cursor = lmdb::cursor::open(la->rtxn, la->dbi);
+  lmdb::val key, value;
+  key.assign(prefix);
+  for (bool found = cursor.get(key, value, MDB_SET_RANGE); found; found = cursor.get(key, value, MDB_NEXT)) {
+    const std::string name(key.data(), key.size());
+    if (name != prefix && !isBelow(name, prefix)) {
+      // keys extending the prefix with a character sorting before '.' can sit before the subtree, the ones
+      // extending it with a later character (OH10 after OH1) come after it
+      if (name.compare(0, prefix.size(), prefix) == 0 && name[prefix.size()] < '.')
+        continue;
+      break;
+    }
+    const regDescriptor* desc = decodeRegDescriptor(value);
+    if (desc)
+      nodes.push_back({name, *desc});
+  }
+  cursor.close();
+
+  std::vector<subtreeReg> & regs = s_subtrees.expansions[prefix];
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const std::string children = nodes[i].name + ".";
+    auto child = std::lower_bound(nodes.begin(), nodes.end(), children,
+                                  [](const subtreeReg & r, const std::string & n) { return r.name < n; });
+    if (child != nodes.end() && isBelow(child->name, nodes[i].name))
+      continue;
+    const regDescriptor & desc = nodes[i].desc;
+    if ((desc.perm & REG_PERM_READ) && desc.mode == REG_MODE_SINGLE)
+      regs.push_back(std::move(nodes[i]));
+  }
+  LOGGER->log_message(LogManager::DEBUG, stdsprintf("Subtree %s expanded to %d readable registers",
+                                                    prefix.c_str(), static_cast<int>(regs.size())));
+  return regs;
+}
+
+int readSubtreeLocal(const std::vector<subtreeReg> & regs, uint32_t * result)
+{
+  if (regs.empty())
+    return 0;
+  std::vector<uint32_t> addrs(regs.size());
+  for (size_t i = 0; i < regs.size(); ++i)
+    addrs[i] = regs[i].desc.address;
+  const int rc = memhub_list_read(memsvc, addrs.data(), addrs.size(), result);
+  if (rc != 0) {
+    std::fill(result, result + regs.size(), 0xdeaddead);
+    return rc;
+  }
+  for (size_t i = 0; i < regs.size(); ++i) {
+    const regDescriptor & desc = regs[i].desc;
+    if (desc.mask != 0xFFFFFFFF)
+      result[i] = (result[i] & desc.mask) >> desc.shift;
+  }
+  return 0;
+}
+
+void readSubtree(const RPCMsg *request, RPCMsg *response)
+{
+  LocalArgs la = getLocalArgs(response);
+  const std::string prefix = request->get_string("prefix");
+  if (prefix.empty()) {
+    regErrors().push(REG_ERR_BAD_REQUEST, "prefix", 6, 0, true);
+    return;
+  }
+
+  const std::vector<subtreeReg> & regs = expandSubtree(&la, prefix);
+  if (regs.empty()) {
+    regErrors().push(REG_ERR_EMPTY_SUBTREE, prefix, 0, true);
+    return;
+  }
+
+  std::vector<std::string> names;
+  names.reserve(regs.size());
+  for (auto const& r : regs)
+    names.push_back(r.name);
+  std::vector<uint32_t> data(regs.size());
+  if (readSubtreeLocal(regs, data.data()) != 0)
+    regErrors().push(REG_ERR_READ, prefix, 0, true, static_cast<uint32_t>(regs.size()));
+  response->set_string_array("names", names);
+  response->set_word_array("data", data);
+}
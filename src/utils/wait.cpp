@@ -0,0 +1,85 @@
+/*!
+ * \file utils/wait.cpp
+ * \brief Server-side polling of registers until a condition is met
+ */
+
+#include "utils/wait.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+  bool compare(uint32_t lhs, waitCondition cond, uint32_t rhs)
+  {
+    switch (cond) {
+    case WAIT_EQ: return lhs == rhs;
+    case WAIT_NE: return lhs != rhs;
+    case WAIT_LT: return lhs <  rhs;
+    case WAIT_LE: return lhs <= rhs;
+    case WAIT_GT: return lhs >  rhs;
+    case WAIT_GE: return lhs >= rhs;
+    }
+    return false;
+  }
+}
+
+bool waitForRegLocal(const regDescriptor & desc, uint32_t mask, waitCondition cond, uint32_t value, uint32_t timeout,
+                     waitResult & result, uint32_t maxInterval)
+{
+  typedef std::chrono::steady_clock clock;
+  const auto start = clock::now();
+  uint64_t interval = 1;
+  result = waitResult();
+  while (true) {
+    uint32_t data;
+    if (memhub_read(memsvc, desc.address, 1, &data) != 0)
+      return false;
+    ++result.polls;
+    result.value = (data & desc.mask) >> desc.shift;
+    result.met   = compare(result.value & mask, cond, value);
+    const uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+    result.elapsed = std::min<uint64_t>(elapsed, UINT32_MAX);
+    if (result.met || elapsed >= timeout)
+      return true;
+    std::this_thread::sleep_for(std::chrono::microseconds(std::min<uint64_t>(interval, timeout - elapsed)));
+    interval = std::min<uint64_t>(2*interval, std::max<uint32_t>(maxInterval, 1));
+  }
+}
+
+void waitForReg(const RPCMsg *request, RPCMsg *response)
+{
+  LocalArgs la = getLocalArgs(response);
+  const std::string regName = request->get_string("reg_name");
+  const uint32_t value       = request->get_word("value");
+  const uint32_t timeout     = request->get_word("timeout");
+  const uint32_t mask        = request->get_key_exists("mask") ? request->get_word("mask") : 0xFFFFFFFF;
+  const uint32_t cond        = request->get_key_exists("condition") ? request->get_word("condition") : WAIT_EQ;
+  const uint32_t maxInterval = request->get_key_exists("max_interval") ? request->get_word("max_interval") : WAIT_MAX_INTERVAL_US;
+
+  if (cond > WAIT_GE) {
+    regErrors().push(REG_ERR_WAIT_CONDITION, regName, 0, true, cond);
+    return;
+  }
+  const regDescriptor* desc = getRegDescriptor(&la, regName);
+  if (!desc) {
+    regErrors().push(REG_ERR_NOT_FOUND, regName, 0, true);
+    return;
+  }
+  if (!(desc->perm & REG_PERM_READ)) {
+    regErrors().push(REG_ERR_NO_READ_PERM, regName, desc->address, true, desc->perm);
+    return;
+  }
+
+  waitResult result;
+  if (!waitForRegLocal(*desc, mask, static_cast<waitCondition>(cond), value, timeout, result, maxInterval)) {
+    regErrors().push(REG_ERR_READ, regName, desc->address, true, 1);
+    return;
+  }
+  response->set_word("met",     result.met);
+  response->set_word("value",   result.value);
+  response->set_word("elapsed", result.elapsed);
+  response->set_word("polls",   result.polls);
+  if (!result.met)
+    regErrors().push(REG_ERR_TIMEOUT, regName, desc->address, true, mask, value, result.value);
+}
@@ -15,6 +15,7 @@
 #include <iomanip>
 #include <memory>
 #include "hw_constants.h"
+#include "utils/static_regs.h"
 
 uint32_t vfatSyncCheckLocal(localArgs * la, uint32_t ohN)
 {
@@ -33,15 +34,13 @@ uint32_t vfatSyncCheckLocal(localArgs * la, uint32_t ohN)
 
 void vfatSyncCheck(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
 
     uint32_t goodVFATs = vfatSyncCheckLocal(&la, ohN);
 
     response->set_word("goodVFATs", goodVFATs);
-
-    rtxn.abort();
 }
 
 void configureVFAT3DacMonitorLocal(localArgs *la, uint32_t ohN, uint32_t mask, uint32_t dacSelect){
@@ -77,7 +76,7 @@ void configureVFAT3DacMonitorLocal(localArgs *la, uint32_t ohN, uint32_t mask, u
 } //End configureVFAT3DacMonitorLocal(...)
 
 void configureVFAT3DacMonitor(const RPCMsg *request, RPCMsg *response){
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t vfatMask = request->get_word("vfatMask");
@@ -85,17 +84,15 @@ void configureVFAT3DacMonitor(const RPCMsg *request, RPCMsg *response){
 
     LOGGER->log_message(LogManager::INFO, stdsprintf("Programming VFAT3 ADC Monitoring for Selection %i",dacSelect));
     configureVFAT3DacMonitorLocal(&la, ohN, vfatMask, dacSelect);
-
-    rtxn.abort();
 } //End configureVFAT3DacMonitor()
 
 void configureVFAT3DacMonitorMultiLink(const RPCMsg *request, RPCMsg *response){
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohMask = request->get_word("ohMask");
     uint32_t dacSelect = request->get_word("dacSelect");
 
-    unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    unsigned int NOH = hwNumOfOH(&la);
     if (request->get_key_exists("NOH")){
         unsigned int NOH_requested = request->get_word("NOH");
         if (NOH_requested <= NOH)
@@ -115,8 +112,6 @@ void configureVFAT3DacMonitorMultiLink(const RPCMsg *request, RPCMsg *response){
         LOGGER->log_message(LogManager::INFO, stdsprintf("Programming VFAT3 ADC Monitoring on OH%i for Selection %i",ohN,dacSelect));
         configureVFAT3DacMonitorLocal(&la, ohN, vfatMask, dacSelect);
     } //End Loop over all Optohybrids
-
-    rtxn.abort();
 } //End configureVFAT3DacMonitorMultiLink()
 
 void configureVFAT3sLocal(localArgs * la, uint32_t ohN, uint32_t vfatMask) {
@@ -164,19 +159,18 @@ void configureVFAT3sLocal(localArgs * la, uint32_t ohN, uint32_t vfatMask) {
 }
 
 void configureVFAT3s(const RPCMsg *request, RPCMsg *response) {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t vfatMask = request->get_word("vfatMask");
 
     configureVFAT3sLocal(&la, ohN, vfatMask);
-    rtxn.abort();
 }
 
 void getChannelRegistersVFAT3(const RPCMsg *request, RPCMsg *response){
     LOGGER->log_message(LogManager::INFO, "Getting VFAT3 Channel Registers");
 
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t vfatMask = request->get_word("vfatMask");
@@ -186,8 +180,6 @@ void getChannelRegistersVFAT3(const RPCMsg *request, RPCMsg *response){
     getChannelRegistersVFAT3Local(&la, ohN, vfatMask, chanRegData);
 
     response->set_word_array("chanRegData",chanRegData,oh::VFATS_PER_OH*128);
-
-    rtxn.abort();
 } //End getChannelRegistersVFAT3()
 
 void getChannelRegistersVFAT3Local(localArgs *la, uint32_t ohN, uint32_t vfatMask, uint32_t *chanRegData){
@@ -195,6 +187,8 @@ void getChannelRegistersVFAT3Local(localArgs *la, uint32_t ohN, uint32_t vfatMas
     uint32_t notmask = ~vfatMask & 0xFFFFFF;
 
     char regBuf[200];
+    STATIC_REGS_CHECK(la, );
+    REG_FAMILY(chanRegs, la, vfatChannel, "GEM_AMC.OH.OH*.GEB.VFAT*.VFAT_CHANNELS.CHANNEL*");
     LOGGER->log_message(LogManager::INFO, "Read channel register settings");
     for(unsigned int vfatN=0; vfatN < oh::VFATS_PER_OH; ++vfatN){
         // Check if vfat is masked
@@ -211,17 +205,16 @@ void getChannelRegistersVFAT3Local(localArgs *la, uint32_t ohN, uint32_t vfatMas
         }
 
         //Loop over the channels
+        LOGGER->log_message(LogManager::INFO, stdsprintf("Reading channel registers for VFAT%i",vfatN));
         uint32_t chanAddr;
         for(unsigned int chan=0; chan < 128; ++chan){
             //Deterime the idx
             unsigned int idx = vfatN*128 + chan;
 
             //Get the address
-            sprintf(regBuf,"GEM_AMC.OH.OH%i.GEB.VFAT%i.VFAT_CHANNELS.CHANNEL%i",ohN,vfatN,chan);
-            chanAddr = getAddress(la, regBuf);
+            chanAddr = chanRegs.address(ohN, vfatN, chan);
 
             //Build the channel register
-            LOGGER->log_message(LogManager::INFO, stdsprintf("Reading channel register for VFAT%i chan %i",vfatN,chan));
             chanRegData[idx] = readRawAddress(chanAddr, la->response);
             std::this_thread::sleep_for(std::chrono::microseconds(200));
         } //End Loop over channels
@@ -246,7 +239,7 @@ void readVFAT3ADCLocal(localArgs * la, uint32_t * outData, uint32_t ohN, bool us
 } //End readVFAT3ADCLocal
 
 void readVFAT3ADC(const RPCMsg *request, RPCMsg *response){
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     bool useExtRefADC = request->get_word("useExtRefADC");
@@ -258,17 +251,15 @@ void readVFAT3ADC(const RPCMsg *request, RPCMsg *response){
     readVFAT3ADCLocal(&la, adcData, ohN, useExtRefADC, vfatMask);
 
     response->set_word_array("adcData",adcData,oh::VFATS_PER_OH);
-
-    rtxn.abort();
 } //End getChannelRegistersVFAT3()
 
 void readVFAT3ADCMultiLink(const RPCMsg *request, RPCMsg *response){
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohMask = request->get_word("ohMask");
     bool useExtRefADC = request->get_word("useExtRefADC");
 
-    unsigned int NOH = readReg(&la, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH");
+    unsigned int NOH = hwNumOfOH(&la);
     if (request->get_key_exists("NOH")){
         unsigned int NOH_requested = request->get_word("NOH");
         if (NOH_requested <= NOH)
@@ -297,8 +288,6 @@ void readVFAT3ADCMultiLink(const RPCMsg *request, RPCMsg *response){
     } //End Loop over all Optohybrids
 
     response->set_word_array("adcDataAll",adcDataAll,amc::OH_PER_AMC*oh::VFATS_PER_OH);
-
-    rtxn.abort();
 } //End readVFAT3ADCMultiLink()
 
 void setChannelRegistersVFAT3SimpleLocal(localArgs * la, uint32_t ohN, uint32_t vfatMask, uint32_t *chanRegData){
@@ -306,6 +295,8 @@ void setChannelRegistersVFAT3SimpleLocal(localArgs * la, uint32_t ohN, uint32_t
     uint32_t notmask = ~vfatMask & 0xFFFFFF;
 
     char regBuf[200];
+    STATIC_REGS_CHECK(la, );
+    REG_FAMILY(chanRegs, la, vfatChannel, "GEM_AMC.OH.OH*.GEB.VFAT*.VFAT_CHANNELS.CHANNEL*");
     LOGGER->log_message(LogManager::INFO, "Write channel register settings");
     for(unsigned int vfatN=0; vfatN < oh::VFATS_PER_OH; ++vfatN){
         // Check if vfat is masked
@@ -328,8 +319,7 @@ void setChannelRegistersVFAT3SimpleLocal(localArgs * la, uint32_t ohN, uint32_t
             unsigned int idx = vfatN*128 + chan;
 
             //Get the address
-            sprintf(regBuf,"GEM_AMC.OH.OH%i.GEB.VFAT%i.VFAT_CHANNELS.CHANNEL%i",ohN,vfatN,chan);
-            chanAddr = getAddress(la, regBuf);
+            chanAddr = chanRegs.address(ohN, vfatN, chan);
             writeRawAddress(chanAddr, chanRegData[idx], la->response);
             std::this_thread::sleep_for(std::chrono::microseconds(200));
         } //End Loop over channels
@@ -343,6 +333,8 @@ void setChannelRegistersVFAT3Local(localArgs * la, uint32_t ohN, uint32_t vfatMa
     uint32_t notmask = ~vfatMask & 0xFFFFFF;
 
     char regBuf[200];
+    STATIC_REGS_CHECK(la, );
+    REG_FAMILY(chanRegs, la, vfatChannel, "GEM_AMC.OH.OH*.GEB.VFAT*.VFAT_CHANNELS.CHANNEL*");
     LOGGER->log_message(LogManager::INFO, "Write channel register settings");
     for(unsigned int vfatN=0; vfatN < oh::VFATS_PER_OH; ++vfatN){
         // Check if vfat is masked
@@ -366,8 +358,7 @@ void setChannelRegistersVFAT3Local(localArgs * la, uint32_t ohN, uint32_t vfatMa
             unsigned int idx = vfatN*128 + chan;
 
             //Get the address
-            sprintf(regBuf,"GEM_AMC.OH.OH%i.GEB.VFAT%i.VFAT_CHANNELS.CHANNEL%i",ohN,vfatN,chan);
-            chanAddr = getAddress(la, regBuf);
+            chanAddr = chanRegs.address(ohN, vfatN, chan);
 
             //Check trim values make sense
             if ( trimARM[idx] > 0x3F || trimARM[idx] < 0x0){
@@ -382,7 +373,6 @@ void setChannelRegistersVFAT3Local(localArgs * la, uint32_t ohN, uint32_t vfatMa
             }
 
             //Build the channel register
-            LOGGER->log_message(LogManager::INFO, stdsprintf("Setting channel register for VFAT%i chan %i",vfatN,chan));
             chanRegVal = (calEnable[idx] << 15) + (masks[idx] << 14) + \
                          (trimZCCPol[idx] << 13) + (trimZCC[idx] << 7) + \
                          (trimARMPol[idx] << 6) + (trimARM[idx]);
@@ -397,7 +387,7 @@ void setChannelRegistersVFAT3Local(localArgs * la, uint32_t ohN, uint32_t vfatMa
 void setChannelRegistersVFAT3(const RPCMsg *request, RPCMsg *response){
     LOGGER->log_message(LogManager::INFO, "Setting VFAT3 Channel Registers");
 
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     uint32_t vfatMask = request->get_word("vfatMask");
@@ -426,8 +416,6 @@ void setChannelRegistersVFAT3(const RPCMsg *request, RPCMsg *response){
 
         setChannelRegistersVFAT3Local(&la, ohN, vfatMask, calEnable, masks, trimARM, trimARMPol, trimZCC, trimZCCPol);
     } //End Case: user provided multiple arrays
-
-    rtxn.abort();
 } //End setChannelRegistersVFAT3()
 
 void statusVFAT3sLocal(localArgs * la, uint32_t ohN)
@@ -476,13 +464,12 @@ void statusVFAT3sLocal(localArgs * la, uint32_t ohN)
 
 void statusVFAT3s(const RPCMsg *request, RPCMsg *response)
 {
-    GETLOCALARGS(response);
+    LocalArgs la = getLocalArgs(response);
 
     uint32_t ohN = request->get_word("ohN");
     LOGGER->log_message(LogManager::INFO, "Reading VFAT3 status");
 
     statusVFAT3sLocal(&la, ohN);
-    rtxn.abort();
 }
 
 uint16_t decodeChipID(uint32_t encChipID)
@@ -611,8 +598,7 @@ void getVFAT3ChipIDsLocal(localArgs * la, uint32_t ohN, uint32_t vfatMask, bool
 
 void getVFAT3ChipIDs(const RPCMsg *request, RPCMsg *response)
 {
-  // struct localArgs la = getLocalArgs(response);
-  GETLOCALARGS(response);
+  LocalArgs la = getLocalArgs(response);
 
   uint32_t ohN      = request->get_word("ohN");
   uint32_t vfatMask = request->get_word("vfatMask");
@@ -620,8 +606,6 @@ void getVFAT3ChipIDs(const RPCMsg *request, RPCMsg *response)
   LOGGER->log_message(LogManager::DEBUG, "Reading VFAT3 chipIDs");
 
   getVFAT3ChipIDsLocal(&la, ohN, vfatMask, rawID);
-
-  rtxn.abort();
 }
 
 extern "C" {
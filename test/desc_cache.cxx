@@ -0,0 +1,106 @@
+/*!
+ * \file desc_cache.cxx
+ * \brief Test of the register descriptor cache, and benchmark against LMDB lookups on a 50k register table
+ */
+
+#include "host_test.h"
+
+#include <sys/wait.h>
+
+#include <vector>
+
+namespace {
+  const size_t nFiller = 50000;
+  const size_t nNames  = 300;
+
+  /*! Names of a scan, spread over the table */
+  std::vector<std::string> scanNames()
+  {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < nNames; ++i) {
+      const size_t r = i * (nFiller / nNames);
+      names.push_back("GEM_FILLER.MODULE" + std::to_string(r / 64) + ".REG" + std::to_string(r % 64));
+    }
+    return names;
+  }
+
+  uint32_t lookupAddress(LocalArgs & la, const std::string & name)
+  {
+    lmdb::val key, db_res;
+    key.assign(name);
+    if (!la.dbi.get(la.rtxn, key, db_res))
+      return 0xdeaddead;
+    const regDescriptor * desc = decodeRegDescriptor(db_res);
+    return desc ? desc->address : 0xdeaddead;
+  }
+
+  void testLookups(const std::vector<std::string> & names)
+  {
+    RPCMsg response;
+    LocalArgs la = getLocalArgs(&response);
+    for (const std::string & name : names) {
+      const regDescriptor * desc = getRegDescriptor(&la, name);
+      HOST_CHECK(desc && desc->address == lookupAddress(la, name));
+    }
+    HOST_CHECK(getRegDescriptor(&la, "GEM_FILLER.NO_SUCH_REG") == nullptr);
+  }
+
+  /*! The cache is dropped when another process updates the table in place, bumping its generation */
+  void testInvalidation(const hostTest::hostSetup & setup, const std::string & name)
+  {
+    RPCMsg response;
+    {
+      LocalArgs la = getLocalArgs(&response);
+      const regDescriptor * desc = getRegDescriptor(&la, name);
+      HOST_CHECK(desc && desc->address == 0x66000000);
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+      hostTest::nodeMap nodes = hostTest::gemTable(1);
+      hostTest::addFiller(nodes, nFiller);
+      hostTest::addNode(nodes, name, 0x67000000);
+      addressTableUpdate update;
+      std::string error;
+      _exit(patchAddressTable(nodes, setup.path(), update, error) ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    HOST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    LocalArgs la = getLocalArgs(&response);
+    const regDescriptor * desc = getRegDescriptor(&la, name);
+    HOST_CHECK(desc && desc->address == 0x67000000);
+  }
+
+  void benchmark(const std::vector<std::string> & names)
+  {
+    const size_t passes = 50;
+    RPCMsg response;
+    LocalArgs la = getLocalArgs(&response);
+    const double lmdb = hostTest::nsPerCall(passes, [&] {
+        for (const std::string & name : names)
+          lookupAddress(la, name);
+      }) / names.size();
+    const double cached = hostTest::nsPerCall(passes, [&] {
+        for (const std::string & name : names)
+          getRegDescriptor(&la, name);
+      }) / names.size();
+    std::printf("%-36s %8.0f ns/lookup\n", "descriptor lookup, LMDB", lmdb);
+    std::printf("%-36s %8.0f ns/lookup\n", "descriptor lookup, cache", cached);
+  }
+}
+
+int main()
+{
+  hostTest::nodeMap nodes = hostTest::gemTable(1);
+  hostTest::addFiller(nodes, nFiller);
+  hostTest::hostSetup setup(nodes);
+
+  const std::vector<std::string> names = scanNames();
+  testLookups(names);
+  benchmark(names);
+  testInvalidation(setup, names.front());
+
+  return hostTest::result("desc_cache");
+}
@@ -0,0 +1,207 @@
+/*!
+ * \file host_rpc.cxx
+ * \brief Regression test and benchmark of RPC methods against the simulated registers of the host build
+ */
+
+#include "host_test.h"
+#include "amc.h"
+#include "amc/ttc.h"
+#include "daq_monitor.h"
+#include "utils/batch.h"
+#include "utils/subtree.h"
+#include "utils/wait.h"
+
+#include <algorithm>
+
+namespace {
+  const char * const simConfig =
+    "GEM_AMC.GEM_SYSTEM.RELEASE.MAJOR value 3\n"
+    "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH value 12\n"
+    "GEM_AMC.TTC.STATUS.CLK.MMCM_LOCKED value 1\n"
+    "GEM_AMC.TTC.STATUS.BC0.LOCKED value 1\n"
+    "GEM_AMC.TTC.L1A_RATE value 100000\n"
+    "GEM_AMC.TTC.L1A_ID counter\n"
+    "GEM_AMC.TTC.GENERATOR.CYCLIC_START strobe\n"
+    "GEM_AMC.TTC.GENERATOR.CYCLIC_RUNNING busy GEM_AMC.TTC.GENERATOR.CYCLIC_START 3\n"
+    "GEM_AMC.OH_LINKS.OH1.VFAT3.SYNC_ERR_CNT value 5\n";
+
+  bool hasCode(const RPCMsg & response, uint32_t code)
+  {
+    if (!response.get_key_exists("error_codes"))
+      return false;
+    const std::vector<uint32_t> codes = response.get_word_array("error_codes");
+    return std::find(codes.begin(), codes.end(), code) != codes.end();
+  }
+
+  void testTTC()
+  {
+    RPCMsg request("amc.getL1AID"), first, second;
+    getL1AID(&request, &first);
+    getL1AID(&request, &second);
+    HOST_CHECK(!first.get_key_exists("error"));
+    HOST_CHECK(second.get_word("result") == first.get_word("result") + 1);
+
+    RPCMsg monRequest("daq_monitor.getmonTTCmain"), mon;
+    getmonTTCmain(&monRequest, &mon);
+    HOST_CHECK(!mon.get_key_exists("error"));
+    HOST_CHECK(mon.get_word("MMCM_LOCKED") == 1);
+    HOST_CHECK(mon.get_word("BC0_LOCKED") == 1);
+    HOST_CHECK(mon.get_word("L1A_RATE") == 100000);
+  }
+
+  void testVFATLinks()
+  {
+    RPCMsg request("daq_monitor.getmonVFATLink"), response;
+    getmonVFATLink(&request, &response);
+    HOST_CHECK(!response.get_key_exists("error"));
+    HOST_CHECK(response.get_word("OH1.VFAT3.SYNC_ERR_CNT") == 5);
+    HOST_CHECK(response.get_word("OH1.VFAT4.SYNC_ERR_CNT") == 0);
+    HOST_CHECK(response.get_word("OH11.VFAT23.DAQ_CRC_ERROR_CNT") == 0);
+
+    RPCMsg maskRequest("amc.getOHVFATMask"), mask0, mask1;
+    maskRequest.set_word("ohN", 0);
+    getOHVFATMask(&maskRequest, &mask0);
+    maskRequest.set_word("ohN", 1);
+    getOHVFATMask(&maskRequest, &mask1);
+    HOST_CHECK(mask0.get_word("vfatMask") == 0x0);
+    HOST_CHECK(mask1.get_word("vfatMask") == (0x1 << 3));
+
+    // the 24 counters are read under a single lock acquisition
+    const uint64_t start = hostTest::lockAcquisitions();
+    getOHVFATMask(&maskRequest, &mask1);
+    HOST_CHECK(hostTest::lockAcquisitions() - start == 1);
+  }
+
+  void testBatch()
+  {
+    RPCMsg request("utils.execBatch"), response;
+    request.set_string_array("names", {"GEM_AMC.DAQ.CONTROL.INPUT_ENABLE_MASK", "GEM_AMC.TTC.L1A_RATE"});
+    request.set_word_array("program", std::vector<uint32_t>{batchHeader(BATCH_WRITE_REG, 0), 0xABC,
+                                                            batchHeader(BATCH_READ_REG, 0),
+                                                            batchHeader(BATCH_READ_REG, 1)});
+    execBatch(&request, &response);
+    HOST_CHECK(!response.get_key_exists("error"));
+    HOST_CHECK(response.get_word("executed") == 3);
+    const std::vector<uint32_t> data = response.get_word_array("data");
+    HOST_CHECK(data.size() == 2 && data[0] == 0xABC && data[1] == 100000);
+
+    RPCMsg unknown("utils.execBatch"), failed;
+    unknown.set_string_array("names", {"GEM_AMC.NO_SUCH_REG"});
+    unknown.set_word_array("program", std::vector<uint32_t>{batchHeader(BATCH_READ_REG, 0)});
+    execBatch(&unknown, &failed);
+    HOST_CHECK(failed.get_key_exists("error"));
+    HOST_CHECK(failed.get_word("executed") == 0);
+    HOST_CHECK(hasCode(failed, REG_ERR_NOT_FOUND));
+  }
+
+  void testBatchBlockBounds()
+  {
+    // a port read longer than the port must be refused before any result is allocated
+    RPCMsg read("utils.execBatch"), readFailed;
+    read.set_string_array("names", {"GEM_AMC.DAQ.EXT_CONTROL.DATA_PORT"});
+    read.set_word_array("program", std::vector<uint32_t>{batchHeader(BATCH_READ_BLOCK, 0), 0xFFFFFFF0, 0});
+    execBatch(&read, &readFailed);
+    HOST_CHECK(readFailed.get_word("executed") == 0);
+    HOST_CHECK(readFailed.get_word_array("data").empty());
+    HOST_CHECK(hasCode(readFailed, REG_ERR_BLOCK_RANGE));
+
+    // a block write with fewer values in the program than its size
+    RPCMsg write("utils.execBatch"), writeFailed;
+    write.set_string_array("names", {"GEM_AMC.DAQ.EXT_CONTROL.DATA_PORT"});
+    write.set_word_array("program", std::vector<uint32_t>{batchHeader(BATCH_WRITE_BLOCK, 0), 8, 0, 1, 2});
+    execBatch(&write, &writeFailed);
+    HOST_CHECK(writeFailed.get_word("executed") == 0);
+    HOST_CHECK(hasCode(writeFailed, REG_ERR_BATCH_PROGRAM));
+
+    RPCMsg huge("utils.execBatch"), hugeFailed;
+    huge.set_string_array("names", {"GEM_AMC.DAQ.EXT_CONTROL.DATA_PORT"});
+    huge.set_word_array("program", std::vector<uint32_t>{batchHeader(BATCH_WRITE_BLOCK, 0), 0xFFFFFFFF, 0, 1});
+    execBatch(&huge, &hugeFailed);
+    HOST_CHECK(hugeFailed.get_word("executed") == 0);
+    HOST_CHECK(hasCode(hugeFailed, REG_ERR_BLOCK_RANGE));
+  }
+
+  void testNullReporter()
+  {
+    // a reporter without response must not keep the later requests from rendering their errors
+    { regErrorReporter detached(nullptr); }
+    RPCMsg unknown("utils.execBatch"), failed;
+    unknown.set_string_array("names", {"GEM_AMC.NO_SUCH_REG"});
+    unknown.set_word_array("program", std::vector<uint32_t>{batchHeader(BATCH_READ_REG, 0)});
+    execBatch(&unknown, &failed);
+    HOST_CHECK(hasCode(failed, REG_ERR_NOT_FOUND));
+  }
+
+  void testSubtree()
+  {
+    // OH1-SPARE sorts before the OH1 subtree, OH10 and OH11 after it
+    RPCMsg request("utils.readSubtree"), response;
+    request.set_string("prefix", "GEM_AMC.OH_LINKS.OH1");
+    readSubtree(&request, &response);
+    HOST_CHECK(!response.get_key_exists("error"));
+    const std::vector<std::string> names = response.get_string_array("names");
+    const std::vector<uint32_t>    data  = response.get_word_array("data");
+    HOST_CHECK(names.size() == 24*3 && data.size() == names.size());
+    bool below = true;
+    for (size_t i = 0; i < names.size(); ++i) {
+      below &= (names[i].compare(0, 21, "GEM_AMC.OH_LINKS.OH1.") == 0);
+      if (names[i] == "GEM_AMC.OH_LINKS.OH1.VFAT3.SYNC_ERR_CNT")
+        HOST_CHECK(data[i] == 5);
+    }
+    HOST_CHECK(below);
+  }
+
+  void testWait()
+  {
+    RPCMsg start("utils.execBatch"), started;
+    start.set_string_array("names", {"GEM_AMC.TTC.GENERATOR.CYCLIC_START"});
+    start.set_word_array("program", std::vector<uint32_t>{batchHeader(BATCH_WRITE_REG, 0), 1});
+    execBatch(&start, &started);
+    HOST_CHECK(!started.get_key_exists("error"));
+
+    RPCMsg request("utils.waitForReg"), response;
+    request.set_string("reg_name", "GEM_AMC.TTC.GENERATOR.CYCLIC_RUNNING");
+    request.set_word("value", 0);
+    request.set_word("timeout", 100000);
+    waitForReg(&request, &response);
+    HOST_CHECK(!response.get_key_exists("error"));
+    HOST_CHECK(response.get_word("met") == 1);
+    HOST_CHECK(response.get_word("polls") >= 3);
+  }
+
+  void benchmark()
+  {
+    const size_t n = 2000;
+    RPCMsg l1a("amc.getL1AID"), ttc("daq_monitor.getmonTTCmain"), links("daq_monitor.getmonVFATLink");
+    std::printf("%-24s %10.0f ns/call\n", "getL1AID",
+                hostTest::nsPerCall(n, [&] { RPCMsg response; getL1AID(&l1a, &response); }));
+    std::printf("%-24s %10.0f ns/call\n", "getmonTTCmain",
+                hostTest::nsPerCall(n, [&] { RPCMsg response; getmonTTCmain(&ttc, &response); }));
+    std::printf("%-24s %10.0f ns/call\n", "getmonVFATLink",
+                hostTest::nsPerCall(n / 10, [&] { RPCMsg response; getmonVFATLink(&links, &response); }));
+  }
+}
+
+int main()
+{
+  hostTest::nodeMap nodes = hostTest::gemTable();
+  hostTest::addNode(nodes, "GEM_AMC.DAQ.EXT_CONTROL.DATA_PORT", 0x64400020, 0xFFFFFFFF, "rw", "port", 16);
+  hostTest::addNode(nodes, "GEM_AMC.OH_LINKS.OH1-SPARE.CTRL", 0x6470F000, 0xFFFFFFFF, "r");
+  hostTest::hostSetup setup(nodes, simConfig);
+  if (memhub_open(&memsvc) != 0) {
+    std::fprintf(stderr, "Unable to open memhub: %s\n", memsvc_get_last_error(memsvc));
+    return 2;
+  }
+
+  testTTC();
+  testVFATLinks();
+  testBatch();
+  testBatchBlockBounds();
+  testNullReporter();
+  testSubtree();
+  testWait();
+  benchmark();
+
+  memhub_close(&memsvc);
+  return hostTest::result("host_rpc");
+}
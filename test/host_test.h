@@ -0,0 +1,231 @@
+/*!
+ * \file host_test.h
+ * \brief Helpers of the host tests and benchmarks run by make host-test: synthetic address tables, simulated
+ *        registers, checks and timing
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include "utils.h"
+#include "utils/address_table.h"
+#include "memhub.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+namespace hostTest {
+    typedef std::unordered_map<std::string, xhal::utils::Node> nodeMap;
+
+    /*! \brief Number of failed checks of the test */
+    inline int & failures()
+    {
+        static int n = 0;
+        return n;
+    }
+
+    inline bool check(bool ok, const char * what, const char * file, int line)
+    {
+        if (!ok) {
+            ++failures();
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+        }
+        return ok;
+    }
+
+    /*! \brief Prints the outcome of the test and returns its exit code */
+    inline int result(const char * test)
+    {
+        std::printf("%s: %s\n", test, failures() ? "FAILED" : "passed");
+        return failures() ? 1 : 0;
+    }
+
+    /*! \brief Adds a register to an address table, and the modules above it which are not there yet */
+    inline void addNode(nodeMap & nodes, const std::string & name, uint32_t address, uint32_t mask=0xFFFFFFFF,
+                        const std::string & perm="rw", const std::string & mode="single", uint32_t size=1)
+    {
+        xhal::utils::Node n = {};
+        n.name         = name;
+        n.permission   = perm;
+        n.mode         = mode;
+        n.address      = address;
+        n.real_address = address;
+        n.mask         = mask;
+        n.size         = size;
+        nodes[name]    = n;
+        for (size_t dot = name.rfind('.'); dot != std::string::npos; dot = name.rfind('.', dot - 1)) {
+            const std::string module = name.substr(0, dot);
+            if (nodes.count(module))
+                break;
+            n.name = module;
+            n.permission.clear();
+            n.mask = 0xFFFFFFFF;
+            n.size = 1;
+            nodes[module] = n;
+            if (dot == 0)
+                break;
+        }
+    }
+
+    /*! \brief GEM-like address table, with the registers read by the monitoring, TTC and VFAT link methods
+     *  \param nOH Number of OptoHybrids
+     */
+    inline nodeMap gemTable(uint32_t nOH=12)
+    {
+        nodeMap nodes;
+        const uint32_t ttc = 0x64300000;
+        addNode(nodes, "GEM_AMC.TTC.CTRL.MODULE_RESET",                ttc + 0x00, 0x80000000, "w");
+        addNode(nodes, "GEM_AMC.TTC.CTRL.CNT_RESET",                   ttc + 0x00, 0x08000000, "w");
+        addNode(nodes, "GEM_AMC.TTC.STATUS.CLK.MMCM_LOCKED",           ttc + 0x40, 0x00000001, "r");
+        addNode(nodes, "GEM_AMC.TTC.STATUS.TTC_SINGLE_ERROR_CNT",      ttc + 0x44, 0x0000FFFF, "r");
+        addNode(nodes, "GEM_AMC.TTC.STATUS.BC0.LOCKED",                ttc + 0x48, 0x00000001, "r");
+        addNode(nodes, "GEM_AMC.TTC.L1A_ID",                           ttc + 0x4C, 0x00FFFFFF, "r");
+        addNode(nodes, "GEM_AMC.TTC.L1A_RATE",                         ttc + 0x50, 0xFFFFFFFF, "r");
+        addNode(nodes, "GEM_AMC.TTC.GENERATOR.CYCLIC_START",           ttc + 0x80, 0x00000001, "w");
+        addNode(nodes, "GEM_AMC.TTC.GENERATOR.CYCLIC_RUNNING",         ttc + 0x84, 0x00000001, "r");
+
+        const uint32_t daq = 0x64400000;
+        addNode(nodes, "GEM_AMC.DAQ.CONTROL.DAQ_ENABLE",                    daq + 0x00, 0x00000001, "rw");
+        addNode(nodes, "GEM_AMC.DAQ.CONTROL.INPUT_ENABLE_MASK",             daq + 0x00, 0x00FFF000, "rw");
+        addNode(nodes, "GEM_AMC.DAQ.STATUS.DAQ_LINK_RDY",                   daq + 0x04, 0x00000001, "r");
+        addNode(nodes, "GEM_AMC.DAQ.STATUS.DAQ_LINK_AFULL",                 daq + 0x04, 0x00000002, "r");
+        addNode(nodes, "GEM_AMC.DAQ.STATUS.DAQ_OUTPUT_FIFO_HAD_OVERFLOW",   daq + 0x04, 0x00000004, "r");
+        addNode(nodes, "GEM_AMC.DAQ.STATUS.L1A_FIFO_HAD_OVERFLOW",          daq + 0x04, 0x00000008, "r");
+        addNode(nodes, "GEM_AMC.DAQ.STATUS.TTS_STATE",                      daq + 0x04, 0x000000F0, "r");
+        addNode(nodes, "GEM_AMC.DAQ.STATUS.INPUT_AUTOKILL_MASK",            daq + 0x04, 0xFFF00000, "r");
+        addNode(nodes, "GEM_AMC.DAQ.EXT_STATUS.L1A_FIFO_DATA_CNT",          daq + 0x08, 0x0000FFFF, "r");
+        addNode(nodes, "GEM_AMC.DAQ.EXT_STATUS.DAQ_FIFO_DATA_CNT",          daq + 0x08, 0xFFFF0000, "r");
+        addNode(nodes, "GEM_AMC.DAQ.EXT_STATUS.EVT_SENT",                   daq + 0x0C, 0xFFFFFFFF, "r");
+        addNode(nodes, "GEM_AMC.DAQ.EXT_STATUS.L1AID",                      daq + 0x10, 0xFFFFFFFF, "r");
+
+        const uint32_t trigger = 0x64500000;
+        addNode(nodes, "GEM_AMC.TRIGGER.STATUS.OR_TRIGGER_RATE", trigger, 0xFFFFFFFF, "r");
+
+        const uint32_t system = 0x64600000;
+        addNode(nodes, "GEM_AMC.GEM_SYSTEM.RELEASE.MAJOR",    system + 0x00, 0xFF000000, "r");
+        addNode(nodes, "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH", system + 0x04, 0x0000000F, "r");
+        addNode(nodes, "GEM_AMC.GEM_SYSTEM.CTRL.LINK_RESET",  system + 0x08, 0x00000001, "w");
+
+        const uint32_t links = 0x64700000;
+        static const char * const ohCounters[] = {"LINK0_MISSED_COMMA_CNT", "LINK1_MISSED_COMMA_CNT",
+                                                  "LINK0_OVERFLOW_CNT",     "LINK1_OVERFLOW_CNT",
+                                                  "LINK0_UNDERFLOW_CNT",    "LINK1_UNDERFLOW_CNT",
+                                                  "LINK0_SBIT_OVERFLOW_CNT","LINK1_SBIT_OVERFLOW_CNT"};
+        static const char * const ohStatus[] = {"EVT_SIZE_ERR", "EVENT_FIFO_HAD_OFLOW", "INPUT_FIFO_HAD_OFLOW",
+                                                "INPUT_FIFO_HAD_UFLOW", "VFAT_TOO_MANY", "VFAT_NO_MARKER"};
+        for (uint32_t ohN = 0; ohN < nOH; ++ohN) {
+            const std::string oh = "OH" + std::to_string(ohN);
+            for (uint32_t c = 0; c < 8; ++c)
+                addNode(nodes, "GEM_AMC.TRIGGER." + oh + "." + ohCounters[c], trigger + 0x100*(ohN+1) + 4*(c/2),
+                        (c % 2) ? 0xFFFF0000 : 0x0000FFFF, "r");
+            for (uint32_t s = 0; s < 6; ++s)
+                addNode(nodes, "GEM_AMC.DAQ." + oh + ".STATUS." + ohStatus[s], daq + 0x100*(ohN+1), 1u << s, "r");
+            for (uint32_t vfatN = 0; vfatN < 24; ++vfatN) {
+                const std::string vfat = "GEM_AMC.OH_LINKS." + oh + ".VFAT" + std::to_string(vfatN);
+                const uint32_t base = links + 0x1000*ohN + 0xC*vfatN;
+                addNode(nodes, vfat + ".SYNC_ERR_CNT",      base + 0x0, 0x0000FFFF, "r");
+                addNode(nodes, vfat + ".DAQ_EVENT_CNT",     base + 0x4, 0x0000FFFF, "r");
+                addNode(nodes, vfat + ".DAQ_CRC_ERROR_CNT", base + 0x8, 0x0000FFFF, "r");
+            }
+        }
+        return nodes;
+    }
+
+    /*! \brief Adds n full word registers in n/64 modules from base, e.g. to give a table the size of a real one */
+    inline void addFiller(nodeMap & nodes, size_t n, uint32_t base=0x66000000)
+    {
+        for (size_t i = 0; i < n; ++i)
+            addNode(nodes, "GEM_FILLER.MODULE" + std::to_string(i / 64) + ".REG" + std::to_string(i % 64),
+                    base + 4*static_cast<uint32_t>(i));
+    }
+
+    /*! \class hostSetup
+     *  \brief Temporary GEM_PATH holding an address table built from nodes, removed on destruction
+     *  \details The memhub shared memory segment is created again by the first memhub_open of the test, so that it
+     *           uses the lock domains of the test: host tests must not run next to other memhub clients of the machine.
+     */
+    class hostSetup {
+    public:
+        /*! \param nodes Address table
+         *  \param simConfig Contents of MEMHUB_SIM_CONFIG, see memhub/sim.h
+         *  \param domains Contents of the memhub lock domain file, empty for a single lock
+         */
+        hostSetup(const nodeMap & nodes, const std::string & simConfig="", const std::string & domains="")
+        {
+            char dir[] = "/tmp/ctp7_host_test.XXXXXX";
+            if (!mkdtemp(dir)) {
+                std::perror("mkdtemp");
+                std::exit(2);
+            }
+            m_path = dir;
+            setenv("GEM_PATH", m_path.c_str(), 1);
+            unsetenv("MEMHUB_SIM_TABLE");
+            unsetenv("MEMHUB_DOMAINS");
+            if (!simConfig.empty()) {
+                std::ofstream(m_path + "/sim.txt") << simConfig;
+                setenv("MEMHUB_SIM_CONFIG", (m_path + "/sim.txt").c_str(), 1);
+            } else {
+                unsetenv("MEMHUB_SIM_CONFIG");
+            }
+            if (!domains.empty())
+                std::ofstream(m_path + "/" + MEMHUB_DOMAINS_FILE) << domains;
+            shm_unlink("/memhub");
+
+            addressTableUpdate update;
+            std::string error;
+            if (!buildAddressTable(nodes, m_path, update, error)) {
+                std::fprintf(stderr, "Unable to build the address table: %s\n", error.c_str());
+                std::exit(2);
+            }
+        }
+
+        ~hostSetup()
+        {
+            closeLocalArgs();
+            if (getpid() == m_owner)
+                std::system(("rm -rf " + m_path).c_str());
+        }
+
+        /*! \brief GEM_PATH of the test */
+        const std::string & path() const { return m_path; }
+
+    private:
+        std::string m_path;
+        pid_t       m_owner{getpid()};
+    };
+
+    /*! \brief Number of memhub lock acquisitions of the machine so far, from the wait time histogram of memhub_get_stats */
+    inline uint64_t lockAcquisitions()
+    {
+        struct memhub_stats stats;
+        if (memhub_get_stats(&stats) != 0)
+            return 0;
+        uint64_t n = 0;
+        for (size_t b = 0; b < MEMHUB_STATS_BUCKETS; ++b)
+            n += stats.wait_hist[b];
+        return n;
+    }
+
+    /*! \brief Returns the mean duration of f over n calls, in nanoseconds */
+    template<typename F>
+    double nsPerCall(size_t n, F f)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i)
+            f();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    }
+}
+
+/*! \brief Checks a condition, reporting it and failing the test if it does not hold */
+#define HOST_CHECK(cond) hostTest::check((cond), #cond, __FILE__, __LINE__)
+
+#endif
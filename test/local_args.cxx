@@ -0,0 +1,92 @@
+/*!
+ * \file local_args.cxx
+ * \brief Test of the process-wide LMDB handles of getLocalArgs, and benchmark against opening the environment on
+ *        every call as the RPC methods used to do
+ */
+
+#include "host_test.h"
+#include "amc/ttc.h"
+
+namespace {
+  /*! getL1AID as it was with the environment, transaction and database opened by every call */
+  uint32_t getL1AIDOpeningEnv()
+  {
+    RPCMsg response;
+    auto env = lmdb::env::create();
+    env.set_mapsize(LMDB_SIZE);
+    const std::string lmdb_data_file = std::string(std::getenv("GEM_PATH")) + "/" + ADDRESS_TABLE_LINK;
+    env.open(lmdb_data_file.c_str(), 0, 0664);
+    auto rtxn = lmdb::txn::begin(env, nullptr, MDB_RDONLY);
+    auto dbi  = lmdb::dbi::open(rtxn, nullptr);
+    LocalArgs la = {.rtxn     = rtxn,
+                    .dbi      = dbi,
+                    .response = &response,
+                    .reporter = regErrorReporter(&response),
+                    .hw       = hwContext()};
+    return getL1AIDLocal(&la);
+  }
+
+  void testSharedHandles()
+  {
+    RPCMsg response;
+    MDB_txn * txn = nullptr;
+    {
+      LocalArgs la = getLocalArgs(&response);
+      txn = la.rtxn.handle();
+      HOST_CHECK(getL1AIDLocal(&la) == 0);
+    }
+    LocalArgs la = getLocalArgs(&response);
+    HOST_CHECK(la.rtxn.handle() == txn);
+    HOST_CHECK(getL1AIDLocal(&la) == 1);
+    HOST_CHECK(getRegDescriptor(&la, "GEM_AMC.TTC.L1A_ID") != nullptr);
+  }
+
+  void testRebuild(const hostTest::hostSetup & setup)
+  {
+    RPCMsg response;
+    uint64_t generation = 0;
+    {
+      LocalArgs la = getLocalArgs(&response);
+      generation = addressTableGeneration();
+      HOST_CHECK(getRegDescriptor(&la, "GEM_AMC.TTC.EXTRA") == nullptr);
+    }
+
+    hostTest::nodeMap nodes = hostTest::gemTable(1);
+    hostTest::addNode(nodes, "GEM_AMC.TTC.EXTRA", 0x64300100);
+    closeLocalArgs();
+    addressTableUpdate update;
+    std::string error;
+    HOST_CHECK(buildAddressTable(nodes, setup.path(), update, error));
+
+    LocalArgs la = getLocalArgs(&response);
+    HOST_CHECK(addressTableGeneration() > generation);
+    const regDescriptor * desc = getRegDescriptor(&la, "GEM_AMC.TTC.EXTRA");
+    HOST_CHECK(desc && desc->address == 0x64300100);
+  }
+
+  void benchmark()
+  {
+    const size_t n = 5000;
+    RPCMsg request("amc.getL1AID");
+    const double opening = hostTest::nsPerCall(n, [] { getL1AIDOpeningEnv(); });
+    const double shared  = hostTest::nsPerCall(n, [&] { RPCMsg response; getL1AID(&request, &response); });
+    std::printf("%-32s %10.0f ns/call\n", "getL1AID, environment per call", opening);
+    std::printf("%-32s %10.0f ns/call\n", "getL1AID, getLocalArgs", shared);
+  }
+}
+
+int main()
+{
+  hostTest::hostSetup setup(hostTest::gemTable(1), "GEM_AMC.TTC.L1A_ID counter\n");
+  if (memhub_open(&memsvc) != 0) {
+    std::fprintf(stderr, "Unable to open memhub: %s\n", memsvc_get_last_error(memsvc));
+    return 2;
+  }
+
+  testSharedHandles();
+  benchmark();
+  testRebuild(setup);
+
+  memhub_close(&memsvc);
+  return hostTest::result("local_args");
+}
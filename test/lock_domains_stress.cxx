@@ -0,0 +1,100 @@
+/*!
+ * \file lock_domains_stress.cxx
+ * \brief Multi-process stress benchmark of memhub: aggregate read throughput against the number of client processes,
+ *        with a single lock and with the lock domains derived from the address table
+ */
+
+#include "host_test.h"
+#include "utils/lock_domains.h"
+
+#include <sys/wait.h>
+#include <time.h>
+
+namespace {
+  const uint32_t nOH        = 8;
+  const uint32_t links      = 0x64700000;
+  const uint64_t durationNs = 300000000;
+
+  uint64_t now()
+  {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec*1000000000ULL + t.tv_nsec;
+  }
+
+  /*! Client k reads the VFAT link counters of OptoHybrid k word by word, counting the reads done in [start, end) */
+  uint64_t client(uint32_t k, uint64_t start, uint64_t end)
+  {
+    if (memhub_open(&memsvc) != 0)
+      return 0;
+    while (now() < start) {}
+    uint64_t reads = 0;
+    for (uint32_t i = 0; now() < end; ++i) {
+      uint32_t value;
+      if (memhub_read(memsvc, links + 0x1000*(k % nOH) + 4*(i % 72), 1, &value) != 0)
+        return 0;
+      ++reads;
+    }
+    return reads;
+  }
+
+  /*! Aggregate reads per second of n concurrent clients */
+  double throughput(uint32_t n)
+  {
+    // every client starts and stops at the same time, once all of them have opened memhub
+    const uint64_t start = now() + 200000000;
+    std::vector<int> pipes(n);
+    for (uint32_t k = 0; k < n; ++k) {
+      int fd[2];
+      if (pipe(fd) != 0)
+        return 0;
+      if (fork() == 0) {
+        const uint64_t reads = client(k, start, start + durationNs);
+        _exit(write(fd[1], &reads, sizeof(reads)) == sizeof(reads) ? 0 : 1);
+      }
+      close(fd[1]);
+      pipes[k] = fd[0];
+    }
+    uint64_t total = 0;
+    for (uint32_t k = 0; k < n; ++k) {
+      uint64_t reads = 0;
+      HOST_CHECK(read(pipes[k], &reads, sizeof(reads)) == sizeof(reads) && reads > 0);
+      total += reads;
+      close(pipes[k]);
+    }
+    while (wait(nullptr) > 0) {}
+    return total * 1e9 / durationNs;
+  }
+
+  std::vector<double> scan(const char * locking)
+  {
+    std::vector<double> rates;
+    for (uint32_t n = 1; n <= nOH; n *= 2) {
+      rates.push_back(throughput(n));
+      std::printf("%-12s %2u clients %10.0f reads/s\n", locking, n, rates.back());
+    }
+    return rates;
+  }
+}
+
+int main()
+{
+  // accesses lasting 100 us, slept rather than spun, so that the clients overlap even on a single core
+  setenv("MEMHUB_SIM_LATENCY_NS", "100000", 1);
+  const hostTest::nodeMap nodes = hostTest::gemTable(nOH);
+  hostTest::hostSetup setup(nodes);
+
+  const std::vector<double> single = scan("single lock");
+
+  // the domains are published by the first client opening the new segment
+  HOST_CHECK(buildLockDomains(nodes, setup.path() + "/" + MEMHUB_DOMAINS_FILE) > nOH);
+  shm_unlink("/memhub");
+  const std::vector<double> sharded = scan("domains");
+
+  // a single lock serializes the clients, the domains let the clients of different OptoHybrids run concurrently
+  HOST_CHECK(single.back() < 1.5 * single.front());
+  HOST_CHECK(sharded.back() > 4 * sharded.front());
+
+  shm_unlink("/memhub");
+  return hostTest::result("lock_domains_stress");
+}
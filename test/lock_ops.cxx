@@ -0,0 +1,191 @@
+/*!
+ * \file lock_ops.cxx
+ * \brief Checks that memhub transactions hold the lock across their operations, and counts the memhub lock
+ *        acquisitions of a list read, word by word, in a transaction and with mlistread, and of a masked list write
+ */
+
+#include "host_test.h"
+
+#include <poll.h>
+#include <sys/wait.h>
+
+void mlistread(const RPCMsg *request, RPCMsg *response);
+
+namespace {
+  const uint32_t nWords = 3072;
+  const uint32_t base   = 0x66000000;
+
+  struct lockCount {
+    uint64_t acquisitions;
+    double   ns;
+  };
+
+  template<typename F>
+  lockCount count(F f)
+  {
+    const uint64_t start = hostTest::lockAcquisitions();
+    const double ns = hostTest::nsPerCall(1, f);
+    return {hostTest::lockAcquisitions() - start, ns};
+  }
+
+  /*! Client process which reads a word once told to through go, and reports it through done */
+  struct client {
+    int go[2];
+    int done[2];
+
+    client()
+    {
+      if (pipe(go) != 0 || pipe(done) != 0)
+        std::exit(2);
+      if (fork() == 0) {
+        char c;
+        uint32_t value;
+        if (read(go[0], &c, 1) != 1 || memhub_read(memsvc, base, 1, &value) != 0)
+          _exit(1);
+        _exit(write(done[1], "x", 1) == 1 ? 0 : 1);
+      }
+    }
+
+    ~client()
+    {
+      wait(nullptr);
+      for (int fd : {go[0], go[1], done[0], done[1]})
+        close(fd);
+    }
+
+    void start() { HOST_CHECK(write(go[1], "x", 1) == 1); }
+
+    /*! Whether the client did its read within timeoutMs */
+    bool served(int timeoutMs)
+    {
+      struct pollfd p = {done[0], POLLIN, 0};
+      return poll(&p, 1, timeoutMs) == 1;
+    }
+  };
+
+  /*! The other processes wait for the end of a transaction */
+  void testExclusion()
+  {
+    client other;
+    {
+      memhubTransaction t;
+      uint32_t value;
+      memhub_read(memsvc, base, 1, &value);
+      other.start();
+      HOST_CHECK(!other.served(200));
+    }
+    HOST_CHECK(other.served(5000));
+  }
+
+  /*! With a 1 us maximum hold time, a long transaction lets the other processes in */
+  void testMaxHold()
+  {
+    memhub_set_max_hold_time(1);
+    client other;
+    bool served = false;
+    {
+      memhubTransaction t;
+      uint32_t value;
+      memhub_read(memsvc, base, 1, &value);
+      other.start();
+      for (int i = 0; i < 5000 && !served; ++i) {
+        memhub_read(memsvc, base, 1, &value);
+        served = other.served(1);
+      }
+    }
+    HOST_CHECK(served);
+    memhub_set_max_hold_time(0);
+  }
+
+  /*! A masked list write takes the lock once, and does not access the words it has no bit to write to */
+  void testListWriteMasked()
+  {
+    const uint32_t addrs[]  = {base, base + 4, base, base + 8};
+    const uint32_t masks[]  = {0x0000FFFF, 0, 0xFFFF0000, 0};
+    const uint32_t values[] = {0x00001234, 0xFFFFFFFF, 0x56780000, 0xFFFFFFFF};
+    uint32_t failed[4];
+    struct memhub_stats before, after;
+    HOST_CHECK(memhub_get_stats(&before) == 0);
+    uint32_t nFailed = 4;
+    const lockCount c = count([&] { nFailed = memhub_list_write_masked(memsvc, addrs, masks, values, 4, failed); });
+    HOST_CHECK(memhub_get_stats(&after) == 0);
+    HOST_CHECK(nFailed == 0);
+    HOST_CHECK(c.acquisitions == 1);
+    HOST_CHECK(after.reads == before.reads && after.writes == before.writes + 1);
+    uint32_t value = 0;
+    HOST_CHECK(memhub_read(memsvc, base, 1, &value) == 0 && value == 0x56781234);
+  }
+
+  void report(const char * mode, const lockCount & c)
+  {
+    std::printf("%-28s %5llu lock acquisitions %10.0f ns %12.0f acquisitions/s\n", mode,
+                static_cast<unsigned long long>(c.acquisitions), c.ns, c.acquisitions * 1e9 / c.ns);
+  }
+}
+
+int main()
+{
+  hostTest::nodeMap nodes = hostTest::gemTable(1);
+  hostTest::addFiller(nodes, nWords, base);
+  hostTest::hostSetup setup(nodes);
+  if (memhub_open(&memsvc) != 0) {
+    std::fprintf(stderr, "Unable to open memhub: %s\n", memsvc_get_last_error(memsvc));
+    return 2;
+  }
+
+  // a channel sweep, visiting the words out of order
+  std::vector<uint32_t> addrs(nWords);
+  for (uint32_t i = 0; i < nWords; ++i) {
+    addrs[i] = base + 4*((i * 7) % nWords);
+    HOST_CHECK(memhub_write(memsvc, addrs[i], 1, &i) == 0);
+  }
+  std::vector<uint32_t> data(nWords);
+
+  memhub_set_max_hold_time(0);
+  const lockCount single = count([&] {
+      for (uint32_t i = 0; i < nWords; ++i)
+        memhub_read(memsvc, addrs[i], 1, &data[i]);
+    });
+  HOST_CHECK(single.acquisitions == nWords);
+
+  const lockCount transaction = count([&] {
+      memhubTransaction t;
+      for (uint32_t i = 0; i < nWords; ++i)
+        memhub_read(memsvc, addrs[i], 1, &data[i]);
+    });
+  HOST_CHECK(transaction.acquisitions == 1);
+
+  RPCMsg request("extras.listread"), response;
+  request.set_word("count", nWords);
+  request.set_word_array("addresses", addrs);
+  const lockCount list = count([&] { mlistread(&request, &response); });
+  HOST_CHECK(list.acquisitions == 1);
+  HOST_CHECK(!response.get_key_exists("error"));
+  const std::vector<uint32_t> values = response.get_word_array("data");
+  bool ordered = (values.size() == nWords);
+  for (uint32_t i = 0; ordered && i < nWords; ++i)
+    ordered = (values[i] == i);
+  HOST_CHECK(ordered);
+
+  // with a 1 us maximum hold time, a long transaction lets the other processes in
+  memhub_set_max_hold_time(1);
+  const lockCount bounded = count([&] {
+      memhubTransaction t;
+      for (uint32_t i = 0; i < nWords; ++i)
+        memhub_read(memsvc, addrs[i], 1, &data[i]);
+    });
+  HOST_CHECK(bounded.acquisitions > 1);
+  memhub_set_max_hold_time(0);
+
+  testExclusion();
+  testMaxHold();
+  testListWriteMasked();
+
+  report("word by word", single);
+  report("transaction", transaction);
+  report("transaction, 1 us max hold", bounded);
+  report("mlistread", list);
+
+  memhub_close(&memsvc);
+  return hostTest::result("lock_ops");
+}
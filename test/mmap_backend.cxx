@@ -0,0 +1,109 @@
+/*!
+ * \file mmap_backend.cxx
+ * \brief Test of the mmap backend of memhub on a regular file, and per-word latency against the software path of the
+ *        host build (sim backend)
+ */
+
+#include "host_test.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include <cstring>
+#include <functional>
+
+namespace {
+  const uint32_t windowBase = 0x64000000;
+  const uint32_t windowSize = 0x01000000;
+  const uint32_t reg        = 0x64300044; // GEM_AMC.TTC.STATUS.TTC_SINGLE_ERROR_CNT
+  const uint32_t block      = 0x64800000; // 1024 filler words
+  const size_t   nWords     = 200000;
+
+  /*! Runs f in a child process, whose memhub uses the given backend, and returns what f returned */
+  double inChild(const char * backend, const std::function<double()> & f)
+  {
+    int result[2];
+    if (pipe(result) != 0)
+      return -1;
+    if (fork() == 0) {
+      setenv("MEMHUB_BACKEND", backend, 1);
+      double value = -1;
+      if (memhub_open(&memsvc) == 0)
+        value = f();
+      _exit(write(result[1], &value, sizeof(value)) == sizeof(value) ? 0 : 1);
+    }
+    double value = -1;
+    HOST_CHECK(read(result[0], &value, sizeof(value)) == sizeof(value));
+    wait(nullptr);
+    close(result[0]);
+    close(result[1]);
+    return value;
+  }
+
+  double nsPerWord()
+  {
+    uint32_t value = 0;
+    return hostTest::nsPerCall(nWords, [&] { memhub_read(memsvc, reg, 1, &value); });
+  }
+
+  /*! Per-word cost of the backend itself, the lock being taken once per 1024-word block */
+  double nsPerBlockWord()
+  {
+    static uint32_t data[1024];
+    if (memhub_read(memsvc, block, 1024, data) != 0)
+      return -1;
+    return hostTest::nsPerCall(nWords / 1024, [&] { memhub_read(memsvc, block, 1024, data); }) / 1024;
+  }
+}
+
+int main()
+{
+  hostTest::nodeMap nodes = hostTest::gemTable(1);
+  hostTest::addFiller(nodes, 1024, block);
+  hostTest::hostSetup setup(nodes);
+  const std::string window = setup.path() + "/axi_window.bin";
+  const int fd = open(window.c_str(), O_RDWR | O_CREAT, 0644);
+  HOST_CHECK(fd >= 0 && ftruncate(fd, windowSize) == 0);
+  const uint32_t preset = 0x12345678;
+  HOST_CHECK(pwrite(fd, &preset, 4, reg - windowBase) == 4);
+
+  setenv("MEMHUB_MMAP_DEVICE", window.c_str(), 1);
+  setenv("MEMHUB_MMAP_BASE",   stdsprintf("0x%x", windowBase).c_str(), 1);
+  setenv("MEMHUB_MMAP_SIZE",   stdsprintf("0x%x", windowSize).c_str(), 1);
+  setenv("MEMHUB_MMAP_OFFSET", "0", 1);
+
+  // the window is the file: reads see its contents, writes land in it
+  HOST_CHECK(inChild("mmap", [&] {
+      uint32_t value = 0;
+      const uint32_t written = 0xCAFE0001;
+      const bool ok = std::strcmp(memhub_backend(), "mmap") == 0 && memhub_read(memsvc, reg, 1, &value) == 0 &&
+                      value == preset && memhub_write(memsvc, reg + 4, 1, &written) == 0;
+      return ok ? 1.0 : 0.0;
+    }) == 1.0);
+  uint32_t written = 0;
+  HOST_CHECK(pread(fd, &written, 4, reg + 4 - windowBase) == 4 && written == 0xCAFE0001);
+
+  // accesses outside of the window go to libmemsvc, which has no hardware in host builds
+  HOST_CHECK(inChild("mmap", [] {
+      uint32_t value = 0;
+      return (memhub_read(memsvc, windowBase + windowSize, 1, &value) != 0) ? 1.0 : 0.0;
+    }) == 1.0);
+
+  const double mmapNs      = inChild("mmap", nsPerWord);
+  const double simNs       = inChild("sim", nsPerWord);
+  const double mmapBlockNs = inChild("mmap", nsPerBlockWord);
+  const double simBlockNs  = inChild("sim", nsPerBlockWord);
+
+  // without the device, memhub falls back to libmemsvc
+  setenv("MEMHUB_MMAP_DEVICE", (setup.path() + "/no_such_device").c_str(), 1);
+  HOST_CHECK(inChild("mmap", [] { return std::strcmp(memhub_backend(), "memsvc") == 0 ? 1.0 : 0.0; }) == 1.0);
+
+  HOST_CHECK(mmapNs > 0 && simNs > 0 && mmapBlockNs > 0 && simBlockNs > 0);
+  std::printf("%-36s %8.1f ns/word\n", "single word reads, mmap backend", mmapNs);
+  std::printf("%-36s %8.1f ns/word\n", "single word reads, sim backend", simNs);
+  std::printf("%-36s %8.1f ns/word\n", "1024 word block reads, mmap backend", mmapBlockNs);
+  std::printf("%-36s %8.1f ns/word\n", "1024 word block reads, sim backend", simBlockNs);
+
+  close(fd);
+  return hostTest::result("mmap_backend");
+}
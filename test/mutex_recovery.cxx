@@ -0,0 +1,115 @@
+/*!
+ * \file mutex_recovery.cxx
+ * \brief Fork-and-kill test of the memhub locks: a client killed while holding the lock must neither stall the other
+ *        clients nor break their mutual exclusion
+ */
+
+#include "host_test.h"
+
+#include <signal.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace {
+  const uint32_t reg     = 0x64300044; // GEM_AMC.TTC.STATUS.TTC_SINGLE_ERROR_CNT
+  const int      rounds  = 20;
+  const int      workers = 4;
+
+  /*! Shared by all the processes of the test */
+  struct exclusivity {
+    std::atomic<int> inside;
+    std::atomic<int> violations;
+  };
+
+  exclusivity * s_shared = nullptr;
+
+  uint64_t recoveries()
+  {
+    struct memhub_stats stats;
+    return (memhub_get_stats(&stats) == 0) ? stats.recoveries : 0;
+  }
+
+  /*! Holds the lock through a transaction, and records any other process found holding it at the same time */
+  void criticalSection()
+  {
+    uint32_t value;
+    memhubTransaction t;
+    memhub_read(memsvc, reg, 1, &value);
+    if (s_shared->inside.fetch_add(1) != 0)
+      ++s_shared->violations;
+    usleep(20);
+    memhub_read(memsvc, reg, 1, &value);
+    s_shared->inside.fetch_sub(1);
+  }
+
+  /*! Forks a client which takes the lock and is killed while holding it */
+  void killHolder()
+  {
+    int ready[2];
+    if (pipe(ready) != 0)
+      return;
+    const pid_t pid = fork();
+    if (pid == 0) {
+      uint32_t value;
+      memhubTransaction t;
+      memhub_read(memsvc, reg, 1, &value);
+      if (write(ready[1], "x", 1) != 1)
+        _exit(1);
+      pause();
+      _exit(0);
+    }
+    char c;
+    HOST_CHECK(read(ready[0], &c, 1) == 1);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    close(ready[0]);
+    close(ready[1]);
+  }
+}
+
+int main()
+{
+  hostTest::hostSetup setup(hostTest::gemTable(1));
+  if (memhub_open(&memsvc) != 0) {
+    std::fprintf(stderr, "Unable to open memhub: %s\n", memsvc_get_last_error(memsvc));
+    return 2;
+  }
+  // a transaction only keeps the other processes out up to the maximum hold time
+  memhub_set_max_hold_time(0);
+  s_shared = static_cast<exclusivity *>(mmap(nullptr, sizeof(exclusivity), PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  new (s_shared) exclusivity{{0}, {0}};
+
+  const uint64_t start = recoveries();
+  double worstNs = 0;
+  for (int r = 0; r < rounds; ++r) {
+    killHolder();
+
+    // the lock of the dead client is recovered by the next access, instead of blocking it forever
+    alarm(10);
+    uint32_t value;
+    const double ns = hostTest::nsPerCall(1, [&] { HOST_CHECK(memhub_read(memsvc, reg, 1, &value) == 0); });
+    alarm(0);
+    worstNs = std::max(worstNs, ns);
+
+    for (int w = 0; w < workers; ++w) {
+      if (fork() == 0) {
+        for (int i = 0; i < 50; ++i)
+          criticalSection();
+        _exit(0);
+      }
+    }
+    while (wait(nullptr) > 0) {}
+  }
+
+  HOST_CHECK(recoveries() - start == rounds);
+  HOST_CHECK(s_shared->violations == 0);
+  std::printf("%d killed lock holders: %llu recoveries, %d exclusivity violations, first access after a kill at most %.0f ns\n",
+              rounds, static_cast<unsigned long long>(recoveries() - start), s_shared->violations.load(), worstNs);
+
+  memhub_close(&memsvc);
+  return hostTest::result("mutex_recovery");
+}
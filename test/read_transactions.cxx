@@ -0,0 +1,86 @@
+/*!
+ * \file read_transactions.cxx
+ * \brief Counts the memhub read transactions of the monitoring methods, against reading their registers one by one
+ */
+
+#include "host_test.h"
+#include "daq_monitor.h"
+
+#include <functional>
+
+namespace {
+  uint64_t memhubReads()
+  {
+    struct memhub_stats stats;
+    return (memhub_get_stats(&stats) == 0) ? stats.reads : 0;
+  }
+
+  std::vector<std::string> triggerRegs(uint32_t nOH)
+  {
+    std::vector<std::string> regs;
+    for (uint32_t ohN = 0; ohN < nOH; ++ohN)
+      for (auto const& cnt : {"LINK0_MISSED_COMMA_CNT", "LINK1_MISSED_COMMA_CNT",
+                              "LINK0_OVERFLOW_CNT",     "LINK1_OVERFLOW_CNT",
+                              "LINK0_UNDERFLOW_CNT",    "LINK1_UNDERFLOW_CNT",
+                              "LINK0_SBIT_OVERFLOW_CNT","LINK1_SBIT_OVERFLOW_CNT"})
+        regs.push_back(stdsprintf("GEM_AMC.TRIGGER.OH%d.%s", ohN, cnt));
+    return regs;
+  }
+
+  std::vector<std::string> vfatLinkRegs(uint32_t nOH)
+  {
+    std::vector<std::string> regs;
+    for (uint32_t ohN = 0; ohN < nOH; ++ohN)
+      for (uint32_t vfatN = 0; vfatN < 24; ++vfatN)
+        for (auto const& cnt : {"SYNC_ERR_CNT", "DAQ_EVENT_CNT", "DAQ_CRC_ERROR_CNT"})
+          regs.push_back(stdsprintf("GEM_AMC.OH_LINKS.OH%d.VFAT%d.%s", ohN, vfatN, cnt));
+    return regs;
+  }
+
+  /*! Compares the read transactions of a monitoring call with the ones of reading its registers one by one */
+  void compare(const char * method, const std::function<void(LocalArgs *)> & monitor, const std::vector<std::string> & regs)
+  {
+    RPCMsg response;
+    LocalArgs la = getLocalArgs(&response);
+
+    uint64_t start = memhubReads();
+    for (const std::string & reg : regs) {
+      uint32_t value = 0;
+      HOST_CHECK(readReg(&la, reg, value) == REG_OK);
+    }
+    const uint64_t single = memhubReads() - start;
+
+    start = memhubReads();
+    monitor(&la);
+    const uint64_t batched = memhubReads() - start;
+
+    HOST_CHECK(!response.get_key_exists("error"));
+    HOST_CHECK(single == regs.size());
+    HOST_CHECK(batched * 4 <= single);
+    std::printf("%-24s %4zu registers: %4llu reads one by one, %4llu reads\n", method, regs.size(),
+                static_cast<unsigned long long>(single), static_cast<unsigned long long>(batched));
+  }
+}
+
+int main()
+{
+  const uint32_t nOH = 12;
+  hostTest::hostSetup setup(hostTest::gemTable(nOH), "GEM_AMC.GEM_SYSTEM.CONFIG.NUM_OF_OH value 12\n");
+  if (memhub_open(&memsvc) != 0) {
+    std::fprintf(stderr, "Unable to open memhub: %s\n", memsvc_get_last_error(memsvc));
+    return 2;
+  }
+
+  compare("getmonDAQmain", [](LocalArgs * la) { getmonDAQmainLocal(la); },
+          {"GEM_AMC.DAQ.CONTROL.DAQ_ENABLE",                  "GEM_AMC.DAQ.STATUS.DAQ_LINK_RDY",
+           "GEM_AMC.DAQ.STATUS.DAQ_LINK_AFULL",               "GEM_AMC.DAQ.STATUS.DAQ_OUTPUT_FIFO_HAD_OVERFLOW",
+           "GEM_AMC.DAQ.STATUS.L1A_FIFO_HAD_OVERFLOW",        "GEM_AMC.DAQ.EXT_STATUS.L1A_FIFO_DATA_CNT",
+           "GEM_AMC.DAQ.EXT_STATUS.DAQ_FIFO_DATA_CNT",        "GEM_AMC.DAQ.EXT_STATUS.EVT_SENT",
+           "GEM_AMC.DAQ.STATUS.TTS_STATE",                    "GEM_AMC.DAQ.CONTROL.INPUT_ENABLE_MASK",
+           "GEM_AMC.DAQ.STATUS.INPUT_AUTOKILL_MASK"});
+  compare("getmonTRIGGEROHmain", [=](LocalArgs * la) { getmonTRIGGEROHmainLocal(la, nOH); }, triggerRegs(nOH));
+  compare("getmonVFATLink", [=](LocalArgs * la) { getmonVFATLinkLocal(la, nOH); }, vfatLinkRegs(nOH));
+
+  memhub_close(&memsvc);
+  return hostTest::result("read_transactions");
+}
@@ -0,0 +1,112 @@
+/*!
+ * \file reg_index.cxx
+ * \brief Test of the minimal perfect hash of the register index, and lookup time against the size of the table
+ */
+
+#include "host_test.h"
+#include "utils/reg_index.h"
+
+#include <algorithm>
+#include <map>
+
+namespace {
+  /*! Checks every name of the table against the index, and returns the mean lookup time */
+  double checkIndex(const hostTest::nodeMap & nodes)
+  {
+    RPCMsg response;
+    LocalArgs la = getLocalArgs(&response);
+    const regIndex * index = getRegIndex(&la);
+    HOST_CHECK(index != nullptr);
+    if (!index)
+      return 0;
+    HOST_CHECK(index->hashed());
+    HOST_CHECK(index->size() == nodes.size());
+
+    // IDs are the ranks of the names in byte-wise order
+    const std::map<std::string, xhal::utils::Node> sorted(nodes.begin(), nodes.end());
+    uint32_t rank = 0;
+    bool ranked = true, described = true, located = true;
+    std::vector<uint32_t> ids;
+    for (auto const& node : sorted) {
+      const uint32_t id = index->find(node.first);
+      ranked &= (id == rank++);
+      if (id >= index->size())
+        continue;
+      ranked &= (node.first == index->name(id));
+      described &= (index->descriptor(id).address == node.second.real_address);
+      if (!node.second.permission.empty()) {
+        index->findAddress(node.second.real_address, ids);
+        located &= (std::find(ids.begin(), ids.end(), id) != ids.end());
+      }
+    }
+    HOST_CHECK(ranked);
+    HOST_CHECK(described);
+    HOST_CHECK(located);
+
+    // one string compare rejects the names which are not in the table
+    const std::string known = sorted.rbegin()->first;
+    std::string changed = known;
+    changed.back() = '#';
+    HOST_CHECK(index->find(changed) == REG_ID_INVALID);
+    HOST_CHECK(index->find(known.substr(0, known.size() - 1)) == REG_ID_INVALID);
+    HOST_CHECK(index->find(known + ".X") == REG_ID_INVALID);
+    HOST_CHECK(index->find("") == REG_ID_INVALID);
+
+    // same lookups whatever the size of the table
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 1000; ++i)
+      names.push_back(std::next(sorted.begin(), (i * sorted.size()) / 1000)->first);
+    uint32_t sink = 0;
+    const double ns = hostTest::nsPerCall(200, [&] {
+        for (const std::string & name : names)
+          sink += index->find(name);
+      }) / names.size();
+    HOST_CHECK(sink != REG_ID_INVALID);
+    return ns;
+  }
+
+  /*! A block is found past the start of the registers it overlaps */
+  void testOverlap(uint32_t block)
+  {
+    RPCMsg response;
+    LocalArgs la = getLocalArgs(&response);
+    const regIndex * index = getRegIndex(&la);
+    HOST_CHECK(index != nullptr);
+    if (!index)
+      return;
+    const std::vector<uint32_t> both = {index->find("GEM_OVERLAP.BLOCK"), index->find("GEM_OVERLAP.STATUS")};
+    std::vector<uint32_t> ids;
+    index->findAddress(block + 8, ids);
+    HOST_CHECK(ids == both);
+    index->findAddress(block + 12, ids);
+    HOST_CHECK(ids == std::vector<uint32_t>{both[0]});
+    index->findAddress(block + 64, ids);
+    HOST_CHECK(ids.empty());
+  }
+}
+
+int main()
+{
+  const uint32_t block = 0x67000000;
+  hostTest::nodeMap small = hostTest::gemTable(1);
+  hostTest::addNode(small, "GEM_OVERLAP.BLOCK", block, 0xFFFFFFFF, "r", "block", 16);
+  hostTest::addNode(small, "GEM_OVERLAP.STATUS", block + 8, 0x0000FFFF, "r");
+  hostTest::addFiller(small, 1000 - small.size());
+  hostTest::hostSetup setup(small);
+  const double smallNs = checkIndex(small);
+  testOverlap(block);
+
+  hostTest::nodeMap large = hostTest::gemTable(12);
+  hostTest::addFiller(large, 100000);
+  closeLocalArgs();
+  addressTableUpdate update;
+  std::string error;
+  HOST_CHECK(buildAddressTable(large, setup.path(), update, error));
+  const double largeNs = checkIndex(large);
+
+  std::printf("%-24s %7zu names %8.1f ns/lookup\n", "regIndex::find", small.size(), smallNs);
+  std::printf("%-24s %7zu names %8.1f ns/lookup\n", "regIndex::find", large.size(), largeNs);
+  HOST_CHECK(largeNs < 10 * smallNs);
+
+  return hostTest::result("reg_index");
+}
@@ -0,0 +1,250 @@
+/*!
+ * \file gen_static_regs.cpp
+ * \brief Generates the compile-time register descriptors used by the GEM_STATIC_REGS builds
+ * \details Usage: gen_static_regs <address table XML> <register list> <output header>
+ *
+ *          The register list holds one register per line: an identifier, the register name, or the family pattern
+ *          with a '*' in place of the numerical suffix of each indexed level as in regFamily, and for families the
+ *          names of the indices. Empty lines and lines starting with '#' are skipped.
+ *
+ *          The address table is parsed with the xhal parser and the nodes compiled with makeRegDescriptor, as
+ *          update_address_table does, and the families are indexed with the rules of buildRegFamilies, so that the
+ *          generated registers match the ones the modules resolve at run time. See utils/static_regs.h.
+ */
+
+#include "utils/static_regs.h"
+#include "utils/family_rules.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace {
+  struct regSpec {
+    std::string              id;
+    std::string              pattern;
+    std::vector<std::string> indices;
+  };
+
+  bool readSpec(const std::string & path, std::vector<regSpec> & specs)
+  {
+    std::ifstream in(path);
+    if (!in)
+      return false;
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream words(line);
+      regSpec spec;
+      if (!(words >> spec.id) || spec.id[0] == '#')
+        continue;
+      if (!(words >> spec.pattern)) {
+        std::cerr << path << ": no register given for " << spec.id << std::endl;
+        return false;
+      }
+      std::string index;
+      while (words >> index)
+        spec.indices.push_back(index);
+      specs.push_back(spec);
+    }
+    return true;
+  }
+
+  void setDescriptor(staticReg & reg, const regDescriptor & desc)
+  {
+    reg.base  = desc.address;
+    reg.mask  = desc.mask;
+    reg.shift = desc.shift;
+    reg.perm  = desc.perm;
+    reg.mode  = desc.mode;
+    reg.size  = desc.size;
+  }
+
+  /*! Computes the layout of a family with the rules of buildRegFamilies */
+  bool indexFamily(const std::vector<regFamilyMember> & members, size_t nDims, staticReg & reg, std::string & error)
+  {
+    regFamilyDescriptor fam;
+    if (!indexRegFamily(members, nDims, fam, error))
+      return false;
+    setDescriptor(reg, fam.desc);
+    reg.nDims = fam.nDims;
+    for (size_t d = 0; d < nDims; ++d) {
+      reg.first[d]  = fam.first[d];
+      reg.count[d]  = fam.count[d];
+      reg.stride[d] = fam.stride[d];
+    }
+    return true;
+  }
+
+  std::string hex(uint64_t value)
+  {
+    std::ostringstream s;
+    s << "0x" << std::hex << value;
+    return s.str();
+  }
+
+  std::string list(const uint32_t * values, size_t n)
+  {
+    std::ostringstream s;
+    s << "{";
+    for (size_t i = 0; i < REG_FAMILY_MAX_DIMS; ++i)
+      s << (i ? ", " : "") << (i < n ? values[i] : 0);
+    s << "}";
+    return s.str();
+  }
+
+  std::string list(const int32_t * values, size_t n)
+  {
+    std::ostringstream s;
+    s << "{";
+    for (size_t i = 0; i < REG_FAMILY_MAX_DIMS; ++i)
+      s << (i ? ", " : "") << (i < n ? values[i] : 0);
+    s << "}";
+    return s.str();
+  }
+
+  void writeHeader(std::ostream & out, const std::string & xml, const std::vector<regSpec> & specs,
+                   const std::vector<staticReg> & regs, uint64_t checksum)
+  {
+    out << "/*!\n"
+        << " * \\file static_regs_gen.h\n"
+        << " * \\brief Static registers generated by gen_static_regs from " << xml << ", do not edit\n"
+        << " */\n\n"
+        << "#ifndef STATIC_REGS_GEN_H\n"
+        << "#define STATIC_REGS_GEN_H\n\n"
+        << "namespace static_regs {\n"
+        << "    static constexpr const char * SOURCE   = \"" << xml << "\"; ///< Address table the registers were generated from\n"
+        << "    static constexpr uint64_t     CHECKSUM = " << hex(checksum) << "ULL; ///< staticRegsChecksum of ALL\n\n";
+
+    for (size_t r = 0; r < regs.size(); ++r) {
+      const staticReg & reg = regs[r];
+      const regSpec & spec  = specs[r];
+      out << "    static constexpr staticReg " << spec.id << " = {\"" << reg.name << "\", "
+          << hex(reg.base) << ", " << hex(reg.mask) << ", " << static_cast<int>(reg.shift) << ", "
+          << static_cast<int>(reg.perm) << ", " << static_cast<int>(reg.mode) << ", " << static_cast<int>(reg.nDims) << ", "
+          << reg.size << ", " << list(reg.first, reg.nDims) << ", " << list(reg.count, reg.nDims) << ", "
+          << list(reg.stride, reg.nDims) << "};\n";
+
+      // named accessor, e.g. vfatChannelAddress(ohN, vfatN, chan)
+      std::ostringstream params, args;
+      for (size_t d = 0; d < reg.nDims; ++d) {
+        params << (d ? ", " : "") << "uint32_t " << spec.indices[d];
+        args   << (d ? ", " : "") << spec.indices[d];
+      }
+      out << "    inline constexpr uint32_t " << spec.id << "Address(" << params.str() << ") { return "
+          << spec.id << ".address(" << args.str() << "); }\n\n";
+    }
+
+    out << "    static constexpr const staticReg * ALL[] = {\n";
+    for (auto const& spec : specs)
+      out << "        &" << spec.id << ",\n";
+    out << "    };\n"
+        << "    static constexpr size_t N_REGS = " << regs.size() << ";\n"
+        << "}\n\n"
+        << "#endif\n";
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc != 4) {
+    std::cerr << "Usage: " << argv[0] << " <address table XML> <register list> <output header>" << std::endl;
+    return 1;
+  }
+  const std::string xml = argv[1];
+
+  std::vector<regSpec> specs;
+  if (!readSpec(argv[2], specs)) {
+    std::cerr << "Unable to read the register list " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::unordered_map<std::string, xhal::utils::Node> nodes;
+  try {
+    xhal::utils::XHALXMLParser parser(xml);
+    parser.setLogLevel(0);
+    parser.parseXML();
+    nodes = parser.getAllNodes();
+  } catch (...) {
+    std::cerr << "Unable to parse " << xml << std::endl;
+    return 1;
+  }
+  nodes.erase("top");
+
+  // members of the requested families
+  std::map<std::string, std::vector<regFamilyMember> > families;
+  for (auto const& spec : specs) {
+    if (spec.pattern.find('*') != std::string::npos)
+      families[spec.pattern];
+  }
+  std::string pattern;
+  for (auto const& n : nodes) {
+    regFamilyMember m;
+    if (regFamilyPattern(n.first, pattern, m.idx) == 0)
+      continue;
+    auto it = families.find(pattern);
+    if (it != families.end()) {
+      m.desc = makeRegDescriptor(n.second);
+      it->second.push_back(m);
+    }
+  }
+
+  std::vector<staticReg> regs(specs.size(), staticReg());
+  std::vector<const staticReg*> ptrs;
+  bool failed = false;
+  for (size_t r = 0; r < specs.size(); ++r) {
+    const regSpec & spec = specs[r];
+    staticReg & reg = regs[r];
+    reg.name = spec.pattern.c_str();
+    ptrs.push_back(&reg);
+
+    const size_t nDims = std::count(spec.pattern.begin(), spec.pattern.end(), '*');
+    if (nDims == 0) {
+      auto it = nodes.find(spec.pattern);
+      if (it == nodes.end()) {
+        std::cerr << spec.id << ": " << spec.pattern << " is not in the address table" << std::endl;
+        failed = true;
+      } else {
+        setDescriptor(reg, makeRegDescriptor(it->second));
+      }
+      continue;
+    }
+
+    std::string error;
+    std::vector<regFamilyMember> & members = families[spec.pattern];
+    if (spec.indices.size() != nDims) {
+      std::cerr << spec.id << ": " << nDims << " index names expected, " << spec.indices.size() << " given" << std::endl;
+      failed = true;
+    } else if (nDims > REG_FAMILY_MAX_DIMS) {
+      std::cerr << spec.id << ": more than " << REG_FAMILY_MAX_DIMS << " indexed levels" << std::endl;
+      failed = true;
+    } else if (members.empty()) {
+      std::cerr << spec.id << ": no register matches " << spec.pattern << std::endl;
+      failed = true;
+    } else if (!indexFamily(members, nDims, reg, error)) {
+      std::cerr << spec.id << ": " << spec.pattern << " cannot be indexed, " << error << std::endl;
+      failed = true;
+    }
+  }
+  if (failed)
+    return 1;
+
+  // written next to the output and renamed, so that an interrupted build does not leave a partial header
+  const std::string out = argv[3];
+  const std::string tmp = out + ".tmp";
+  {
+    std::ofstream header(tmp);
+    writeHeader(header, xml, specs, regs, staticRegsChecksum(ptrs.data(), ptrs.size()));
+    if (!header) {
+      std::cerr << "Unable to write " << tmp << std::endl;
+      return 1;
+    }
+  }
+  if (std::rename(tmp.c_str(), out.c_str()) != 0) {
+    std::cerr << "Unable to write " << out << std::endl;
+    return 1;
+  }
+  std::cout << "Generated " << regs.size() << " static registers in " << out << std::endl;
+  return 0;
+}